@@ -0,0 +1,153 @@
+/**
+ *
+ * @file AddressPolicy.hpp Locality-aware ordering of resolved addresses
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef UTILITIES_INCLUDE_UTILITIES_ADDRESSPOLICY_HPP_
+#define UTILITIES_INCLUDE_UTILITIES_ADDRESSPOLICY_HPP_
+
+#include "utilities/Endpoint.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace dunedaq {
+namespace utilities {
+
+/**
+ * @brief AddressPolicy decides which of the addresses of a host the
+ * Resolver returns, and in which order, so that multi-homed hosts are
+ * reached over the preferred network.
+ *
+ * Each address gets a rank from the first rule whose subnet contains
+ * it, or kDefaultRank if none does; lower ranks come first. Rules are
+ * CIDR subnets (eg "10.73.0.0/16"), or the subnets of a named local
+ * interface. Among addresses of equal rank, those on a subnet of one of
+ * this host's interfaces come first (unless disabled), then IPv4 before
+ * IPv6; otherwise the order of the answer is kept.
+ *
+ * IPv6 addresses are dropped unless enabled, except in answers from a
+ * ResolverBackend, whose addresses are configured explicitly.
+ *
+ * The local interfaces are read when the policy is constructed.
+ */
+class AddressPolicy
+{
+public:
+  static constexpr int kDefaultRank = 100;
+
+  AddressPolicy();
+
+  /**
+   * @brief Load a policy from JSON, eg
+   *
+   *   {
+   *     "ipv6": false,
+   *     "prefer_local_subnets": true,
+   *     "rules": [
+   *       { "interface": "ens1f0np0", "rank": 0 },
+   *       { "cidr": "10.73.0.0/16", "rank": 10 },
+   *       { "cidr": "192.168.0.0/16", "rank": 1000 }
+   *     ]
+   *   }
+   *
+   * All fields are optional; "rank" defaults to 0.
+   * @throws InvalidResolverConfiguration if the JSON does not match this format
+   */
+  static std::shared_ptr<AddressPolicy> from_json(nlohmann::json const& json);
+
+  /**
+   * @brief Give addresses in subnet cidr (eg "10.73.0.0/16" or
+   * "fd00::/8") the given rank, unless an earlier rule matches them
+   * @throws InvalidResolverConfiguration if cidr is not a valid subnet
+   */
+  void add_subnet_rule(std::string_view cidr, int rank);
+
+  /**
+   * @brief Give addresses on the subnets of the local interface
+   * interface_name the given rank. An interface which does not exist on
+   * this host adds no rule, so that one policy can serve many hosts
+   */
+  void add_interface_rule(std::string const& interface_name, int rank);
+
+  void set_ipv6_enabled(bool enabled) { m_ipv6_enabled = enabled; }
+  bool get_ipv6_enabled() const { return m_ipv6_enabled; }
+
+  void set_prefer_local_subnets(bool prefer) { m_prefer_local_subnets = prefer; }
+  bool get_prefer_local_subnets() const { return m_prefer_local_subnets; }
+
+  /**
+   * @brief Get the rank of endpoint from the rules
+   */
+  int get_rank(Endpoint const& endpoint) const;
+
+  /**
+   * @brief Whether endpoint is on a subnet of one of this host's interfaces
+   */
+  bool is_local(Endpoint const& endpoint) const;
+
+  /**
+   * @brief Order endpoints by the policy, dropping IPv6 addresses if
+   * filter_ipv6 is set and IPv6 is not enabled
+   */
+  void apply(std::vector<Endpoint>& endpoints, bool filter_ipv6 = true) const;
+
+private:
+  struct Subnet
+  {
+    int family{ 0 };
+    std::array<uint8_t, 16> address{}; // NOLINT(build/unsigned)
+    unsigned prefix_length{ 0 };
+
+    static std::optional<Subnet> parse(std::string_view cidr);
+    bool contains(Endpoint const& endpoint) const;
+  };
+
+  struct Interface
+  {
+    std::string name;
+    Subnet subnet;
+  };
+
+  struct Rule
+  {
+    Subnet subnet;
+    int rank;
+  };
+
+  std::vector<Interface> m_interfaces;
+  std::vector<Rule> m_rules;
+  bool m_ipv6_enabled{ false };
+  bool m_prefer_local_subnets{ true };
+};
+
+/**
+ * @brief Install policy as the one used by the Resolver functions (a
+ * null policy restores the default one). The resolver caches are
+ * invalidated, since they hold answers ordered by the previous policy
+ */
+void
+set_address_policy(std::shared_ptr<const AddressPolicy> policy);
+
+/**
+ * @brief Get the policy in use. It is immutable, and not affected by
+ * later calls to set_address_policy
+ */
+std::shared_ptr<const AddressPolicy>
+get_address_policy();
+
+} // namespace utilities
+} // namespace dunedaq
+
+#endif // UTILITIES_INCLUDE_UTILITIES_ADDRESSPOLICY_HPP_
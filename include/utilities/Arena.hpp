@@ -0,0 +1,163 @@
+/**
+ *
+ * @file Arena.hpp Monotonic arena for per-thread scratch memory, reset between batches
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef UTILITIES_INCLUDE_UTILITIES_ARENA_HPP_
+#define UTILITIES_INCLUDE_UTILITIES_ARENA_HPP_
+
+#include "utilities/PageMemory.hpp"
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+namespace dunedaq {
+namespace utilities {
+
+struct ArenaOptions
+{
+  size_t chunk_size{ 64 * 1024 }; ///< Size of each chunk; larger allocations get a chunk of their own
+  bool use_hugepages{ false };    ///< Put chunks on huge pages (see PageMemory)
+};
+
+/**
+ * @brief Arena hands out memory by advancing a pointer through chunks
+ * of PageMemory, and frees it all at once with reset(), for scratch
+ * data which lives for one batch of work.
+ *
+ * reset() keeps the chunks, so after the first few batches an arena
+ * makes no system allocations. Nothing is freed individually, and
+ * destructors are not run, so only trivially destructible objects are
+ * created in an arena (ArenaAllocator lets containers use one, as long
+ * as they are destroyed before the arena is reset).
+ *
+ * An Arena must only be used by one thread at a time; this_thread()
+ * gives each thread its own.
+ *
+ * @code
+ * void do_work(std::atomic<bool>& running_flag) {
+ *   auto& arena = Arena::this_thread();
+ *   while (running_flag) {
+ *     {
+ *       std::vector<Hit, ArenaAllocator<Hit>> hits{ ArenaAllocator<Hit>(arena) };
+ *       ...
+ *     }
+ *     arena.reset();
+ *   }
+ * }
+ * @endcode
+ */
+class Arena
+{
+public:
+  struct Stats
+  {
+    size_t chunks{ 0 };
+    size_t bytes_reserved{ 0 };
+    size_t bytes_allocated{ 0 }; ///< Since the last reset
+    size_t high_water_mark{ 0 }; ///< Most bytes allocated between resets
+    size_t allocations{ 0 };     ///< Since the arena was created
+    size_t resets{ 0 };
+    bool hugepages{ false }; ///< Whether every chunk is on reserved huge pages
+  };
+
+  explicit Arena(ArenaOptions options = {});
+
+  Arena(const Arena&) = delete;            ///< Arena is not copy-constructible
+  Arena& operator=(const Arena&) = delete; ///< Arena is not copy-assignable
+  Arena(Arena&&) = delete;                 ///< Arena is not move-constructible
+  Arena& operator=(Arena&&) = delete;      ///< Arena is not move-assignable
+
+  /**
+   * @param alignment A power of two
+   * @throws std::bad_alloc if a chunk is needed and cannot be mapped
+   */
+  void* allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+  /**
+   * @brief Construct an object in the arena
+   */
+  template<typename T, typename... Args>
+  T* create(Args&&... args);
+
+  /**
+   * @brief Make all of the arena's memory available again, keeping the
+   * chunks. Everything allocated before is invalidated
+   */
+  void reset();
+
+  /**
+   * @brief Return all of the chunks to the system
+   */
+  void release();
+
+  const Stats& get_stats() const { return m_stats; }
+
+  /**
+   * @brief Get the calling thread's arena, created with default options
+   * on first use
+   */
+  static Arena& this_thread();
+
+private:
+  ArenaOptions m_options;
+  std::vector<PageMemory> m_chunks;
+  size_t m_current_chunk{ 0 };
+  size_t m_offset{ 0 };
+  Stats m_stats;
+};
+
+/**
+ * @brief ArenaAllocator is a standard allocator which takes memory from
+ * an Arena. Deallocation does nothing; the memory is reclaimed when the
+ * arena is reset
+ */
+template<typename T>
+class ArenaAllocator
+{
+public:
+  using value_type = T;
+
+  explicit ArenaAllocator(Arena& arena) noexcept
+    : m_arena(&arena)
+  {}
+
+  template<typename U>
+  ArenaAllocator(const ArenaAllocator<U>& other) noexcept // NOLINT(runtime/explicit)
+    : m_arena(other.get_arena())
+  {}
+
+  T* allocate(size_t n);
+  void deallocate(T*, size_t) noexcept {}
+
+  Arena* get_arena() const { return m_arena; }
+
+private:
+  Arena* m_arena;
+};
+
+template<typename T, typename U>
+bool
+operator==(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs) noexcept
+{
+  return lhs.get_arena() == rhs.get_arena();
+}
+
+template<typename T, typename U>
+bool
+operator!=(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs) noexcept
+{
+  return !(lhs == rhs);
+}
+
+} // namespace utilities
+} // namespace dunedaq
+
+#include "detail/Arena.hxx"
+
+#endif // UTILITIES_INCLUDE_UTILITIES_ARENA_HPP_
@@ -0,0 +1,130 @@
+/**
+ * @file Clock.hpp Clock interface used by the timestamp estimators
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef UTILITIES_INCLUDE_UTILITIES_CLOCK_HPP_
+#define UTILITIES_INCLUDE_UTILITIES_CLOCK_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+namespace dunedaq {
+namespace utilities {
+
+/**
+ * @brief Clock is the source of "system time" for the timestamp
+ * estimators and their wait functions. Injecting a Clock allows the
+ * estimators to be driven by simulated time in tests and benchmarks.
+ */
+class Clock
+{
+public:
+  using duration = std::chrono::microseconds;
+  using time_point = std::chrono::time_point<std::chrono::system_clock, duration>;
+
+  virtual ~Clock() = default;
+
+  /**
+   * @brief Get the current time
+   */
+  virtual time_point now() const = 0;
+
+  /**
+   * @brief Block the calling thread for (approximately) the given duration
+   */
+  virtual void sleep_for(duration d) = 0;
+
+  /**
+   * @brief Briefly relax the CPU inside a busy-wait loop
+   */
+  virtual void pause() = 0;
+
+  /**
+   * @brief Give up the rest of the calling thread's time slice
+   */
+  virtual void yield() = 0;
+
+  /**
+   * @brief Whether sleep_for() advances the clock and returns at once,
+   * rather than blocking. Loops which sleep on such a clock never wait
+   */
+  virtual bool advances_on_sleep() const { return false; }
+
+  /**
+   * @brief Get the current time in microseconds since the epoch
+   */
+  uint64_t now_us() const { return static_cast<uint64_t>(now().time_since_epoch().count()); } // NOLINT(build/unsigned)
+};
+
+/**
+ * @brief SystemClock is a Clock backed by std::chrono::system_clock
+ */
+class SystemClock : public Clock
+{
+public:
+  time_point now() const override;
+  void sleep_for(duration d) override;
+  void pause() override;
+  void yield() override;
+};
+
+/**
+ * @brief SimulatedClock is a Clock whose time only changes when it is
+ * explicitly advanced.
+ *
+ * If advance_on_sleep is true, sleep_for() advances the clock by the
+ * requested duration and returns immediately, so that single-threaded
+ * code can run through long stretches of simulated time. Otherwise,
+ * sleep_for() blocks until another thread advances the clock past the
+ * end of the sleep, or until 1 ms of real time has elapsed, whichever
+ * comes first (callers are expected to re-check their exit conditions
+ * in a loop, as the estimator wait functions do). Likewise, pause()
+ * and yield() advance the clock by 1 us if advance_on_sleep is true,
+ * so that busy-wait loops make progress.
+ */
+class SimulatedClock : public Clock
+{
+public:
+  explicit SimulatedClock(time_point start = time_point(), bool advance_on_sleep = true);
+
+  time_point now() const override { return time_point(duration(m_now_us.load())); }
+  void sleep_for(duration d) override;
+  void pause() override;
+  void yield() override;
+  bool advances_on_sleep() const override { return m_advance_on_sleep; }
+
+  /**
+   * @brief Move the clock forward by d, waking any threads sleeping on it
+   */
+  void advance(duration d);
+
+  /**
+   * @brief Set the clock to t, waking any threads sleeping on it
+   */
+  void set(time_point t);
+
+private:
+  std::atomic<int64_t> m_now_us;
+  bool m_advance_on_sleep;
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+};
+
+/**
+ * @brief Get the process-wide SystemClock instance
+ */
+std::shared_ptr<Clock>
+get_system_clock();
+
+} // namespace utilities
+} // namespace dunedaq
+
+#endif // UTILITIES_INCLUDE_UTILITIES_CLOCK_HPP_
@@ -0,0 +1,101 @@
+/**
+ *
+ * @file Endpoint.hpp Resolved network endpoint
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef UTILITIES_INCLUDE_UTILITIES_ENDPOINT_HPP_
+#define UTILITIES_INCLUDE_UTILITIES_ENDPOINT_HPP_
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace dunedaq {
+namespace utilities {
+
+/**
+ * @brief Endpoint is a resolved address: a sockaddr (IPv4 or IPv6)
+ * with its port, and the scheme used to connect to it. It can be
+ * handed to socket APIs directly, without going through strings.
+ *
+ * The connection string form (eg "tcp://10.0.0.1:5555",
+ * "tcp://[::1]:5555") is built whenever the endpoint is constructed or
+ * changed, so that const Endpoints can be shared between threads.
+ */
+class Endpoint
+{
+public:
+  Endpoint() = default;
+
+  /**
+   * @brief Construct from a sockaddr (AF_INET or AF_INET6), keeping its port
+   */
+  Endpoint(std::string scheme, const sockaddr* addr, socklen_t addr_len);
+
+  /**
+   * @brief Construct from a numeric IPv4 or IPv6 address (without brackets)
+   * @return std::nullopt if address is not numeric
+   */
+  static std::optional<Endpoint> from_numeric(std::string scheme, std::string_view address, uint16_t port); // NOLINT
+
+  const sockaddr* get_sockaddr() const { return reinterpret_cast<const sockaddr*>(&m_addr); } // NOLINT
+  socklen_t get_sockaddr_len() const { return m_addr_len; }
+  int get_family() const { return m_addr.ss_family; }
+  bool is_valid() const { return m_addr_len != 0; }
+
+  const std::string& get_scheme() const { return m_scheme; }
+  void set_scheme(std::string scheme);
+
+  uint16_t get_port() const; // NOLINT(build/unsigned)
+  void set_port(uint16_t port); // NOLINT(build/unsigned)
+
+  /**
+   * @brief Get the numeric address, without brackets or port
+   */
+  std::string get_address() const;
+
+  /**
+   * @brief Get the connection string for this endpoint, eg
+   * tcp://10.0.0.1:5555. The port is omitted if it is zero
+   */
+  const std::string& to_string() const { return m_string; }
+
+  bool operator==(const Endpoint& other) const;
+  bool operator!=(const Endpoint& other) const { return !(*this == other); }
+
+  /**
+   * @brief Hash consistent with operator==, for unordered containers
+   */
+  size_t hash() const;
+
+private:
+  void update_string();
+
+  sockaddr_storage m_addr{};
+  socklen_t m_addr_len{ 0 };
+  std::string m_scheme{ "" };
+  std::string m_string{ "" };
+};
+
+} // namespace utilities
+} // namespace dunedaq
+
+namespace std {
+template<>
+struct hash<dunedaq::utilities::Endpoint>
+{
+  size_t operator()(dunedaq::utilities::Endpoint const& endpoint) const { return endpoint.hash(); }
+};
+} // namespace std
+
+#endif // UTILITIES_INCLUDE_UTILITIES_ENDPOINT_HPP_
@@ -0,0 +1,105 @@
+/**
+ *
+ * @file InternedName.hpp Names held once in a process-wide pool, compared and hashed by id
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef UTILITIES_INCLUDE_UTILITIES_INTERNEDNAME_HPP_
+#define UTILITIES_INCLUDE_UTILITIES_INTERNEDNAME_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+namespace dunedaq {
+namespace utilities {
+
+/**
+ * @brief InternedName is a handle on a string kept in a process-wide,
+ * thread-safe pool, where each distinct string is stored once and
+ * given a small integer id.
+ *
+ * Interning a string costs a pool lookup (and an insertion the first
+ * time), but after that copying, comparing and hashing InternedNames
+ * are integer operations, so they make cheap keys for maps on hot
+ * paths. The text stays available, and stays valid for the lifetime of
+ * the process: strings are never removed from the pool, which suits
+ * the bounded set of object names of a DAQ application.
+ *
+ * Ids are dense and start at 0, which is the empty string (and the
+ * value of a default-constructed InternedName). Their order is the
+ * order in which strings were first interned, not alphabetical.
+ */
+class InternedName
+{
+public:
+  InternedName();
+
+  /**
+   * @brief Intern name, adding it to the pool if it is not there yet
+   */
+  explicit InternedName(std::string_view name);
+
+  /**
+   * @brief Get the InternedName of name only if it is already in the
+   * pool, without adding it
+   */
+  static std::optional<InternedName> find(std::string_view name);
+
+  /**
+   * @brief Get the number of distinct strings in the pool
+   */
+  static size_t get_pool_size();
+
+  uint32_t get_id() const { return m_entry->id; } // NOLINT(build/unsigned)
+  const std::string& str() const { return m_entry->text; }
+  std::string_view view() const { return m_entry->text; }
+  bool empty() const { return m_entry->text.empty(); }
+
+  bool operator==(InternedName other) const { return m_entry == other.m_entry; }
+  bool operator!=(InternedName other) const { return m_entry != other.m_entry; }
+  bool operator<(InternedName other) const { return get_id() < other.get_id(); }
+
+  /**
+   * @brief A pooled string. Entries never move or go away, so
+   * InternedName can point to them directly
+   */
+  struct Entry
+  {
+    std::string text;
+    uint32_t id; // NOLINT(build/unsigned)
+  };
+
+private:
+  explicit InternedName(const Entry* entry)
+    : m_entry(entry)
+  {}
+
+  const Entry* m_entry;
+};
+
+inline std::ostream&
+operator<<(std::ostream& stream, InternedName name)
+{
+  return stream << name.str();
+}
+
+} // namespace utilities
+} // namespace dunedaq
+
+namespace std {
+template<>
+struct hash<dunedaq::utilities::InternedName>
+{
+  size_t operator()(dunedaq::utilities::InternedName name) const { return name.get_id(); }
+};
+} // namespace std
+
+#endif // UTILITIES_INCLUDE_UTILITIES_INTERNEDNAME_HPP_
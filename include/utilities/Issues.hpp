@@ -29,6 +29,32 @@ ERS_DECLARE_ISSUE(utilities,
                   "The hostname " << name << " could not be resolved: " << error,
                   ((std::string)name)((std::string)error))
 ERS_DECLARE_ISSUE(utilities, InvalidUri, "The URI string " << uri << " is not valid", ((std::string)uri))
+ERS_DECLARE_ISSUE(utilities,
+                  TruncatedServiceAnswer,
+                  "The DNS answer for service " << service << " was truncated, some endpoints may be missing",
+                  ((std::string)service))
+ERS_DECLARE_ISSUE(utilities,
+                  TruncatedDnsAnswer,
+                  "The DNS answer for the " << type << " records of " << name
+                                            << " was truncated, some addresses may be missing",
+                  ((std::string)name)((std::string)type))
+ERS_DECLARE_ISSUE(utilities,
+                  MalformedServiceRecord,
+                  "Record " << index << " of the DNS answer for service " << service << " could not be parsed",
+                  ((std::string)service)((int)index))
+ERS_DECLARE_ISSUE(utilities,
+                  ResolveTimeout,
+                  "Resolution of " << name << " did not complete within " << timeout_ms << " ms",
+                  ((std::string)name)((int64_t)timeout_ms)) // NOLINT
+ERS_DECLARE_ISSUE(utilities,
+                  ResolveFailuresSuppressed,
+                  count << " further failures to resolve " << name << " were not reported in the last " << interval_ms
+                        << " ms",
+                  ((std::string)name)((uint64_t)count)((int64_t)interval_ms)) // NOLINT
+ERS_DECLARE_ISSUE(utilities,
+                  InvalidResolverConfiguration,
+                  "Invalid resolver configuration: " << reason,
+                  ((std::string)reason))
 // Reenable coverage collection LCOV_EXCL_STOP
 
 ERS_DECLARE_ISSUE(utilities, InvalidTimeSync, "An invalid TimeSync message was received", ERS_EMPTY)
@@ -47,6 +73,31 @@ ERS_DECLARE_ISSUE(utilities,
                   FailedToGetTimestampEstimate,
                   "Failed to get timestamp estimate (was interrupted)",
                   ERS_EMPTY)
+
+ERS_DECLARE_ISSUE(utilities,
+                  InvalidSchedulerConfiguration,
+                  "Invalid timestamp wait scheduler configuration: " << reason,
+                  ((std::string)reason))
+
+ERS_DECLARE_ISSUE(utilities,
+                  NameAlreadyRegistered,
+                  "An object named " << name << " is already registered",
+                  ((std::string)name))
+
+ERS_DECLARE_ISSUE(utilities,
+                  InvalidPoolConfiguration,
+                  "Invalid memory pool configuration: " << reason,
+                  ((std::string)reason))
+
+ERS_DECLARE_ISSUE(utilities,
+                  MetricsLimitReached,
+                  "Cannot create metric " << name << ", the limit of " << limit << " metrics has been reached",
+                  ((std::string)name)((size_t)limit))
+
+ERS_DECLARE_ISSUE(utilities,
+                  MetricsExportFailed,
+                  "Could not write metrics to " << path << ": " << reason,
+                  ((std::string)path)((std::string)reason))
 } // namespace dunedaq
 
 #endif // UTILITIES_INCLUDE_UTILITIES_ISSUES_HPP_
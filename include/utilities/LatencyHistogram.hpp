@@ -0,0 +1,207 @@
+/**
+ *
+ * @file LatencyHistogram.hpp Log-linear latency histogram, recorded into per-thread shards
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef UTILITIES_INCLUDE_UTILITIES_LATENCYHISTOGRAM_HPP_
+#define UTILITIES_INCLUDE_UTILITIES_LATENCYHISTOGRAM_HPP_
+
+#include <nlohmann/json.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace dunedaq {
+namespace utilities {
+
+/**
+ * @brief HistogramSnapshot is the merged content of a LatencyHistogram
+ * at one time, from which percentiles are read
+ */
+class HistogramSnapshot
+{
+public:
+  /**
+   * @brief Get the value at or below which fraction of the recorded
+   * values lie (eg 0.99 for the 99th percentile). This is the upper end
+   * of the bucket holding it, so it is at most kRelativeError above the
+   * exact value, and never more than get_max()
+   */
+  uint64_t get_percentile(double fraction) const; // NOLINT(build/unsigned)
+
+  uint64_t get_count() const { return m_count; }                // NOLINT(build/unsigned)
+  uint64_t get_min() const { return m_count == 0 ? 0 : m_min; } // NOLINT(build/unsigned)
+  uint64_t get_max() const { return m_max; }                    // NOLINT(build/unsigned)
+  double get_mean() const { return m_count == 0 ? 0. : static_cast<double>(m_sum) / m_count; }
+
+  /**
+   * @brief Get count, min, mean, max and the 50th, 90th, 99th and 99.9th
+   * percentiles, in ns, and (if with_buckets) the non-empty buckets as
+   * [upper bound, count] pairs
+   */
+  nlohmann::json to_json(bool with_buckets = false) const;
+
+private:
+  friend class LatencyHistogram;
+
+  std::vector<uint64_t> m_buckets;                        // NOLINT(build/unsigned)
+  uint64_t m_count{ 0 };                                  // NOLINT(build/unsigned)
+  uint64_t m_sum{ 0 };                                    // NOLINT(build/unsigned)
+  uint64_t m_min{ std::numeric_limits<uint64_t>::max() }; // NOLINT(build/unsigned)
+  uint64_t m_max{ 0 };                                    // NOLINT(build/unsigned)
+};
+
+/**
+ * @brief LatencyHistogram counts durations in log-linear buckets, as
+ * HdrHistogram does: values below kSubBuckets ns are counted exactly,
+ * and each power of two above that is split into kSubBuckets buckets,
+ * so percentiles are within kRelativeError (about 3%) of the exact
+ * value over the whole range, up to about 4.9 hours.
+ *
+ * Each thread records into its own shard of the histogram, with
+ * relaxed stores to counters which no other thread writes, so
+ * record() costs a few ns and never contends; get_snapshot() adds the
+ * shards up. Shards are kept when their thread exits.
+ *
+ * @code
+ * LatencyHistogram m_process_time;
+ *
+ * void do_work(std::atomic<bool>& running_flag) {
+ *   while (running_flag) {
+ *     LatencyTimer timer(m_process_time);
+ *     process_next();
+ *   }
+ * }
+ *
+ * TLOG() << m_process_time.get_snapshot().to_json().dump();
+ * @endcode
+ */
+class LatencyHistogram
+{
+public:
+  static constexpr size_t kSubBucketBits = 5;
+  static constexpr size_t kSubBuckets = size_t(1) << kSubBucketBits;
+  static constexpr size_t kMaxValueBits = 44;
+  static constexpr size_t kBuckets = (kMaxValueBits - kSubBucketBits + 1) * kSubBuckets;
+  static constexpr double kRelativeError = 1. / kSubBuckets;
+
+  LatencyHistogram();
+  ~LatencyHistogram();
+
+  LatencyHistogram(const LatencyHistogram&) = delete;            ///< LatencyHistogram is not copy-constructible
+  LatencyHistogram& operator=(const LatencyHistogram&) = delete; ///< LatencyHistogram is not copy-assignable
+  LatencyHistogram(LatencyHistogram&&) = delete;                 ///< LatencyHistogram is not move-constructible
+  LatencyHistogram& operator=(LatencyHistogram&&) = delete;      ///< LatencyHistogram is not move-assignable
+
+  /**
+   * @brief Count a value, in ns. Values beyond the range are counted in
+   * the last bucket, though the maximum is kept exactly
+   */
+  void record(uint64_t value_ns); // NOLINT(build/unsigned)
+  void record(std::chrono::nanoseconds duration);
+
+  /**
+   * @brief Add up the shards of all threads
+   */
+  HistogramSnapshot get_snapshot() const;
+
+  /**
+   * @brief Clear the histogram. Values being recorded at the same time
+   * may be lost or kept
+   */
+  void reset();
+
+  static size_t get_bucket_index(uint64_t value);       // NOLINT(build/unsigned)
+  static uint64_t get_bucket_upper_bound(size_t index); // NOLINT(build/unsigned)
+
+  /**
+   * @brief One thread's counters
+   */
+  struct alignas(64) Shard
+  {
+    std::array<std::atomic<uint64_t>, kBuckets> buckets{};             // NOLINT(build/unsigned)
+    std::atomic<uint64_t> sum{ 0 };                                    // NOLINT(build/unsigned)
+    std::atomic<uint64_t> min{ std::numeric_limits<uint64_t>::max() }; // NOLINT(build/unsigned)
+    std::atomic<uint64_t> max{ 0 };                                    // NOLINT(build/unsigned)
+  };
+
+private:
+  Shard& get_shard();
+
+  /**
+   * @brief Find or create the calling thread's shard, when it isn't in
+   * the thread's cache
+   */
+  Shard& find_shard();
+
+  const uint64_t m_id; // NOLINT(build/unsigned)
+  mutable std::mutex m_mutex;
+  std::vector<std::pair<std::thread::id, std::unique_ptr<Shard>>> m_shards;
+};
+
+/**
+ * @brief LatencyTimer records the time from its construction to its
+ * destruction (or to stop()) in a LatencyHistogram
+ */
+class LatencyTimer
+{
+public:
+  explicit LatencyTimer(LatencyHistogram& histogram)
+    : m_histogram(&histogram)
+    , m_start(std::chrono::steady_clock::now())
+  {}
+
+  ~LatencyTimer() { stop(); }
+
+  LatencyTimer(const LatencyTimer&) = delete;            ///< LatencyTimer is not copy-constructible
+  LatencyTimer& operator=(const LatencyTimer&) = delete; ///< LatencyTimer is not copy-assignable
+  LatencyTimer(LatencyTimer&&) = delete;                 ///< LatencyTimer is not move-constructible
+  LatencyTimer& operator=(LatencyTimer&&) = delete;      ///< LatencyTimer is not move-assignable
+
+  /**
+   * @brief Record the time so far, if it hasn't been recorded or cancelled
+   * @return The time recorded
+   */
+  std::chrono::nanoseconds stop();
+
+  /**
+   * @brief Don't record anything, eg when the operation being timed failed
+   */
+  void cancel() { m_histogram = nullptr; }
+
+private:
+  LatencyHistogram* m_histogram;
+  std::chrono::steady_clock::time_point m_start;
+};
+
+/**
+ * @brief Call f, recording how long it took in histogram
+ * @return What f returns
+ */
+template<typename Function>
+decltype(auto)
+time_call(LatencyHistogram& histogram, Function&& f)
+{
+  LatencyTimer timer(histogram);
+  return f();
+}
+
+} // namespace utilities
+} // namespace dunedaq
+
+#include "detail/LatencyHistogram.hxx"
+
+#endif // UTILITIES_INCLUDE_UTILITIES_LATENCYHISTOGRAM_HPP_
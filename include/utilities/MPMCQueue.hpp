@@ -0,0 +1,147 @@
+/**
+ *
+ * @file MPMCQueue.hpp Bounded lock-free multi-producer, multi-consumer queue
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef UTILITIES_INCLUDE_UTILITIES_MPMCQUEUE_HPP_
+#define UTILITIES_INCLUDE_UTILITIES_MPMCQUEUE_HPP_
+
+#include "utilities/detail/QueueSupport.hxx"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+namespace dunedaq {
+namespace utilities {
+
+/**
+ * @brief MPMCQueue is a bounded ring buffer which any number of threads
+ * may push to and pop from concurrently, without locks.
+ *
+ * Each slot has a sequence number telling whether it is ready to be
+ * written or read in the current lap of the ring (as in D. Vyukov's
+ * bounded MPMC queue), so producers and consumers only contend on the
+ * position they advance, each of which is on its own cache line. The
+ * batch functions claim a run of consecutive slots with a single
+ * compare-and-swap.
+ *
+ * The capacity is rounded up to a power of two (and at least 2). The
+ * waiting functions work as in SPSCQueue, giving up when the
+ * WorkerThread running flag they are given is cleared.
+ *
+ * Elements must be nothrow move-constructible and move-assignable, so
+ * that a claimed slot is always filled or emptied; elements which can
+ * throw while being constructed from other arguments are constructed
+ * before a slot is claimed.
+ */
+template<typename T>
+class alignas(detail::kCacheLineSize) MPMCQueue // Aligned so that nothing else shares its cache lines
+{
+  static_assert(std::is_nothrow_move_constructible_v<T> && std::is_nothrow_move_assignable_v<T>,
+                "MPMCQueue elements must be nothrow movable");
+
+public:
+  explicit MPMCQueue(size_t capacity);
+  ~MPMCQueue();
+
+  MPMCQueue(const MPMCQueue&) = delete;            ///< MPMCQueue is not copy-constructible
+  MPMCQueue& operator=(const MPMCQueue&) = delete; ///< MPMCQueue is not copy-assignable
+  MPMCQueue(MPMCQueue&&) = delete;                 ///< MPMCQueue is not move-constructible
+  MPMCQueue& operator=(MPMCQueue&&) = delete;      ///< MPMCQueue is not move-assignable
+
+  /**
+   * @brief Construct an element at the back of the queue
+   * @return false if the queue is full
+   */
+  template<typename... Args>
+  bool try_emplace(Args&&... args);
+
+  bool try_push(const T& value) { return try_emplace(value); }
+  bool try_push(T&& value) { return try_emplace(std::move(value)); }
+
+  /**
+   * @brief Move the element at the front of the queue into value
+   * @return false if the queue is empty
+   */
+  bool try_pop(T& value);
+
+  /**
+   * @brief Move as many elements of [first, last) as there are
+   * consecutive free slots for. They are queued consecutively
+   * @return The iterator after the last element pushed
+   */
+  template<typename InputIt>
+  InputIt try_push_batch(InputIt first, InputIt last);
+
+  /**
+   * @brief Move up to max_count consecutive elements from the queue to out
+   * @return The number of elements popped
+   */
+  template<typename OutputIt>
+  size_t try_pop_batch(OutputIt out, size_t max_count);
+
+  /**
+   * @brief Push value, waiting while the queue is full
+   * @return false if running was cleared, or timeout passed, while the
+   * queue was full (value is then left as it was)
+   */
+  template<typename U>
+  bool push_wait(U&& value,
+                 std::atomic<bool> const& running,
+                 std::chrono::milliseconds timeout = std::chrono::milliseconds::max());
+
+  /**
+   * @brief Pop into value, waiting while the queue is empty. Elements
+   * pushed before running was cleared are still returned
+   * @return false if running was cleared, or timeout passed, while the
+   * queue was empty
+   */
+  bool pop_wait(T& value,
+                std::atomic<bool> const& running,
+                std::chrono::milliseconds timeout = std::chrono::milliseconds::max());
+
+  /**
+   * @brief Get the number of elements in the queue, which may already
+   * have changed when it is returned
+   */
+  size_t size_approx() const;
+  bool empty() const { return size_approx() == 0; }
+  size_t capacity() const { return m_capacity; }
+
+private:
+  struct Cell
+  {
+    std::atomic<size_t> sequence;
+    detail::Slot<T> slot;
+  };
+
+  /**
+   * @brief Claim up to max_count consecutive cells whose sequence is
+   * their position plus offset (0 for free cells, 1 for full ones),
+   * by advancing position
+   * @return The number of cells claimed, from the returned position
+   */
+  size_t claim(std::atomic<size_t>& position, size_t offset, size_t max_count, size_t& first);
+
+  Cell& get_cell(size_t position) { return m_cells[position & (m_capacity - 1)]; }
+
+  const size_t m_capacity;
+  const std::unique_ptr<Cell[]> m_cells;
+
+  alignas(detail::kCacheLineSize) std::atomic<size_t> m_enqueue_position{ 0 };
+  alignas(detail::kCacheLineSize) std::atomic<size_t> m_dequeue_position{ 0 };
+};
+
+} // namespace utilities
+} // namespace dunedaq
+
+#include "detail/MPMCQueue.hxx"
+
+#endif // UTILITIES_INCLUDE_UTILITIES_MPMCQUEUE_HPP_
@@ -0,0 +1,122 @@
+/**
+ *
+ * @file Metrics.hpp Process-wide named counters, gauges and latency histograms
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef UTILITIES_INCLUDE_UTILITIES_METRICS_HPP_
+#define UTILITIES_INCLUDE_UTILITIES_METRICS_HPP_
+
+#include "utilities/LatencyHistogram.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace dunedaq {
+namespace utilities {
+
+/**
+ * @brief Counter is a handle on a named, process-wide count of events,
+ * such as tasks run or lookups made.
+ *
+ * Each thread increments its own slot for the counter, in memory which
+ * no other thread writes, so increment() is a plain load and store
+ * with no contention; get_value() adds up the slots of all threads,
+ * including those which have exited. Handles are cheap to copy, and
+ * are usually obtained once and kept:
+ *
+ * @code
+ * static auto s_fragments = get_counter("mymodule.fragments");
+ * s_fragments.increment();
+ * @endcode
+ */
+class Counter
+{
+public:
+  void increment(uint64_t n = 1); // NOLINT(build/unsigned)
+  uint64_t get_value() const;     // NOLINT(build/unsigned)
+  const std::string& get_name() const;
+
+private:
+  friend Counter get_counter(std::string const& name);
+
+  explicit Counter(size_t index)
+    : m_index(index)
+  {}
+
+  size_t m_index;
+};
+
+/**
+ * @brief Gauge is a handle on a named, process-wide level, such as
+ * tasks in flight, which may go up and down. Changes are kept per
+ * thread as for Counter, so a gauge may be raised on one thread and
+ * lowered on another.
+ */
+class Gauge
+{
+public:
+  void add(int64_t delta);
+  void increment() { add(1); }
+  void decrement() { add(-1); }
+
+  /**
+   * @brief Set the level. Changes made by other threads at the same
+   * time may be lost
+   */
+  void set(int64_t value);
+
+  int64_t get_value() const;
+  const std::string& get_name() const;
+
+private:
+  friend Gauge get_gauge(std::string const& name);
+
+  explicit Gauge(size_t index)
+    : m_index(index)
+  {}
+
+  size_t m_index;
+};
+
+/**
+ * @brief Get the counter called name, creating it at zero if needed
+ * @throws MetricsLimitReached if there are already kMaxMetrics counters and gauges
+ */
+Counter
+get_counter(std::string const& name);
+
+/**
+ * @brief Get the gauge called name, creating it at zero if needed
+ * @throws MetricsLimitReached if there are already kMaxMetrics counters and gauges
+ */
+Gauge
+get_gauge(std::string const& name);
+
+/**
+ * @brief Get the process-wide latency histogram called name, creating
+ * it if needed. It lives until the end of the process
+ */
+LatencyHistogram&
+get_latency_histogram(std::string const& name);
+
+/**
+ * @brief Get the values of all metrics, as
+ * {"counters": {name: value, ...}, "gauges": {...},
+ *  "histograms": {name: HistogramSnapshot::to_json(), ...}}
+ */
+nlohmann::json
+get_metrics_snapshot();
+
+} // namespace utilities
+} // namespace dunedaq
+
+#include "detail/Metrics.hxx"
+
+#endif // UTILITIES_INCLUDE_UTILITIES_METRICS_HPP_
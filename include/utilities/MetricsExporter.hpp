@@ -0,0 +1,105 @@
+/**
+ *
+ * @file MetricsExporter.hpp Periodic export of the metrics snapshot from a WorkerThread
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef UTILITIES_INCLUDE_UTILITIES_METRICSEXPORTER_HPP_
+#define UTILITIES_INCLUDE_UTILITIES_METRICSEXPORTER_HPP_
+
+#include "utilities/WorkerThread.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+
+namespace dunedaq {
+namespace utilities {
+
+/**
+ * @brief MetricsExporter takes a snapshot of the metrics (see
+ * get_metrics_snapshot()) at a fixed interval on a WorkerThread, and
+ * passes it to a sink, or appends it to a file as one line of JSON.
+ *
+ * Each report is the snapshot with "time_ms" (since the epoch),
+ * "interval_ms" (since the previous report) and "rates", the increase
+ * of each counter per second since the previous report. A last report
+ * is made when the exporter is stopped. Reports are passed to the sink
+ * one at a time, in the order they are made.
+ */
+class MetricsExporter
+{
+public:
+  using Sink = std::function<void(nlohmann::json const&)>;
+
+  MetricsExporter(std::chrono::milliseconds interval, Sink sink);
+
+  /**
+   * @brief Append reports to the file at path. The file is reopened for
+   * each report, so it may be rotated
+   * @throws MetricsExportFailed if the file cannot be opened
+   */
+  MetricsExporter(std::chrono::milliseconds interval, std::string const& path);
+
+  ~MetricsExporter();
+
+  MetricsExporter(const MetricsExporter&) = delete;            ///< MetricsExporter is not copy-constructible
+  MetricsExporter& operator=(const MetricsExporter&) = delete; ///< MetricsExporter is not copy-assignable
+  MetricsExporter(MetricsExporter&&) = delete;                 ///< MetricsExporter is not move-constructible
+  MetricsExporter& operator=(MetricsExporter&&) = delete;      ///< MetricsExporter is not move-assignable
+
+  /**
+   * @throws ThreadingIssue if the exporter is already running
+   */
+  void start();
+
+  /**
+   * @brief Stop the thread and make a last report. If the sink throws,
+   * this is reported as a warning (MetricsExportFailed)
+   * @throws ThreadingIssue if the exporter is not running
+   */
+  void stop();
+
+  bool is_running() const { return m_thread.thread_running(); }
+
+  /**
+   * @brief Make a report now, on the calling thread. Exceptions thrown
+   * by the sink are passed on
+   */
+  void export_now();
+
+private:
+  /**
+   * @brief Make a report, warning rather than throwing if the sink fails
+   */
+  void export_or_warn();
+
+  void do_work(std::atomic<bool>& running_flag);
+
+  const std::chrono::milliseconds m_interval;
+  const Sink m_sink;
+
+  // Held while a report is made and passed to the sink
+  std::mutex m_sink_mutex;
+  nlohmann::json m_previous_counters;
+  std::chrono::steady_clock::time_point m_previous_time;
+
+  std::mutex m_wait_mutex;
+  std::condition_variable m_wait_cv;
+  bool m_stop_requested{ false };
+
+  WorkerThread m_thread;
+};
+
+} // namespace utilities
+} // namespace dunedaq
+
+#endif // UTILITIES_INCLUDE_UTILITIES_METRICSEXPORTER_HPP_
@@ -9,6 +9,8 @@
 #ifndef UTILITIES_INCLUDE_UTILITIES_NAMEDOBJECT_HPP_
 #define UTILITIES_INCLUDE_UTILITIES_NAMEDOBJECT_HPP_
 
+#include "utilities/InternedName.hpp"
+
 #include <string>
 
 namespace dunedaq::utilities {
@@ -38,7 +40,10 @@ public:
 };
 
 /**
- * @brief Implements the Named interface
+ * @brief Implements the Named interface. The name is interned (see
+ * InternedName.hpp), so objects with the same name share its storage,
+ * and get_interned_name() gives a key which compares and hashes as an
+ * integer
  */
 class NamedObject : public Named
 {
@@ -51,6 +56,14 @@ public:
     : m_name(name)
   {}
 
+  /**
+   * @brief NamedObject Constructor from an already interned name
+   * @param name Name of this object
+   */
+  explicit NamedObject(InternedName name)
+    : m_name(name)
+  {}
+
   NamedObject(NamedObject const&) = delete;            ///< NamedObject is not copy-constructible
   NamedObject(NamedObject&&) = default;                ///< NamedObject is move-constructible
   NamedObject& operator=(NamedObject const&) = delete; ///< NamedObject is not copy-assignable
@@ -61,10 +74,16 @@ public:
    * @brief Get the name of this NamedObejct
    * @return The name of this NamedObject
    */
-  const std::string& get_name() const final { return m_name; }
+  const std::string& get_name() const final { return m_name.str(); }
+
+  /**
+   * @brief Get the interned name of this NamedObject, without a virtual call
+   * @return The interned name of this NamedObject
+   */
+  InternedName get_interned_name() const { return m_name; }
 
 private:
-  std::string m_name;
+  InternedName m_name;
 };
 
 } // namespace dunedaq::utilities
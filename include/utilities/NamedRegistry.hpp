@@ -0,0 +1,187 @@
+/**
+ *
+ * @file NamedRegistry.hpp Concurrent, read-mostly registry of Named objects
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef UTILITIES_INCLUDE_UTILITIES_NAMEDREGISTRY_HPP_
+#define UTILITIES_INCLUDE_UTILITIES_NAMEDREGISTRY_HPP_
+
+#include "utilities/InternedName.hpp"
+#include "utilities/NamedObject.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace dunedaq {
+namespace utilities {
+
+/**
+ * @brief NamedRegistry finds Named objects (or objects of a class
+ * derived from Named) by name, from any number of threads.
+ *
+ * Lookups take no lock: the registry's contents are an immutable
+ * snapshot, which registrations replace with an updated copy
+ * (read-copy-update). A replaced snapshot is freed once the lookups
+ * which may still be reading it have finished; each lookup announces
+ * itself by incrementing a counter which, in the common case, no other
+ * thread is using, so lookups scale with the number of threads.
+ * Registrations are expected to be rare (eg at configuration), and
+ * cost a copy of the registry.
+ *
+ * The registry does not own the objects. add() returns a Registration,
+ * which removes the object from the registry when it is destroyed, so
+ * it is typically kept as a member of the object's owner. Objects which
+ * have been destroyed before their Registration are not returned.
+ */
+template<typename T = Named>
+class NamedRegistry
+{
+public:
+  using object_ptr_t = std::shared_ptr<T>;
+
+  /**
+   * @brief Registration removes its object from the registry when it
+   * is destroyed (or reset). It must not outlive the registry
+   */
+  class Registration
+  {
+  public:
+    Registration() = default;
+    Registration(Registration const&) = delete;            ///< Registration is not copy-constructible
+    Registration& operator=(Registration const&) = delete; ///< Registration is not copy-assignable
+    Registration(Registration&& other) noexcept;
+    Registration& operator=(Registration&& other) noexcept;
+    ~Registration() { reset(); }
+
+    /**
+     * @brief Remove the object from the registry now
+     */
+    void reset();
+
+    bool is_registered() const { return m_registry != nullptr; }
+
+  private:
+    friend class NamedRegistry;
+    Registration(NamedRegistry* registry, InternedName name, uint64_t token) // NOLINT(build/unsigned)
+      : m_registry(registry)
+      , m_name(name)
+      , m_token(token)
+    {}
+
+    NamedRegistry* m_registry{ nullptr };
+    InternedName m_name;
+    uint64_t m_token{ 0 }; // NOLINT(build/unsigned)
+  };
+
+  NamedRegistry();
+  ~NamedRegistry();
+
+  NamedRegistry(NamedRegistry const&) = delete;            ///< NamedRegistry is not copy-constructible
+  NamedRegistry& operator=(NamedRegistry const&) = delete; ///< NamedRegistry is not copy-assignable
+  NamedRegistry(NamedRegistry&&) = delete;                 ///< NamedRegistry is not move-constructible
+  NamedRegistry& operator=(NamedRegistry&&) = delete;      ///< NamedRegistry is not move-assignable
+
+  /**
+   * @brief Register object under its name
+   * @throws NameAlreadyRegistered if a live object already has that name
+   */
+  [[nodiscard]] Registration add(object_ptr_t const& object);
+
+  /**
+   * @brief Find the object with the given name
+   * @return The object, or nullptr if there is none
+   */
+  object_ptr_t find(InternedName name) const;
+
+  /**
+   * @brief Find the object with the given name, without interning it
+   * @return The object, or nullptr if there is none
+   */
+  object_ptr_t find(std::string_view name) const;
+
+  /**
+   * @brief Get the registered objects which are still alive. Later
+   * changes to the registry do not affect the result
+   */
+  std::vector<object_ptr_t> get_all() const;
+
+  size_t size() const;
+
+private:
+  struct Entry
+  {
+    std::weak_ptr<T> object;
+    // Identifies the Registration, since a new object may reuse the address of a destroyed one
+    uint64_t token; // NOLINT(build/unsigned)
+  };
+
+  struct Snapshot
+  {
+    std::unordered_map<InternedName, Entry> by_name;
+    // Keys point to the text of the interned names, which lives as long as the process
+    std::unordered_map<std::string_view, InternedName> by_text;
+  };
+
+  /**
+   * @brief Counts the lookups in progress in each epoch, spread over
+   * stripes on separate cache lines. Threads use the stripe of their
+   * thread index
+   */
+  struct alignas(64) ReaderStripe
+  {
+    std::atomic<int64_t> count[2] = { { 0 }, { 0 } };
+  };
+  static constexpr size_t kNumStripes = 64;
+
+  /**
+   * @brief Announces a lookup for its lifetime, so that the snapshot
+   * it reads is not freed under it
+   */
+  class ReadGuard
+  {
+  public:
+    explicit ReadGuard(NamedRegistry const& registry);
+    ~ReadGuard();
+    ReadGuard(ReadGuard const&) = delete;
+    ReadGuard& operator=(ReadGuard const&) = delete;
+
+    Snapshot const& get() const { return *m_snapshot; }
+
+  private:
+    std::atomic<int64_t>* m_count;
+    const Snapshot* m_snapshot;
+  };
+
+  static size_t get_thread_stripe();
+
+  void remove(InternedName name, uint64_t token); // NOLINT(build/unsigned)
+
+  /**
+   * @brief Install snapshot and free the previous one once no lookup is
+   * reading it. Called with m_write_mutex held
+   */
+  void publish(std::unique_ptr<Snapshot> snapshot);
+
+  std::atomic<const Snapshot*> m_snapshot;
+  std::atomic<uint32_t> m_epoch{ 0 }; // NOLINT(build/unsigned)
+  mutable std::array<ReaderStripe, kNumStripes> m_readers;
+  std::mutex m_write_mutex;
+  uint64_t m_next_token{ 1 }; // NOLINT(build/unsigned)
+};
+
+} // namespace utilities
+} // namespace dunedaq
+
+#include "detail/NamedRegistry.hxx"
+
+#endif // UTILITIES_INCLUDE_UTILITIES_NAMEDREGISTRY_HPP_
@@ -0,0 +1,203 @@
+/**
+ *
+ * @file ObjectPool.hpp Thread-caching pools of fixed-size blocks, and the allocators built on them
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef UTILITIES_INCLUDE_UTILITIES_OBJECTPOOL_HPP_
+#define UTILITIES_INCLUDE_UTILITIES_OBJECTPOOL_HPP_
+
+#include <cstddef>
+#include <memory>
+
+namespace dunedaq {
+namespace utilities {
+
+struct PoolOptions
+{
+  size_t blocks_per_chunk{ 256 }; ///< Blocks added each time the pool grows
+  size_t thread_cache_size{ 64 }; ///< Free blocks each thread may keep for itself
+  bool use_hugepages{ false };    ///< Put chunks on huge pages (see PageMemory)
+};
+
+/**
+ * @brief FixedSizePool hands out blocks of one size from chunks of
+ * PageMemory, and takes them back, from any number of threads.
+ *
+ * Each thread keeps a cache of free blocks for each pool it uses, so
+ * allocate() and deallocate() normally touch no shared state; only
+ * when its cache is empty (or full) does a thread go to the pool's
+ * shared free list, to move half a cache of blocks at once. A block may
+ * be freed by a different thread from the one that allocated it. Once a
+ * pool has grown to its working set, it makes no further system
+ * allocations.
+ *
+ * Memory is only returned to the system when the pool and every thread
+ * which used it have gone away. Blocks must not be used after the pool
+ * is destroyed.
+ */
+class FixedSizePool
+{
+public:
+  struct Stats
+  {
+    size_t block_size{ 0 };
+    size_t chunks{ 0 };
+    size_t bytes_reserved{ 0 };
+    size_t blocks_reserved{ 0 };
+    size_t blocks_in_use{ 0 };
+    size_t allocations{ 0 };
+    size_t deallocations{ 0 };
+    size_t central_transfers{ 0 }; ///< How many times a thread cache was refilled or flushed
+    bool hugepages{ false };       ///< Whether every chunk is on reserved huge pages
+  };
+
+  /**
+   * @brief Block sizes from 1 to kMaxSizeClass bytes are served by the
+   * shared size-class pools used by PoolAllocator
+   */
+  static constexpr size_t kMaxSizeClass = 1024;
+
+  /**
+   * @throws InvalidPoolConfiguration if alignment is not a power of two
+   * no larger than a page, or if block_size or a count is zero
+   */
+  FixedSizePool(size_t block_size, size_t alignment = alignof(std::max_align_t), PoolOptions options = {});
+  ~FixedSizePool();
+
+  FixedSizePool(const FixedSizePool&) = delete;            ///< FixedSizePool is not copy-constructible
+  FixedSizePool& operator=(const FixedSizePool&) = delete; ///< FixedSizePool is not copy-assignable
+  FixedSizePool(FixedSizePool&&) = delete;                 ///< FixedSizePool is not move-constructible
+  FixedSizePool& operator=(FixedSizePool&&) = delete;      ///< FixedSizePool is not move-assignable
+
+  /**
+   * @throws std::bad_alloc if the pool needs to grow and cannot
+   */
+  void* allocate();
+  void deallocate(void* block);
+
+  size_t get_block_size() const;
+
+  /**
+   * @brief Get the pool's statistics. Counts still being updated by
+   * other threads may be slightly out of date
+   */
+  Stats get_stats() const;
+
+  /**
+   * @brief Get the process-wide pool for blocks of at least size bytes
+   * (up to kMaxSizeClass), aligned for any type. These pools are never
+   * destroyed
+   */
+  static FixedSizePool& get_size_class_pool(size_t size);
+
+  struct Central;
+
+private:
+  const std::shared_ptr<Central> m_central;
+};
+
+/**
+ * @brief ObjectPool constructs objects of type T in blocks of a
+ * FixedSizePool, for payloads which are created and destroyed at a
+ * high rate, possibly on different threads.
+ */
+template<typename T>
+class ObjectPool
+{
+public:
+  class Deleter
+  {
+  public:
+    explicit Deleter(ObjectPool* pool = nullptr)
+      : m_pool(pool)
+    {}
+
+    void operator()(T* object) const { m_pool->destroy(object); }
+
+  private:
+    ObjectPool* m_pool;
+  };
+
+  using Ptr = std::unique_ptr<T, Deleter>;
+
+  explicit ObjectPool(PoolOptions options = {})
+    : m_pool(sizeof(T), alignof(T), options)
+  {}
+
+  /**
+   * @brief Construct an object, which goes back to the pool when the
+   * returned pointer is destroyed
+   */
+  template<typename... Args>
+  Ptr create(Args&&... args);
+
+  /**
+   * @brief Construct an object, which must be given back with destroy()
+   */
+  template<typename... Args>
+  T* construct(Args&&... args);
+
+  void destroy(T* object);
+
+  FixedSizePool::Stats get_stats() const { return m_pool.get_stats(); }
+
+private:
+  FixedSizePool m_pool;
+};
+
+/**
+ * @brief PoolAllocator is a standard allocator which takes allocations
+ * of up to FixedSizePool::kMaxSizeClass bytes from the shared
+ * size-class pools, and larger ones from operator new. It suits node
+ * containers (std::list, std::map, std::unordered_map, ...), whose
+ * allocations are all small and the same size.
+ *
+ * PoolAllocators are stateless and all compare equal, so memory
+ * allocated through one may be freed through any other, on any thread.
+ */
+template<typename T>
+class PoolAllocator
+{
+public:
+  using value_type = T;
+
+  PoolAllocator() noexcept = default;
+
+  template<typename U>
+  PoolAllocator(const PoolAllocator<U>&) noexcept // NOLINT(runtime/explicit)
+  {}
+
+  T* allocate(size_t n);
+  void deallocate(T* pointer, size_t n) noexcept;
+
+private:
+  static bool is_pooled(size_t n)
+  {
+    return alignof(T) <= alignof(std::max_align_t) && n <= FixedSizePool::kMaxSizeClass / sizeof(T);
+  }
+};
+
+template<typename T, typename U>
+bool
+operator==(const PoolAllocator<T>&, const PoolAllocator<U>&) noexcept
+{
+  return true;
+}
+
+template<typename T, typename U>
+bool
+operator!=(const PoolAllocator<T>&, const PoolAllocator<U>&) noexcept
+{
+  return false;
+}
+
+} // namespace utilities
+} // namespace dunedaq
+
+#include "detail/ObjectPool.hxx"
+
+#endif // UTILITIES_INCLUDE_UTILITIES_OBJECTPOOL_HPP_
@@ -0,0 +1,64 @@
+/**
+ *
+ * @file PageMemory.hpp Memory mapped directly from the kernel, optionally on huge pages
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef UTILITIES_INCLUDE_UTILITIES_PAGEMEMORY_HPP_
+#define UTILITIES_INCLUDE_UTILITIES_PAGEMEMORY_HPP_
+
+#include <cstddef>
+
+namespace dunedaq {
+namespace utilities {
+
+/**
+ * @brief PageMemory owns a zero-filled, page-aligned mapping, which
+ * backs the chunks of FixedSizePool and Arena.
+ *
+ * When huge pages are requested, the size is rounded up to a multiple
+ * of kHugePageSize and reserved huge pages (MAP_HUGETLB) are tried
+ * first; if none are available the mapping uses normal pages, and is
+ * marked for transparent huge pages instead. is_huge() tells which one
+ * was obtained. Throws std::bad_alloc if the mapping fails.
+ */
+class PageMemory
+{
+public:
+  static constexpr size_t kHugePageSize = 2 * 1024 * 1024;
+
+  PageMemory(size_t size, bool use_hugepages);
+  ~PageMemory();
+
+  PageMemory(PageMemory&& other) noexcept;
+  PageMemory& operator=(PageMemory&& other) noexcept;
+  PageMemory(const PageMemory&) = delete;            ///< PageMemory is not copy-constructible
+  PageMemory& operator=(const PageMemory&) = delete; ///< PageMemory is not copy-assignable
+
+  void* data() const { return m_data; }
+
+  /**
+   * @brief Get the size of the mapping, which may be larger than requested
+   */
+  size_t size() const { return m_size; }
+
+  /**
+   * @brief Whether the mapping is on reserved huge pages
+   */
+  bool is_huge() const { return m_huge; }
+
+  static size_t get_page_size();
+
+private:
+  void* m_data;
+  size_t m_size;
+  bool m_huge;
+};
+
+} // namespace utilities
+} // namespace dunedaq
+
+#endif // UTILITIES_INCLUDE_UTILITIES_PAGEMEMORY_HPP_
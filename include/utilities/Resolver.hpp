@@ -11,7 +11,13 @@
 #define UTILITIES_INCLUDE_UTILITIES_RESOLVER_HPP_
 
 #include "logging/Logging.hpp"
+#include "utilities/Endpoint.hpp"
 #include "utilities/Issues.hpp"
+#include "utilities/ResolverBackend.hpp"
+#include "utilities/ResolverCache.hpp"
+#include "utilities/Retry.hpp"
+#include "utilities/ServiceRecord.hpp"
+#include "utilities/ZmqUri.hpp"
 
 #include <arpa/nameser.h>
 #include <netdb.h>
@@ -19,13 +25,23 @@
 #include <resolv.h>
 #include <sys/types.h>
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace dunedaq {
 
 namespace utilities {
 
+/**
+ * @brief Look up the addresses of a host, ordered by the address policy
+ * (see AddressPolicy.hpp): by default IPv4 only, with addresses on
+ * this host's subnets first
+ */
 std::vector<std::string>
 get_ips_from_hostname(std::string hostname);
 
@@ -35,20 +51,216 @@ resolve_uri_hostname(std::string connection_string);
 std::vector<std::string>
 get_service_addresses(std::string service_name, std::string const& hostname = "");
 
-struct ZmqUri {
-  std::string scheme{""};
-  std::string host{""};
-  std::string port{""};
-  std::string to_string()
-  {
-    auto tmp = scheme + "://" + host;
-    if (port != "")
-      return tmp + ":" + port;
-  return tmp;
-  }
+/**
+ * @brief Look up the addresses of a host, as with get_ips_from_hostname,
+ * but without converting them to strings. The endpoints get the given
+ * scheme and port
+ */
+std::vector<Endpoint>
+get_endpoints_from_hostname(std::string const& hostname,
+                            uint16_t port = 0, // NOLINT(build/unsigned)
+                            std::string const& scheme = "tcp");
+
+/**
+ * @brief Resolve the host of a tcp connection string (eg
+ * tcp://hostname:5555) into endpoints. Other schemes have no network
+ * address, and give an empty result
+ * @throws InvalidUri if the connection string, or its port, is not valid
+ */
+std::vector<Endpoint>
+resolve_uri_endpoints(std::string_view connection_string);
+
+/**
+ * @brief Resolve a connection string as resolve_uri_endpoints does, but
+ * without reading the resolver caches, and put the answer in the
+ * hostname cache over the previous one. Used to refresh watched names
+ * @return The endpoints, empty if the host does not exist, or
+ * std::nullopt if the lookup failed (the cached answer is then kept)
+ * @throws InvalidUri if the connection string, or its port, is not valid
+ */
+std::optional<std::vector<Endpoint>>
+refresh_uri_endpoints(std::string_view connection_string);
+
+/**
+ * @brief Get the DNS name under which a service is looked up: a bare
+ * name (without dots) becomes "_name._tcp", followed by ".hostname" if
+ * hostname is given; other names are used as they are. This is also
+ * the key of the service's entry in the service cache
+ */
+std::string
+get_service_dns_name(std::string service_name, std::string const& hostname = "");
+
+/**
+ * @brief Look up the SRV records of a service, keeping their priority,
+ * weight, port and TTL. Service names are interpreted as for
+ * get_service_addresses, which returns the same endpoints flattened to
+ * "ip:port" strings. See ServiceSelection.hpp for choosing among them
+ */
+std::vector<ServiceRecord>
+get_service_records(std::string service_name, std::string const& hostname = "");
+
+/**
+ * @brief Look up a service as get_service_records does, but without
+ * reading the resolver caches, and put the answer in them over the
+ * previous one
+ * @return The records, empty if the service has no SRV records, or
+ * std::nullopt if the lookup failed, or none of the targets could be
+ * resolved (the cached answers are then kept)
+ */
+std::optional<std::vector<ServiceRecord>>
+refresh_service_records(std::string service_name, std::string const& hostname = "");
+
+/**
+ * @brief Look up the endpoints of a service, as get_service_addresses
+ * does, in record order
+ */
+std::vector<Endpoint>
+get_service_endpoints(std::string service_name, std::string const& hostname = "");
+
+/**
+ * @brief Options for the batch resolution functions
+ */
+struct BatchResolveOptions
+{
+  /// Maximum number of lookups in flight at once
+  size_t max_concurrency{ 16 };
+  /// Time after which a single lookup is abandoned (and reported with
+  /// ResolveTimeout). Inputs for which no lookup thread is free (eg all
+  /// are stuck in abandoned lookups) fail the same way without waiting
+  std::chrono::milliseconds timeout{ std::chrono::seconds(5) };
 };
-ZmqUri
-parse_connection_string(std::string connection_string);
+
+/**
+ * @brief Resolve many connection strings concurrently, as with
+ * resolve_uri_hostname. Results are returned in input order; inputs
+ * which fail, are invalid or time out give an empty result (and are
+ * reported via ERS rather than thrown)
+ */
+std::vector<std::vector<std::string>>
+resolve_many(std::vector<std::string> const& connection_strings,
+             BatchResolveOptions const& options = BatchResolveOptions());
+
+/**
+ * @brief Look up many services concurrently, as with
+ * get_service_addresses. Results are returned in input order; services
+ * which are not found or time out give an empty result
+ */
+std::vector<std::vector<std::string>>
+get_service_addresses_many(std::vector<std::string> const& service_names,
+                           std::string const& hostname = "",
+                           BatchResolveOptions const& options = BatchResolveOptions());
+
+/**
+ * @brief Join the threads on which the batch functions run their
+ * lookups, waiting for any lookups still in progress (including those
+ * abandoned after their timeout). Batches run later start new
+ * threads. Call this before the end of main() to make sure that no
+ * lookup outlives it; otherwise the threads are joined during static
+ * destruction
+ */
+void
+shutdown_resolver_workers();
+
+/**
+ * @brief Default maximum age of entries in the resolver caches
+ */
+constexpr std::chrono::milliseconds kDefaultResolverCacheMaxAge = std::chrono::seconds(60);
+
+/**
+ * @brief Process-wide cache of host addresses, shared by
+ * get_ips_from_hostname and get_endpoints_from_hostname. The cached
+ * endpoints have no scheme and port 0. getaddrinfo does not report
+ * record TTLs, so entries are kept for the cache's maximum age
+ */
+ResolverCache<std::vector<Endpoint>>&
+get_hostname_cache();
+
+/**
+ * @brief Process-wide cache of get_service_records results, kept for
+ * the smallest TTL of the SRV records (capped by the cache's maximum age)
+ */
+ResolverCache<std::vector<ServiceRecord>>&
+get_service_cache();
+
+/**
+ * @brief Send DNS queries to the given nameservers (IPv4, at most
+ * MAXNS, with their ports) instead of those in /etc/resolv.conf, eg
+ * to use a local test server. Host lookups then also go through DNS
+ * rather than getaddrinfo (so /etc/hosts is not consulted). Non-zero
+ * timeout and attempts override the resolver's per-query timeout and
+ * number of attempts. An empty list restores the system configuration.
+ * The resolver caches are invalidated
+ * @throws InvalidResolverConfiguration if a nameserver is not IPv4, or there are too many
+ */
+void
+set_resolver_nameservers(std::vector<Endpoint> const& nameservers,
+                         std::chrono::seconds timeout = std::chrono::seconds(0),
+                         int attempts = 0);
+
+/**
+ * @brief Default time for which failed lookups are remembered
+ */
+constexpr std::chrono::milliseconds kDefaultResolverNegativeTtl = std::chrono::seconds(2);
+
+/**
+ * @brief Set the time for which failed lookups are remembered, so that
+ * repeating them within this time returns the (empty) result without
+ * querying DNS again. Zero disables negative caching. The caches'
+ * maximum age still applies
+ */
+void
+set_resolver_negative_ttl(std::chrono::milliseconds ttl);
+
+std::chrono::milliseconds
+get_resolver_negative_ttl();
+
+/**
+ * @brief Default interval over which repeated failures for a name are collapsed
+ */
+constexpr std::chrono::milliseconds kDefaultResolverErrorReportInterval = std::chrono::seconds(10);
+
+/**
+ * @brief Failures to resolve a name are reported to ERS at most once per
+ * interval; later failures are counted, and the count reported
+ * (ResolveFailuresSuppressed) by the first lookup after the interval
+ * ends. Zero reports every failure
+ */
+void
+set_resolver_error_report_interval(std::chrono::milliseconds interval);
+
+/**
+ * @brief get_service_addresses, retried with jittered exponential
+ * backoff until the service has addresses (see retry_with_backoff).
+ * Retries drop the cached failure first, so that each one queries DNS
+ */
+std::vector<std::string>
+get_service_addresses_with_retry(std::string const& service_name,
+                                 std::string const& hostname = "",
+                                 RetryPolicy const& policy = RetryPolicy(),
+                                 const std::atomic<bool>* running = nullptr);
+
+/**
+ * @brief resolve_uri_hostname, retried with jittered exponential backoff
+ * until the host has addresses (see retry_with_backoff). Retries drop
+ * the cached failure first, so that each one queries DNS
+ */
+std::vector<std::string>
+resolve_uri_hostname_with_retry(std::string const& connection_string,
+                                RetryPolicy const& policy = RetryPolicy(),
+                                const std::atomic<bool>* running = nullptr);
+
+/**
+ * @brief Set the maximum age of entries in both resolver caches. Zero
+ * disables caching
+ */
+void
+set_resolver_cache_max_age(std::chrono::milliseconds max_age);
+
+/**
+ * @brief Remove all entries from both resolver caches
+ */
+void
+invalidate_resolver_cache();
 
 } // namespace utilities
 } // namespace dunedaq
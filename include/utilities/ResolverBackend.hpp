@@ -0,0 +1,156 @@
+/**
+ *
+ * @file ResolverBackend.hpp Name sources consulted by the Resolver before DNS
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef UTILITIES_INCLUDE_UTILITIES_RESOLVERBACKEND_HPP_
+#define UTILITIES_INCLUDE_UTILITIES_RESOLVERBACKEND_HPP_
+
+#include "utilities/Endpoint.hpp"
+#include "utilities/ServiceRecord.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace dunedaq {
+namespace utilities {
+
+/**
+ * @brief ResolverBackend is a source of host addresses and service
+ * records which the Resolver functions consult before DNS.
+ *
+ * Backends are installed in a process-wide chain (see
+ * add_resolver_backend) and asked in the order they were added; the
+ * first one to know a name answers, and names no backend knows fall
+ * through to DNS. Backend answers are not put in the resolver caches.
+ */
+class ResolverBackend
+{
+public:
+  virtual ~ResolverBackend() = default;
+
+  /**
+   * @brief Look up hostname, counting the hit or miss
+   * @return The addresses of hostname (scheme empty, port 0), or
+   * std::nullopt if this backend does not know it
+   */
+  std::optional<std::vector<Endpoint>> find_host(std::string const& hostname);
+
+  /**
+   * @brief Look up the SRV records of service_name (eg
+   * "_name._tcp.domain"), counting the hit or miss. The records'
+   * targets are resolved afterwards, through the whole chain
+   * @return The records, or std::nullopt if this backend does not know
+   * the service
+   */
+  std::optional<std::vector<ServiceRecord>> find_service(std::string const& service_name);
+
+  uint64_t get_hits() const { return m_hits.load(std::memory_order_relaxed); }     // NOLINT(build/unsigned)
+  uint64_t get_misses() const { return m_misses.load(std::memory_order_relaxed); } // NOLINT(build/unsigned)
+  void reset_statistics();
+
+protected:
+  virtual std::optional<std::vector<Endpoint>> lookup_host(std::string const& hostname) = 0;
+  virtual std::optional<std::vector<ServiceRecord>> lookup_service(std::string const& service_name) = 0;
+
+private:
+  template<typename Result>
+  Result count(Result&& result);
+
+  std::atomic<uint64_t> m_hits{ 0 };   // NOLINT(build/unsigned)
+  std::atomic<uint64_t> m_misses{ 0 }; // NOLINT(build/unsigned)
+};
+
+/**
+ * @brief StaticResolverBackend answers from in-memory host and service
+ * tables, typically loaded from the configuration, eg
+ *
+ *   {
+ *     "hosts": { "daq-node-01": [ "10.0.0.1" ] },
+ *     "services": {
+ *       "_dataflow._tcp": [ { "target": "daq-node-01", "port": 5555, "priority": 0, "weight": 10 } ]
+ *     }
+ *   }
+ *
+ * Addresses must be numeric. Names are matched exactly. In service
+ * entries, "priority", "weight" and "ttl" default to 0.
+ */
+class StaticResolverBackend : public ResolverBackend
+{
+public:
+  StaticResolverBackend() = default;
+
+  /**
+   * @brief Load the tables from a JSON object in the format above
+   * @throws InvalidResolverConfiguration if the JSON does not match it
+   */
+  static std::shared_ptr<StaticResolverBackend> from_json(nlohmann::json const& json);
+
+  /**
+   * @brief Load the tables from a JSON file in the format above
+   * @throws InvalidResolverConfiguration if the file cannot be read or parsed
+   */
+  static std::shared_ptr<StaticResolverBackend> from_file(std::string const& path);
+
+  /**
+   * @brief Add (or replace) the addresses of hostname
+   * @throws InvalidResolverConfiguration if an address is not numeric
+   */
+  void add_host(std::string const& hostname, std::vector<std::string> const& addresses);
+
+  /**
+   * @brief Add (or replace) the records of service_name. Their endpoints are ignored
+   */
+  void add_service(std::string const& service_name, std::vector<ServiceRecord> records);
+
+protected:
+  std::optional<std::vector<Endpoint>> lookup_host(std::string const& hostname) override;
+  std::optional<std::vector<ServiceRecord>> lookup_service(std::string const& service_name) override;
+
+private:
+  mutable std::shared_mutex m_mutex;
+  std::unordered_map<std::string, std::vector<Endpoint>> m_hosts;
+  std::unordered_map<std::string, std::vector<ServiceRecord>> m_services;
+};
+
+/**
+ * @brief Append backend to the process-wide chain consulted before DNS
+ */
+void
+add_resolver_backend(std::shared_ptr<ResolverBackend> backend);
+
+/**
+ * @brief Remove backend from the chain
+ */
+void
+remove_resolver_backend(std::shared_ptr<ResolverBackend> const& backend);
+
+/**
+ * @brief Remove all backends, so that every lookup goes to DNS
+ */
+void
+clear_resolver_backends();
+
+/**
+ * @brief Get the current chain. This is an immutable snapshot: it is
+ * cheap to get, and is not affected by later changes to the chain
+ */
+std::shared_ptr<const std::vector<std::shared_ptr<ResolverBackend>>>
+get_resolver_backends();
+
+} // namespace utilities
+} // namespace dunedaq
+
+#endif // UTILITIES_INCLUDE_UTILITIES_RESOLVERBACKEND_HPP_
@@ -0,0 +1,114 @@
+/**
+ *
+ * @file ResolverCache.hpp Cache of DNS lookup results
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef UTILITIES_INCLUDE_UTILITIES_RESOLVERCACHE_HPP_
+#define UTILITIES_INCLUDE_UTILITIES_RESOLVERCACHE_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+namespace dunedaq {
+namespace utilities {
+
+/**
+ * @brief ResolverCache is a thread-safe cache of lookup results keyed
+ * by name, each of which expires after its time-to-live.
+ *
+ * Entries are kept for the smaller of the TTL given when they are
+ * stored and the cache's maximum age, so a maximum age of zero
+ * disables the cache. Expired entries are ignored by get(), and
+ * removed by put() whenever the cache has grown to twice its size
+ * after the previous sweep. The cache holds at most max_entries; when
+ * it is full of unexpired entries, put() drops the eighth of them
+ * which would expire soonest.
+ *
+ * Values are shared, so that a hit doesn't copy the value.
+ */
+template<typename Value>
+class ResolverCache
+{
+public:
+  using clock_t = std::chrono::steady_clock;
+
+  static constexpr size_t kDefaultMaxEntries = 16384;
+
+  explicit ResolverCache(std::chrono::milliseconds max_age, size_t max_entries = kDefaultMaxEntries);
+
+  ResolverCache(const ResolverCache&) = delete;            ///< ResolverCache is not copy-constructible
+  ResolverCache& operator=(const ResolverCache&) = delete; ///< ResolverCache is not copy-assignable
+  ResolverCache(ResolverCache&&) = delete;                 ///< ResolverCache is not move-constructible
+  ResolverCache& operator=(ResolverCache&&) = delete;      ///< ResolverCache is not move-assignable
+
+  /**
+   * @brief Get the cached value for name, if there is an unexpired one,
+   * or nullptr
+   */
+  std::shared_ptr<const Value> get(const std::string& name) const;
+
+  /**
+   * @brief Store value for name, to expire after min(ttl, max age)
+   */
+  void put(const std::string& name, const Value& value, std::chrono::milliseconds ttl);
+
+  /**
+   * @brief Store value for name, to expire after the max age
+   */
+  void put(const std::string& name, const Value& value) { put(name, value, get_max_age()); }
+
+  /**
+   * @brief Remove all entries
+   */
+  void invalidate();
+
+  /**
+   * @brief Remove the entry for name
+   */
+  void invalidate(const std::string& name);
+
+  void set_max_age(std::chrono::milliseconds max_age);
+  std::chrono::milliseconds get_max_age() const;
+
+  void set_max_entries(size_t max_entries);
+  size_t get_max_entries() const;
+
+  size_t size() const;
+  uint64_t get_hits() const { return m_hits.load(); }     // NOLINT(build/unsigned)
+  uint64_t get_misses() const { return m_misses.load(); } // NOLINT(build/unsigned)
+
+private:
+  struct Entry
+  {
+    std::shared_ptr<const Value> value;
+    clock_t::time_point expiry;
+  };
+
+  // Make room for an entry, with m_mutex held exclusively
+  void make_room(clock_t::time_point now);
+
+  mutable std::shared_mutex m_mutex;
+  std::unordered_map<std::string, Entry> m_entries;
+  std::chrono::milliseconds m_max_age;
+  size_t m_max_entries;
+  size_t m_sweep_size; // Size at which put() next removes expired entries
+
+  mutable std::atomic<uint64_t> m_hits{ 0 };   // NOLINT(build/unsigned)
+  mutable std::atomic<uint64_t> m_misses{ 0 }; // NOLINT(build/unsigned)
+};
+
+} // namespace utilities
+} // namespace dunedaq
+
+#include "detail/ResolverCache.hxx"
+
+#endif // UTILITIES_INCLUDE_UTILITIES_RESOLVERCACHE_HPP_
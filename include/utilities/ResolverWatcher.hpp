@@ -0,0 +1,132 @@
+/**
+ *
+ * @file ResolverWatcher.hpp Background re-resolution of names and services
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef UTILITIES_INCLUDE_UTILITIES_RESOLVERWATCHER_HPP_
+#define UTILITIES_INCLUDE_UTILITIES_RESOLVERWATCHER_HPP_
+
+#include "utilities/Endpoint.hpp"
+#include "utilities/WorkerThread.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace dunedaq {
+namespace utilities {
+
+/**
+ * @brief ResolverWatcher keeps the endpoints of registered connection
+ * strings and services up to date from a background thread, and tells
+ * subscribers when they change.
+ *
+ * Each watched name is resolved when it is registered and then again
+ * when its answer expires: after the smallest TTL of its SRV records
+ * for services, and after the hostname cache's maximum age for hosts
+ * (getaddrinfo does not report TTLs). The interval is clamped to
+ * [min_interval, max_interval]. Each refresh bypasses the resolver
+ * caches (see refresh_uri_endpoints and refresh_service_records) and
+ * stores its answer in them, so synchronous lookups of watched names
+ * stay cache hits.
+ *
+ * The callback is called, on the watcher thread, with the new endpoints
+ * whenever the set of endpoints changes (the order of the addresses
+ * in the answer is ignored). A name which no longer exists, or a
+ * service without SRV records, gives an empty set. A failed lookup
+ * keeps the previous endpoints, and is retried after the negative TTL
+ * (but not sooner than min_interval).
+ */
+class ResolverWatcher
+{
+public:
+  using callback_t = std::function<void(std::vector<Endpoint> const&)>;
+
+  explicit ResolverWatcher(std::chrono::milliseconds min_interval = std::chrono::seconds(1),
+                           std::chrono::milliseconds max_interval = std::chrono::seconds(60));
+
+  ~ResolverWatcher();
+
+  ResolverWatcher(const ResolverWatcher&) = delete;            ///< ResolverWatcher is not copy-constructible
+  ResolverWatcher& operator=(const ResolverWatcher&) = delete; ///< ResolverWatcher is not copy-assignable
+  ResolverWatcher(ResolverWatcher&&) = delete;                 ///< ResolverWatcher is not move-constructible
+  ResolverWatcher& operator=(ResolverWatcher&&) = delete;      ///< ResolverWatcher is not move-assignable
+
+  /**
+   * @brief Watch the host of a tcp connection string, as resolved by
+   * resolve_uri_endpoints
+   * @return An id for unwatch() and get_endpoints()
+   * @throws InvalidUri if connection_string is not a valid tcp connection string
+   */
+  size_t watch_uri(std::string const& connection_string, callback_t callback);
+
+  /**
+   * @brief Watch a service, as resolved by get_service_endpoints
+   * @return An id for unwatch() and get_endpoints()
+   */
+  size_t watch_service(std::string const& service_name, std::string const& hostname, callback_t callback);
+
+  /**
+   * @brief Stop watching. The callback is not called after this returns,
+   * unless it is called from the callback itself
+   */
+  void unwatch(size_t id);
+
+  /**
+   * @brief Get the latest endpoints of a watched name, without any lookup.
+   * Empty until the first successful lookup
+   */
+  std::vector<Endpoint> get_endpoints(size_t id) const;
+
+  size_t get_num_watched() const;
+
+private:
+  enum class Kind
+  {
+    kUri,
+    kService
+  };
+
+  struct Watch
+  {
+    Kind kind;
+    std::string name;
+    std::string hostname;
+    callback_t callback;
+    std::vector<Endpoint> endpoints;
+    std::chrono::steady_clock::time_point next_refresh;
+  };
+
+  size_t add_watch(Watch watch);
+  void refresh(size_t id, Watch watch);
+  std::chrono::milliseconds clamp_interval(std::chrono::milliseconds interval) const;
+  void run(std::atomic<bool>& running_flag);
+
+  std::chrono::milliseconds m_min_interval;
+  std::chrono::milliseconds m_max_interval;
+
+  mutable std::mutex m_mutex;
+  std::condition_variable m_cv;
+  std::map<size_t, Watch> m_watches;
+  size_t m_next_id{ 0 };
+  bool m_stopping{ false };
+
+  // Serialises callbacks with unwatch()
+  std::recursive_mutex m_callback_mutex;
+
+  WorkerThread m_thread;
+};
+
+} // namespace utilities
+} // namespace dunedaq
+
+#endif // UTILITIES_INCLUDE_UTILITIES_RESOLVERWATCHER_HPP_
@@ -0,0 +1,61 @@
+/**
+ *
+ * @file Retry.hpp Retrying operations with jittered exponential backoff
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef UTILITIES_INCLUDE_UTILITIES_RETRY_HPP_
+#define UTILITIES_INCLUDE_UTILITIES_RETRY_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+
+namespace dunedaq {
+namespace utilities {
+
+/**
+ * @brief How retry_with_backoff spaces out its attempts
+ */
+struct RetryPolicy
+{
+  /// Delay after the first failed attempt
+  std::chrono::milliseconds initial_delay{ 100 };
+  /// Largest delay between attempts
+  std::chrono::milliseconds max_delay{ 5000 };
+  /// Factor by which the delay grows after each failed attempt
+  double multiplier{ 2.0 };
+  /// Fraction of each delay which is randomised, so that processes
+  /// retrying the same lookup spread out rather than retrying together
+  double jitter{ 0.5 };
+  /// Time after which no new attempt is started. Zero means no limit
+  std::chrono::milliseconds timeout{ 30000 };
+  /// Maximum number of attempts. Zero means no limit
+  size_t max_attempts{ 0 };
+};
+
+/**
+ * @brief Call attempt until its result is not empty, sleeping between
+ * attempts for delays which grow exponentially from
+ * policy.initial_delay to policy.max_delay, each shortened by a random
+ * fraction of up to policy.jitter.
+ *
+ * Gives up, returning the last (empty) result, when policy.timeout or
+ * policy.max_attempts is reached, or when running becomes false.
+ *
+ * @param attempt Callable returning a container-like result
+ */
+template<typename Attempt>
+auto
+retry_with_backoff(Attempt&& attempt, RetryPolicy const& policy, const std::atomic<bool>* running = nullptr)
+  -> decltype(attempt());
+
+} // namespace utilities
+} // namespace dunedaq
+
+#include "detail/Retry.hxx"
+
+#endif // UTILITIES_INCLUDE_UTILITIES_RETRY_HPP_
@@ -18,6 +18,7 @@
 #include <mutex>
 #include <string>
 #include <thread>
+#include <vector>
 
 namespace dunedaq {
 namespace utilities {
@@ -53,12 +54,42 @@ public:
     if (!m_task_assigned && m_task_executed.exchange(false)) {
       m_task = std::bind(f, args...);
       m_task_assigned = true;
-      m_cv.notify_all();
+      wake_worker();
+      count_assignment(true);
       return true;
     }
+    count_assignment(false);
     return false;
   }
 
+  /**
+   * @brief Set a batch of tasks to be executed back-to-back, with one
+   * wake-up of the thread, and readiness once all of them (and any
+   * appended with append_work) have run
+   * @return false, leaving tasks untouched, if the thread is busy. On
+   * success tasks is left empty, keeping storage which may be reused for
+   * the next batch
+   */
+  bool set_work_batch(std::vector<std::function<void()>>& tasks);
+
+  /**
+   * @brief Append a task to the batch being executed
+   * @return false if no batch is being executed, or the thread has
+   * already run its last task and is about to become ready
+   */
+  bool append_work(std::function<void()> task);
+
+  // Set f to be called on each element of [first, last) as one task
+  template<typename Iterator, typename Function>
+  bool set_work_range(Iterator first, Iterator last, Function&& f)
+  {
+    return set_work([first, last, f = std::forward<Function>(f)]() mutable {
+      for (auto it = first; it != last; ++it) {
+        f(*it);
+      }
+    });
+  }
+
 private:
   // Internals
   int m_thread_id;
@@ -66,15 +97,30 @@ private:
   std::atomic<bool> m_task_assigned;
   std::atomic<bool> m_thread_quit;
   std::atomic<bool> m_worker_done;
-  std::function<void()> m_task;
+  std::function<void()> m_task; // Empty when a batch is assigned
+
+  // Tasks of the batch not yet taken by the worker, and whether more may be appended
+  std::mutex m_batch_mtx;
+  std::vector<std::function<void()>> m_batch;
+  bool m_batch_open;
 
   // Locks
   std::mutex m_mtx;
   std::condition_variable m_cv;
   std::thread m_thread;
 
+
   // Actual worker thread
   void thread_worker();
+
+  // Run the batch, including tasks appended while it runs
+  void run_batch();
+
+  // Notify the worker without losing the wake-up if it is about to wait
+  void wake_worker();
+
+  // Count accepted and rejected tasks in the process-wide metrics
+  static void count_assignment(bool accepted);
 };
 
 } // namespace utilities
@@ -0,0 +1,139 @@
+/**
+ *
+ * @file SPSCQueue.hpp Bounded lock-free single-producer, single-consumer queue
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef UTILITIES_INCLUDE_UTILITIES_SPSCQUEUE_HPP_
+#define UTILITIES_INCLUDE_UTILITIES_SPSCQUEUE_HPP_
+
+#include "utilities/detail/QueueSupport.hxx"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+
+namespace dunedaq {
+namespace utilities {
+
+/**
+ * @brief SPSCQueue is a bounded ring buffer for handing elements from
+ * one producer thread to one consumer thread without locks.
+ *
+ * The producer's and the consumer's positions are on separate cache
+ * lines, and each side keeps a copy of the other's position, which it
+ * only refreshes when the queue looks full (or empty), so an element
+ * costs no cache-line transfer beyond the element itself in the common
+ * case. The batch functions publish a whole batch with one store.
+ *
+ * The capacity is rounded up to a power of two. Only one thread may
+ * push and only one thread may pop at a time (they may be different
+ * threads, and change over time if the handover is synchronised).
+ *
+ * The waiting functions take the running flag of a WorkerThread (or
+ * any std::atomic<bool>), and give up when it is cleared, so a
+ * do_work loop blocked on the queue exits promptly when the thread is
+ * stopped:
+ *
+ * @code
+ * void do_work(std::atomic<bool>& running_flag) {
+ *   Fragment fragment;
+ *   while (m_queue.pop_wait(fragment, running_flag)) {
+ *     process(fragment);
+ *   }
+ * }
+ * @endcode
+ */
+template<typename T>
+class alignas(detail::kCacheLineSize) SPSCQueue // Aligned so that nothing else shares its cache lines
+{
+public:
+  explicit SPSCQueue(size_t capacity);
+  ~SPSCQueue();
+
+  SPSCQueue(const SPSCQueue&) = delete;            ///< SPSCQueue is not copy-constructible
+  SPSCQueue& operator=(const SPSCQueue&) = delete; ///< SPSCQueue is not copy-assignable
+  SPSCQueue(SPSCQueue&&) = delete;                 ///< SPSCQueue is not move-constructible
+  SPSCQueue& operator=(SPSCQueue&&) = delete;      ///< SPSCQueue is not move-assignable
+
+  /**
+   * @brief Construct an element at the back of the queue
+   * @return false if the queue is full
+   */
+  template<typename... Args>
+  bool try_emplace(Args&&... args);
+
+  bool try_push(const T& value) { return try_emplace(value); }
+  bool try_push(T&& value) { return try_emplace(std::move(value)); }
+
+  /**
+   * @brief Move the element at the front of the queue into value
+   * @return false if the queue is empty
+   */
+  bool try_pop(T& value);
+
+  /**
+   * @brief Move as many elements of [first, last) as fit into the queue
+   * @return The iterator after the last element pushed
+   */
+  template<typename InputIt>
+  InputIt try_push_batch(InputIt first, InputIt last);
+
+  /**
+   * @brief Move up to max_count elements from the queue to out
+   * @return The number of elements popped
+   */
+  template<typename OutputIt>
+  size_t try_pop_batch(OutputIt out, size_t max_count);
+
+  /**
+   * @brief Push value, waiting while the queue is full
+   * @return false if running was cleared, or timeout passed, while the
+   * queue was full (value is then left as it was)
+   */
+  template<typename U>
+  bool push_wait(U&& value,
+                 std::atomic<bool> const& running,
+                 std::chrono::milliseconds timeout = std::chrono::milliseconds::max());
+
+  /**
+   * @brief Pop into value, waiting while the queue is empty. Elements
+   * pushed before running was cleared are still returned
+   * @return false if running was cleared, or timeout passed, while the
+   * queue was empty
+   */
+  bool pop_wait(T& value,
+                std::atomic<bool> const& running,
+                std::chrono::milliseconds timeout = std::chrono::milliseconds::max());
+
+  /**
+   * @brief Get the number of elements in the queue, which may already
+   * have changed when it is returned
+   */
+  size_t size_approx() const;
+  bool empty() const { return size_approx() == 0; }
+  size_t capacity() const { return m_capacity; }
+
+private:
+  const size_t m_capacity;
+  const std::unique_ptr<detail::Slot<T>[]> m_slots;
+
+  // Consumer side
+  alignas(detail::kCacheLineSize) std::atomic<size_t> m_head{ 0 };
+  size_t m_cached_tail{ 0 };
+
+  // Producer side
+  alignas(detail::kCacheLineSize) std::atomic<size_t> m_tail{ 0 };
+  size_t m_cached_head{ 0 };
+};
+
+} // namespace utilities
+} // namespace dunedaq
+
+#include "detail/SPSCQueue.hxx"
+
+#endif // UTILITIES_INCLUDE_UTILITIES_SPSCQUEUE_HPP_
@@ -0,0 +1,39 @@
+/**
+ *
+ * @file ServiceRecord.hpp DNS SRV record
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef UTILITIES_INCLUDE_UTILITIES_SERVICERECORD_HPP_
+#define UTILITIES_INCLUDE_UTILITIES_SERVICERECORD_HPP_
+
+#include "utilities/Endpoint.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace dunedaq {
+namespace utilities {
+
+/**
+ * @brief A DNS SRV record, together with the endpoints (address and
+ * record port) of its target host
+ */
+struct ServiceRecord
+{
+  std::string target{ "" };
+  uint16_t priority{ 0 }; // NOLINT(build/unsigned)
+  uint16_t weight{ 0 };   // NOLINT(build/unsigned)
+  uint16_t port{ 0 };     // NOLINT(build/unsigned)
+  uint32_t ttl{ 0 };      // NOLINT(build/unsigned)
+  std::vector<Endpoint> endpoints;
+};
+
+} // namespace utilities
+} // namespace dunedaq
+
+#endif // UTILITIES_INCLUDE_UTILITIES_SERVICERECORD_HPP_
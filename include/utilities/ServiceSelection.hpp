@@ -0,0 +1,69 @@
+/**
+ *
+ * @file ServiceSelection.hpp Choosing among the SRV records of a service
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef UTILITIES_INCLUDE_UTILITIES_SERVICESELECTION_HPP_
+#define UTILITIES_INCLUDE_UTILITIES_SERVICESELECTION_HPP_
+
+#include "utilities/Resolver.hpp"
+
+#include <random>
+#include <string>
+#include <vector>
+
+namespace dunedaq {
+namespace utilities {
+
+/**
+ * @brief Order records in which they should be tried, as described in
+ * RFC 2782: by increasing priority, and within each priority by a
+ * random selection weighted by the records' weights. Records of weight
+ * zero come after the others of their priority. Records whose target
+ * has no addresses are dropped
+ */
+std::vector<ServiceRecord>
+order_service_records(std::vector<ServiceRecord> records, std::mt19937_64& rng);
+
+/**
+ * @brief As above, with a per-thread random number generator
+ */
+std::vector<ServiceRecord>
+order_service_records(std::vector<ServiceRecord> records);
+
+/**
+ * @brief Pick the record to connect to: the first in RFC 2782 order,
+ * ie a weighted random choice among the records of the best priority.
+ * Records whose target has no addresses are ignored.
+ * @return A pointer into records, or nullptr if none is usable
+ */
+const ServiceRecord*
+select_service_record(std::vector<ServiceRecord> const& records, std::mt19937_64& rng);
+
+/**
+ * @brief As above, with a per-thread random number generator
+ */
+const ServiceRecord*
+select_service_record(std::vector<ServiceRecord> const& records);
+
+/**
+ * @brief Pick the record for client_key by weighted rendezvous
+ * (highest random weight) hashing among the records of the best
+ * priority. The same key always maps to the same record while the
+ * record set is unchanged, on every host, and adding or removing a
+ * record only moves the keys that map to it. Records of weight zero
+ * are only chosen if all records have weight zero, and records whose
+ * target has no addresses are ignored.
+ * @return A pointer into records, or nullptr if none is usable
+ */
+const ServiceRecord*
+select_service_record(std::vector<ServiceRecord> const& records, std::string const& client_key);
+
+} // namespace utilities
+} // namespace dunedaq
+
+#endif // UTILITIES_INCLUDE_UTILITIES_SERVICESELECTION_HPP_
@@ -27,14 +27,21 @@ namespace utilities {
 class TimestampEstimator : public TimestampEstimatorBase
 {
 public:
-  TimestampEstimator(uint32_t run_number, uint64_t clock_frequency_hz);
+  TimestampEstimator(uint32_t run_number,
+                     uint64_t clock_frequency_hz, // NOLINT(build/unsigned)
+                     std::shared_ptr<Clock> clock = nullptr);
 
-  explicit TimestampEstimator(uint64_t clock_frequency_hz); // NOLINT(build/unsigned)
+  explicit TimestampEstimator(uint64_t clock_frequency_hz, // NOLINT(build/unsigned)
+                              std::shared_ptr<Clock> clock = nullptr);
 
   virtual ~TimestampEstimator();
 
   uint64_t get_timestamp_estimate() const override { return m_current_timestamp_estimate.load(); }
 
+  /**
+   * @brief Update the timestamp estimate with a new (DAQ time, system
+   * time) pair, and notify any update callbacks
+   */
   void add_timestamp_datapoint(uint64_t daq_time, uint64_t system_time);
 
   template <class T>
@@ -42,6 +49,7 @@ public:
 
   uint64_t get_received_timesync_count() const { return m_received_timesync_count.load(); }
 private:
+  void update_timestamp_estimate(uint64_t daq_time, uint64_t system_time);
 
   std::atomic<uint64_t> m_current_timestamp_estimate;
 
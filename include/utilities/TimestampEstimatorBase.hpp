@@ -9,11 +9,55 @@
 #ifndef UTILITIES_INCLUDE_UTILITIES_TIMESTAMPESTIMATORBASE_HPP_
 #define UTILITIES_INCLUDE_UTILITIES_TIMESTAMPESTIMATORBASE_HPP_
 
+#include "utilities/Clock.hpp"
+
 #include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
 
 namespace dunedaq {
 namespace utilities {
 
+/**
+ * @brief WaitPolicy controls how the deadline versions of the
+ * TimestampEstimatorBase wait functions pass the time.
+ *
+ * When the expected time until the wait ends (the earlier of the
+ * deadline, and the time at which the estimate is expected to reach
+ * the target) is at most spin_threshold, the waiter busy-waits with a
+ * CPU pause; when it is at most yield_threshold, the waiter yields;
+ * otherwise it sleeps until spin/yield range is reached, for at most
+ * max_sleep at a time.
+ */
+struct WaitPolicy
+{
+  Clock::duration spin_threshold{ 0 };
+  Clock::duration yield_threshold{ 0 };
+  Clock::duration max_sleep{ std::chrono::milliseconds(10) };
+
+  /**
+   * @brief Only ever sleep, for at most 10 ms at a time (the behaviour
+   * of the wait functions without a deadline)
+   */
+  static WaitPolicy sleeping() { return WaitPolicy(); }
+
+  /**
+   * @brief Spin for the last 20 us and yield for the last 200 us, for
+   * microsecond-accurate release at the cost of a busy core
+   */
+  static WaitPolicy low_latency()
+  {
+    return WaitPolicy{ std::chrono::microseconds(20), std::chrono::microseconds(200), std::chrono::milliseconds(1) };
+  }
+};
+
 /**
  * @brief TimestampEstimatorBase is the base class for timestamp-based
  * logic in test systems where the current timestamp must be estimated
@@ -22,13 +66,39 @@ namespace utilities {
 class TimestampEstimatorBase
 {
 public:
+  /**
+   * @brief Construct a TimestampEstimatorBase which uses the system clock
+   */
+  TimestampEstimatorBase();
+
+  /**
+   * @brief Construct a TimestampEstimatorBase which uses the given clock
+   * for the current time and for sleeping in the wait functions. A null
+   * clock means the system clock
+   */
+  explicit TimestampEstimatorBase(std::shared_ptr<Clock> clock);
+
   virtual ~TimestampEstimatorBase() = default;
   virtual uint64_t get_timestamp_estimate() const = 0;
 
+  /**
+   * @brief Predict how long it will be until the estimate reaches ts,
+   * if the estimator can tell (eg, because the estimate advances
+   * steadily with its clock). Used to size the sleeps in the deadline
+   * wait functions. The default is to make no prediction
+   */
+  virtual std::optional<Clock::duration> predict_time_to_timestamp(uint64_t /*ts*/) const { return std::nullopt; }
+
+  /**
+   * @brief Get the clock used by this estimator
+   */
+  const std::shared_ptr<Clock>& get_clock() const { return m_clock; }
+
   enum WaitStatus
   {
     kFinished,
-    kInterrupted
+    kInterrupted,
+    kTimedOut
   };
 
   /**
@@ -47,6 +117,78 @@ public:
      Returns kFinished if the timestamp became valid, or kInterrupted if continue_flag became false first
   */
   WaitStatus wait_for_timestamp(uint64_t ts, std::atomic<bool>& continue_flag);
+
+  /**
+     Wait for the current timestamp estimate to become valid, for
+     continue_flag to become false, or for the estimator's clock to
+     reach deadline, passing the time as specified by policy.
+
+     Returns kFinished if the timestamp became valid, kInterrupted if
+     continue_flag became false first, or kTimedOut if the deadline
+     passed first
+  */
+  WaitStatus wait_for_valid_timestamp(std::atomic<bool>& continue_flag,
+                                      Clock::time_point deadline,
+                                      const WaitPolicy& policy = WaitPolicy());
+
+  /**
+     Wait for the current timestamp estimate to reach ts, for
+     continue_flag to become false, or for the estimator's clock to
+     reach deadline, passing the time as specified by policy.
+
+     Returns kFinished if the timestamp reached ts, kInterrupted if
+     continue_flag became false first, or kTimedOut if the deadline
+     passed first
+  */
+  WaitStatus wait_for_timestamp(uint64_t ts,
+                                std::atomic<bool>& continue_flag,
+                                Clock::time_point deadline,
+                                const WaitPolicy& policy = WaitPolicy());
+
+  /**
+     Register a function to be called whenever the timestamp estimate
+     is updated by an estimator that is driven by incoming data (eg,
+     TimeSync messages). Estimators that compute the timestamp on
+     demand never call it. Callbacks are called without any internal
+     lock held, so they may add or remove update callbacks (including
+     their own).
+
+     Returns an id to be passed to remove_update_callback
+  */
+  size_t add_update_callback(std::function<void()> callback);
+
+  /**
+     Remove a callback registered with add_update_callback. It will not
+     be called again, and once this returns it is not running on any
+     other thread. When called from an update callback, this doesn't
+     wait for other threads (which could be waiting for this one), so
+     the removed callback may still be running on threads which were
+     already notifying
+  */
+  void remove_update_callback(size_t id);
+
+protected:
+  /**
+     Call all the registered update callbacks. To be called by derived
+     classes after they update their estimate
+  */
+  void notify_update_callbacks();
+
+private:
+  std::shared_ptr<Clock> m_clock;
+
+  std::mutex m_update_callbacks_mutex;
+  std::condition_variable m_update_callbacks_cv;
+  struct UpdateCallback
+  {
+    std::function<void()> function;
+    size_t num_running{ 0 }; // Threads running this callback
+  };
+
+  std::map<size_t, std::shared_ptr<UpdateCallback>> m_update_callbacks;
+  std::vector<std::thread::id> m_notifying_threads; // Threads running update callbacks
+  std::atomic<size_t> m_num_update_callbacks{ 0 };
+  size_t m_next_update_callback_id{ 0 };
 };
 
 } // namespace utilities
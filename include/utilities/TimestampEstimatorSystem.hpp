@@ -12,6 +12,8 @@
 #include "utilities/TimestampEstimatorBase.hpp"
 #include "utilities/Issues.hpp"
 
+#include <memory>
+
 namespace dunedaq {
 namespace utilities {
 
@@ -22,10 +24,13 @@ namespace utilities {
 class TimestampEstimatorSystem : public TimestampEstimatorBase
 {
 public:
-  explicit TimestampEstimatorSystem(uint64_t clock_frequency_hz); // NOLINT(build/unsigned)
+  explicit TimestampEstimatorSystem(uint64_t clock_frequency_hz, // NOLINT(build/unsigned)
+                                    std::shared_ptr<Clock> clock = nullptr);
 
   uint64_t get_timestamp_estimate() const override;
 
+  std::optional<Clock::duration> predict_time_to_timestamp(uint64_t ts) const override;
+
 private:
   uint64_t m_clock_frequency_hz; // NOLINT(build/unsigned)
 };
@@ -0,0 +1,218 @@
+/**
+ * @file TimestampWaitScheduler.hpp TimestampWaitScheduler Class
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef UTILITIES_INCLUDE_UTILITIES_TIMESTAMPWAITSCHEDULER_HPP_
+#define UTILITIES_INCLUDE_UTILITIES_TIMESTAMPWAITSCHEDULER_HPP_
+
+#include "utilities/Clock.hpp"
+#include "utilities/TimestampEstimatorBase.hpp"
+#include "utilities/WorkerThread.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#include <coroutine>
+#define UTILITIES_HAS_TIMESTAMP_AWAITABLES 1
+#endif
+
+namespace dunedaq {
+namespace utilities {
+
+/**
+ * @brief TimestampWaitScheduler provides the waits of
+ * TimestampEstimatorBase without blocking a thread per wait.
+ *
+ * Pending waits are stored in a table ordered by target timestamp,
+ * and are completed from poll(). poll() is called from the
+ * estimator's update path (see
+ * TimestampEstimatorBase::add_update_callback) and, if poll_interval
+ * is non-zero, from a timer thread which wakes up every poll_interval
+ * of the estimator's clock. Estimators which compute the timestamp on
+ * demand (eg TimestampEstimatorSystem) need the timer thread. The timer
+ * can't sleep on a clock which advances when slept on (a SimulatedClock
+ * built with advance_on_sleep), so the constructor throws
+ * InvalidSchedulerConfiguration for such a clock unless poll_interval
+ * is zero; drive those schedulers by calling poll() directly. Waits
+ * are interrupted (as for the blocking waits) once their
+ * continue_flag becomes false; this is noticed at the next poll().
+ *
+ * Completion callbacks, and coroutines resumed by the awaitables, run
+ * on the thread calling poll(), so they should be short or hand off
+ * their work. The scheduler must outlive all pending waits' callers,
+ * and must be destroyed before its estimator; pending waits are
+ * completed with kInterrupted on destruction. A scheduler destroyed
+ * from the estimator's update path doesn't wait for other threads
+ * updating the estimator (see
+ * TimestampEstimatorBase::remove_update_callback), so the estimator
+ * must not be updated from more than one thread at a time then.
+ *
+ * When compiled as C++20, until() and valid() return awaitables, eg
+ *
+ * @code
+ * auto status = co_await scheduler.until(ts, running_flag);
+ * @endcode
+ */
+class TimestampWaitScheduler
+{
+public:
+  using WaitStatus = TimestampEstimatorBase::WaitStatus;
+  using callback_t = std::function<void(WaitStatus)>;
+
+  explicit TimestampWaitScheduler(TimestampEstimatorBase& estimator,
+                                  Clock::duration poll_interval = std::chrono::milliseconds(1));
+
+  ~TimestampWaitScheduler();
+
+  TimestampWaitScheduler(const TimestampWaitScheduler&) = delete;            ///< not copy-constructible
+  TimestampWaitScheduler& operator=(const TimestampWaitScheduler&) = delete; ///< not copy-assignable
+  TimestampWaitScheduler(TimestampWaitScheduler&&) = delete;                 ///< not move-constructible
+  TimestampWaitScheduler& operator=(TimestampWaitScheduler&&) = delete;      ///< not move-assignable
+
+  /**
+     Call callback once the timestamp estimate becomes valid (with
+     kFinished), or once continue_flag becomes false (with
+     kInterrupted). If either is already the case, callback is called
+     before this function returns
+  */
+  void async_wait_for_valid_timestamp(std::atomic<bool>& continue_flag, callback_t callback);
+
+  /**
+     Call callback once the timestamp estimate reaches ts (with
+     kFinished), or once continue_flag becomes false (with
+     kInterrupted). If either is already the case, callback is called
+     before this function returns
+  */
+  void async_wait_for_timestamp(uint64_t ts, std::atomic<bool>& continue_flag, callback_t callback);
+
+  /**
+     Complete all pending waits which are satisfied or interrupted
+  */
+  void poll();
+
+  /**
+     Get the number of waits which have not yet completed
+  */
+  size_t get_num_pending() const;
+
+#ifdef UTILITIES_HAS_TIMESTAMP_AWAITABLES
+  class Awaitable;
+
+  /**
+     Get an awaitable for the timestamp estimate reaching ts. co_await
+     yields kFinished or kInterrupted
+  */
+  Awaitable until(uint64_t ts, std::atomic<bool>& continue_flag);
+
+  /**
+     Get an awaitable for the timestamp estimate becoming valid.
+     co_await yields kFinished or kInterrupted
+  */
+  Awaitable valid(std::atomic<bool>& continue_flag);
+#endif
+
+private:
+  struct Waiter
+  {
+    std::atomic<bool>* continue_flag;
+    callback_t callback;
+  };
+
+  bool is_reached(uint64_t estimate, uint64_t ts) const;
+  // Remove a waiter from the table, with m_waiters_mutex held
+  std::multimap<uint64_t, Waiter>::iterator erase_waiter( // NOLINT(build/unsigned)
+    std::multimap<uint64_t, Waiter>::iterator it);        // NOLINT(build/unsigned)
+  void run_timer(std::atomic<bool>& running_flag);
+
+  TimestampEstimatorBase& m_estimator;
+  Clock::duration m_poll_interval;
+
+  mutable std::mutex m_waiters_mutex;
+  std::multimap<uint64_t, Waiter> m_waiters; // NOLINT(build/unsigned)
+  // The distinct continue flags of the waiters, with their number of
+  // waiters, so that poll() checks each flag once rather than each waiter
+  std::map<std::atomic<bool>*, size_t> m_continue_flags;
+
+  size_t m_update_callback_id;
+  WorkerThread m_timer;
+};
+
+#ifdef UTILITIES_HAS_TIMESTAMP_AWAITABLES
+/**
+ * @brief Awaitable returned by TimestampWaitScheduler::until and
+ * TimestampWaitScheduler::valid
+ */
+class TimestampWaitScheduler::Awaitable
+{
+public:
+  Awaitable(TimestampWaitScheduler& scheduler, uint64_t ts, std::atomic<bool>& continue_flag)
+    : m_scheduler(scheduler)
+    , m_ts(ts)
+    , m_continue_flag(continue_flag)
+  {}
+
+  bool await_ready()
+  {
+    if (!m_continue_flag.load()) {
+      m_status = TimestampEstimatorBase::kInterrupted;
+      return true;
+    }
+    return m_scheduler.is_reached(m_scheduler.m_estimator.get_timestamp_estimate(), m_ts);
+  }
+
+  bool await_suspend(std::coroutine_handle<> handle)
+  {
+    // The callback may run before async_wait_for_timestamp returns: on
+    // this thread, if the wait is already satisfied, or on another.
+    // Whichever of the callback and this function finishes second
+    // decides: if it's the callback, it resumes the suspended coroutine;
+    // if it's this function, the coroutine doesn't suspend at all, so it
+    // is never resumed on a stack which is still inside
+    // await_suspend. Once the coroutine may have been resumed, this
+    // must not be touched
+    m_handle = handle;
+    m_scheduler.async_wait_for_timestamp(m_ts, m_continue_flag, [this](WaitStatus status) {
+      m_status = status;
+      if (m_first_finished.exchange(true)) {
+        m_handle.resume();
+      }
+    });
+    return !m_first_finished.exchange(true);
+  }
+
+  WaitStatus await_resume() const noexcept { return m_status; }
+
+private:
+  TimestampWaitScheduler& m_scheduler;
+  uint64_t m_ts; // NOLINT(build/unsigned)
+  std::atomic<bool>& m_continue_flag;
+  WaitStatus m_status{ TimestampEstimatorBase::kFinished };
+  std::coroutine_handle<> m_handle;
+  std::atomic<bool> m_first_finished{ false };
+};
+
+inline TimestampWaitScheduler::Awaitable
+TimestampWaitScheduler::until(uint64_t ts, std::atomic<bool>& continue_flag)
+{
+  return Awaitable(*this, ts, continue_flag);
+}
+
+inline TimestampWaitScheduler::Awaitable
+TimestampWaitScheduler::valid(std::atomic<bool>& continue_flag)
+{
+  return Awaitable(*this, 0, continue_flag);
+}
+#endif
+
+} // namespace utilities
+} // namespace dunedaq
+
+#endif // UTILITIES_INCLUDE_UTILITIES_TIMESTAMPWAITSCHEDULER_HPP_
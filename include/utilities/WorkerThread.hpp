@@ -18,11 +18,18 @@
 
 #include "ers/ers.hpp"
 
+#include <sys/types.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <functional>
 #include <future>
 #include <list>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 
 namespace dunedaq {
 
@@ -37,6 +44,36 @@ ERS_DECLARE_ISSUE(utilities,                           // Namespace
 // Re-enable coverage collection LCOV_EXCL_STOP
 
 namespace utilities {
+
+/**
+ * @brief Options for a WorkerThread
+ */
+struct WorkerThreadOptions
+{
+  /**
+   * @brief Keep the OS thread parked after stop_working_thread(), and
+   * run do_work() on it again at the next start_working_thread(), rather
+   * than creating a thread for each start. The thread keeps its CPU
+   * affinity and warm stack between runs, and is joined when the
+   * WorkerThread is destroyed
+   */
+  bool park_between_runs = false;
+
+  /**
+   * @brief How long stop_working_thread() waits for do_work() to return
+   * before giving up with a ThreadingIssue describing the stuck thread.
+   * Zero waits for ever
+   */
+  std::chrono::milliseconds stop_timeout{ 0 };
+
+  /**
+   * @brief Add the thread's kernel stack, read from /proc, to that
+   * ThreadingIssue. Reading it usually needs CAP_SYS_ADMIN; the wait
+   * channel (wchan) of the thread is always added
+   */
+  bool report_kernel_stack = false;
+};
+
 /**
  * @brief WorkerThread contains a thread which runs the do_work()
  * function
@@ -82,34 +119,84 @@ public:
    */
   explicit WorkerThread(std::function<void(std::atomic<bool>&)> do_work);
 
+  WorkerThread(std::function<void(std::atomic<bool>&)> do_work, WorkerThreadOptions options);
+
+  /**
+   * @brief Join the parked thread, if there is one. If a stop timed out,
+   * warn (ThreadingIssue) and wait for do_work() to return. Like
+   * std::thread, a WorkerThread must not be destroyed while its thread
+   * is running
+   */
+  ~WorkerThread();
+
   /**
    * @brief Start the working thread (which executes the do_work() function)
-   * @throws ThreadingIssue if the thread is already running
+   * @throws ThreadingIssue if the thread is already running, or still stopping
    */
   void start_working_thread(const std::string& name = "noname");
   /**
-   * @brief Stop the working thread
+   * @brief Stop the working thread, returning once do_work() has returned
    * @throws ThreadingIssue If the thread has not yet been started
    * @throws ThreadingIssue If the thread is not in the joinable state
    * @throws ThreadingIssue If an exception occurs during thread join
+   * @throws ThreadingIssue If do_work() has not returned within the stop
+   * timeout of the options. The thread is then left stopping, and
+   * calling stop_working_thread() again waits for it once more
    */
   void stop_working_thread();
 
+  /**
+   * @brief Stop the working thread, waiting at most timeout (or for
+   * ever, if it is zero) for do_work() to return
+   */
+  void stop_working_thread(std::chrono::milliseconds timeout);
+
   /**
    * @brief Determine if the thread is currently running
    * @return Whether the thread is currently running
    */
   bool thread_running() const { return m_thread_running.load(); }
 
+  /**
+   * @brief Determine if a stop has timed out without do_work() returning
+   */
+  bool thread_stopping() const { return m_stop_pending.load(); }
+
+  /**
+   * @brief Time from the last stop request until do_work() returned. The
+   * stop latencies of all WorkerThreads are also recorded in the
+   * "worker_thread.stop_time" histogram (see get_latency_histogram())
+   */
+  std::chrono::nanoseconds get_last_stop_latency() const { return m_last_stop_latency; }
+
   WorkerThread(const WorkerThread&) = delete;            ///< WorkerThread is not copy-constructible
   WorkerThread& operator=(const WorkerThread&) = delete; ///< WorkerThread is not copy-assginable
   WorkerThread(WorkerThread&&) = delete;                 ///< WorkerThread is not move-constructible
   WorkerThread& operator=(WorkerThread&&) = delete;      ///< WorkerThread is not move-assignable
 
 private:
+  // Runs do_work() when asked, once, or until asked to quit if the thread parks between runs
+  void thread_main();
+
+  // Describe a thread which has not stopped in time, for the ThreadingIssue
+  std::string describe_stuck_thread() const;
+
   std::atomic<bool> m_thread_running;
   std::unique_ptr<std::thread> m_working_thread;
   std::function<void(std::atomic<bool>&)> m_do_work;
+  const WorkerThreadOptions m_options;
+  std::string m_thread_name;
+  std::atomic<pid_t> m_thread_tid;
+  std::atomic<bool> m_stop_pending;
+  std::chrono::steady_clock::time_point m_stop_requested_time;
+  std::chrono::nanoseconds m_last_stop_latency;
+
+  // Hand-over between the controlling thread and a parked working thread
+  std::mutex m_run_mutex;
+  std::condition_variable m_run_cv;
+  bool m_run_requested;
+  bool m_run_done;
+  bool m_quit_requested;
 };
 } // namespace utilities
 
@@ -0,0 +1,188 @@
+/**
+ *
+ * @file ZmqUri.hpp ZMQ connection string parsing and formatting
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef UTILITIES_INCLUDE_UTILITIES_ZMQURI_HPP_
+#define UTILITIES_INCLUDE_UTILITIES_ZMQURI_HPP_
+
+#include "utilities/Issues.hpp"
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace dunedaq {
+namespace utilities {
+
+/**
+ * @brief Non-owning view of the parts of a ZMQ connection string, eg
+ *
+ *   tcp://host:port, tcp://[::1]:port, tcp://eth0:port,
+ *   tcp://source;host:port, ipc:///tmp/socket, inproc://name
+ *
+ * For tcp-like schemes, host is the host name, address (IPv6 without
+ * its brackets) or interface, and source is the part before a ';', if
+ * any. IPv6 addresses must be bracketed. For ipc and inproc, host is
+ * everything after "://".
+ */
+struct ZmqUriView
+{
+  std::string_view scheme;
+  std::string_view source;
+  std::string_view host;
+  std::string_view port;
+
+  /**
+   * @brief Whether the host part has no port (ipc and inproc)
+   */
+  constexpr bool is_local() const { return scheme == "ipc" || scheme == "inproc"; }
+
+  /**
+   * @brief Whether the host must be written between brackets (IPv6 literals)
+   */
+  constexpr bool needs_brackets() const { return !is_local() && host.find(':') != std::string_view::npos; }
+
+  /**
+   * @brief Number of characters that format() writes
+   */
+  constexpr size_t formatted_size() const
+  {
+    return scheme.size() + 3 + (source.empty() ? 0 : source.size() + 1) + host.size() + (needs_brackets() ? 2 : 0) +
+           (port.empty() ? 0 : port.size() + 1);
+  }
+
+  /**
+   * @brief Write the connection string into buffer, without a terminating NUL.
+   * @return The number of characters of the connection string; if this is
+   * larger than size, nothing was written
+   */
+  constexpr size_t format(char* buffer, size_t size) const
+  {
+    auto needed = formatted_size();
+    if (needed > size) {
+      return needed;
+    }
+    size_t pos = 0;
+    auto append = [&](std::string_view part) {
+      for (auto c : part) {
+        buffer[pos++] = c;
+      }
+    };
+    append(scheme);
+    append("://");
+    if (!source.empty()) {
+      append(source);
+      append(";");
+    }
+    append(needs_brackets() ? "[" : "");
+    append(host);
+    append(needs_brackets() ? "]" : "");
+    if (!port.empty()) {
+      append(":");
+      append(port);
+    }
+    return needed;
+  }
+
+  std::string to_string() const
+  {
+    std::string output(formatted_size(), '\0');
+    format(output.data(), output.size());
+    return output;
+  }
+};
+
+/**
+ * @brief Parse a ZMQ connection string without allocating.
+ * @return false if the string is not a valid connection string
+ */
+constexpr bool
+try_parse_connection_string(std::string_view connection_string, ZmqUriView& output)
+{
+  output = ZmqUriView();
+
+  auto scheme_end = connection_string.find("://");
+  if (scheme_end == std::string_view::npos || scheme_end == 0) {
+    return false;
+  }
+  output.scheme = connection_string.substr(0, scheme_end);
+  auto rest = connection_string.substr(scheme_end + 3);
+
+  if (output.is_local()) {
+    output.host = rest;
+    return true;
+  }
+
+  auto source_end = rest.find(';');
+  if (source_end != std::string_view::npos) {
+    output.source = rest.substr(0, source_end);
+    rest = rest.substr(source_end + 1);
+  }
+
+  if (!rest.empty() && rest.front() == '[') {
+    auto bracket_end = rest.find(']');
+    if (bracket_end == std::string_view::npos) {
+      return false;
+    }
+    output.host = rest.substr(1, bracket_end - 1);
+    rest = rest.substr(bracket_end + 1);
+    if (!rest.empty()) {
+      if (rest.front() != ':') {
+        return false;
+      }
+      output.port = rest.substr(1);
+    }
+    return true;
+  }
+
+  // Without brackets, the port is after the only colon. IPv6 addresses
+  // must be bracketed, as eg "fe80::1" could be host "fe80:" and port "1"
+  auto port_start = rest.find(':');
+  if (port_start != std::string_view::npos) {
+    if (rest.find(':', port_start + 1) != std::string_view::npos) {
+      return false;
+    }
+    output.port = rest.substr(port_start + 1);
+    rest = rest.substr(0, port_start);
+  }
+  output.host = rest;
+  return true;
+}
+
+/**
+ * @brief Parse a ZMQ connection string without allocating.
+ * @throws InvalidUri if the string is not a valid connection string
+ */
+ZmqUriView
+parse_connection_string_view(std::string_view connection_string);
+
+/**
+ * @brief Owning counterpart of ZmqUriView
+ */
+struct ZmqUri
+{
+  std::string scheme{ "" };
+  std::string host{ "" };
+  std::string port{ "" };
+  std::string source{ "" };
+
+  ZmqUriView view() const { return ZmqUriView{ scheme, source, host, port }; }
+  std::string to_string() const { return view().to_string(); }
+};
+
+/**
+ * @brief Parse a ZMQ connection string into its (owned) parts.
+ * @throws InvalidUri if the string is not a valid connection string
+ */
+ZmqUri
+parse_connection_string(std::string_view connection_string);
+
+} // namespace utilities
+} // namespace dunedaq
+
+#endif // UTILITIES_INCLUDE_UTILITIES_ZMQURI_HPP_
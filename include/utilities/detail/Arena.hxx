@@ -0,0 +1,27 @@
+#include <limits>
+#include <new>
+#include <utility>
+
+namespace dunedaq {
+namespace utilities {
+
+template<typename T, typename... Args>
+T*
+Arena::create(Args&&... args)
+{
+  static_assert(std::is_trivially_destructible_v<T>, "Arena does not run destructors");
+  return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+}
+
+template<typename T>
+T*
+ArenaAllocator<T>::allocate(size_t n)
+{
+  if (n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+    throw std::bad_array_new_length();
+  }
+  return static_cast<T*>(m_arena->allocate(n * sizeof(T), alignof(T)));
+}
+
+} // namespace utilities
+} // namespace dunedaq
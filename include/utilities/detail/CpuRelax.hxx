@@ -0,0 +1,33 @@
+/**
+ * @file CpuRelax.hxx Spin-wait hint shared by the clocks and the queues
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef UTILITIES_INCLUDE_UTILITIES_DETAIL_CPURELAX_HXX_
+#define UTILITIES_INCLUDE_UTILITIES_DETAIL_CPURELAX_HXX_
+
+namespace dunedaq {
+namespace utilities {
+namespace detail {
+
+/**
+ * @brief Tell the CPU that this is a spin-wait loop
+ */
+inline void
+cpu_relax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__)
+  asm volatile("yield" ::: "memory"); // NOLINT(hicpp-no-assembler)
+#endif
+}
+
+} // namespace detail
+} // namespace utilities
+} // namespace dunedaq
+
+#endif // UTILITIES_INCLUDE_UTILITIES_DETAIL_CPURELAX_HXX_
@@ -0,0 +1,115 @@
+#include <algorithm>
+
+namespace dunedaq {
+namespace utilities {
+
+namespace detail {
+
+/**
+ * @brief The shards of the histograms recently used by this thread, by
+ * histogram id. The cache is set-associative: a histogram's entry is
+ * in the set given by its id, and each set is kept in most recently
+ * used order, so a thread can use several histograms whose ids share a
+ * set without evicting them in turn. Ids are never reused, so an entry
+ * for a destroyed histogram is never matched again
+ */
+struct HistogramShardCacheEntry
+{
+  uint64_t id{ 0 }; // NOLINT(build/unsigned)
+  LatencyHistogram::Shard* shard{ nullptr };
+};
+constexpr size_t kHistogramShardCacheSets = 16;
+constexpr size_t kHistogramShardCacheWays = 4;
+using HistogramShardCacheSet = std::array<HistogramShardCacheEntry, kHistogramShardCacheWays>;
+inline thread_local std::array<HistogramShardCacheSet, kHistogramShardCacheSets> t_histogram_shards{};
+
+inline void
+increment(std::atomic<uint64_t>& counter, uint64_t value) // NOLINT(build/unsigned)
+{
+  // Only the owning thread writes a shard, so this needs no read-modify-write
+  counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+} // namespace detail
+
+inline size_t
+LatencyHistogram::get_bucket_index(uint64_t value) // NOLINT(build/unsigned)
+{
+  if (value < kSubBuckets) {
+    return value;
+  }
+  size_t msb = 63 - __builtin_clzll(value);
+  if (msb >= kMaxValueBits) {
+    return kBuckets - 1;
+  }
+  auto shift = msb - kSubBucketBits;
+  return (shift + 1) * kSubBuckets + (value >> shift) - kSubBuckets;
+}
+
+inline uint64_t // NOLINT(build/unsigned)
+LatencyHistogram::get_bucket_upper_bound(size_t index)
+{
+  if (index < kSubBuckets) {
+    return index;
+  }
+  auto shift = index / kSubBuckets - 1;
+  uint64_t sub_bucket = index % kSubBuckets + kSubBuckets; // NOLINT(build/unsigned)
+  return ((sub_bucket + 1) << shift) - 1;
+}
+
+inline LatencyHistogram::Shard&
+LatencyHistogram::get_shard()
+{
+  auto& set = detail::t_histogram_shards[m_id % detail::kHistogramShardCacheSets];
+  if (set[0].id == m_id) {
+    return *set[0].shard;
+  }
+
+  // Move the entry to the front of the set, or evict the least recently used one for it
+  size_t way = 1;
+  while (way < set.size() - 1 && set[way].id != m_id) {
+    ++way;
+  }
+  auto entry = set[way];
+  if (entry.id != m_id) {
+    entry.shard = &find_shard();
+    entry.id = m_id;
+  }
+  std::copy_backward(set.begin(), set.begin() + way, set.begin() + way + 1);
+  set[0] = entry;
+  return *entry.shard;
+}
+
+inline void
+LatencyHistogram::record(uint64_t value_ns) // NOLINT(build/unsigned)
+{
+  auto& shard = get_shard();
+  detail::increment(shard.buckets[get_bucket_index(value_ns)], 1);
+  detail::increment(shard.sum, value_ns);
+  if (value_ns < shard.min.load(std::memory_order_relaxed)) {
+    shard.min.store(value_ns, std::memory_order_relaxed);
+  }
+  if (value_ns > shard.max.load(std::memory_order_relaxed)) {
+    shard.max.store(value_ns, std::memory_order_relaxed);
+  }
+}
+
+inline void
+LatencyHistogram::record(std::chrono::nanoseconds duration)
+{
+  record(static_cast<uint64_t>(std::max<std::chrono::nanoseconds::rep>(duration.count(), 0))); // NOLINT
+}
+
+inline std::chrono::nanoseconds
+LatencyTimer::stop()
+{
+  auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start);
+  if (m_histogram != nullptr) {
+    m_histogram->record(elapsed);
+    m_histogram = nullptr;
+  }
+  return elapsed;
+}
+
+} // namespace utilities
+} // namespace dunedaq
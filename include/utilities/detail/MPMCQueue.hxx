@@ -0,0 +1,161 @@
+#include <cstddef>
+#include <utility>
+
+namespace dunedaq {
+namespace utilities {
+
+template<typename T>
+MPMCQueue<T>::MPMCQueue(size_t capacity)
+  : m_capacity(detail::round_up_to_power_of_two(std::max<size_t>(capacity, 2)))
+  , m_cells(new Cell[m_capacity])
+{
+  for (size_t i = 0; i < m_capacity; ++i) {
+    m_cells[i].sequence.store(i, std::memory_order_relaxed);
+  }
+}
+
+template<typename T>
+MPMCQueue<T>::~MPMCQueue()
+{
+  auto end = m_enqueue_position.load();
+  for (auto position = m_dequeue_position.load(); position != end; ++position) {
+    auto& cell = get_cell(position);
+    if (cell.sequence.load() == position + 1) {
+      cell.slot.get()->~T();
+    }
+  }
+}
+
+template<typename T>
+size_t
+MPMCQueue<T>::claim(std::atomic<size_t>& position, size_t offset, size_t max_count, size_t& first)
+{
+  auto start = position.load(std::memory_order_relaxed);
+  while (true) {
+    size_t count = 0;
+    while (count < max_count &&
+           get_cell(start + count).sequence.load(std::memory_order_acquire) == start + count + offset) {
+      ++count;
+    }
+
+    if (count == 0) {
+      auto difference =
+        static_cast<std::ptrdiff_t>(get_cell(start).sequence.load(std::memory_order_acquire) - (start + offset));
+      if (difference < 0) {
+        // The cell is still in use from the previous lap (full), or not yet written in this one (empty)
+        return 0;
+      }
+      if (difference > 0) {
+        // Another thread has claimed the cell
+        start = position.load(std::memory_order_relaxed);
+      }
+      continue;
+    }
+
+    // Nobody else can change the state of the cells between start and
+    // the position, so the whole run is ours if the position hasn't moved
+    if (position.compare_exchange_weak(start, start + count, std::memory_order_relaxed)) {
+      first = start;
+      return count;
+    }
+  }
+}
+
+template<typename T>
+template<typename... Args>
+bool
+MPMCQueue<T>::try_emplace(Args&&... args)
+{
+  if constexpr (std::is_nothrow_constructible_v<T, Args&&...>) {
+    size_t position;
+    if (claim(m_enqueue_position, 0, 1, position) == 0) {
+      return false;
+    }
+    auto& cell = get_cell(position);
+    new (cell.slot.data) T(std::forward<Args>(args)...);
+    cell.sequence.store(position + 1, std::memory_order_release);
+    return true;
+  } else {
+    // Construct first, since a claimed cell must be filled
+    return try_emplace(T(std::forward<Args>(args)...));
+  }
+}
+
+template<typename T>
+bool
+MPMCQueue<T>::try_pop(T& value)
+{
+  size_t position;
+  if (claim(m_dequeue_position, 1, 1, position) == 0) {
+    return false;
+  }
+  auto& cell = get_cell(position);
+  value = std::move(*cell.slot.get());
+  cell.slot.get()->~T();
+  cell.sequence.store(position + m_capacity, std::memory_order_release);
+  return true;
+}
+
+template<typename T>
+template<typename InputIt>
+InputIt
+MPMCQueue<T>::try_push_batch(InputIt first, InputIt last)
+{
+  size_t max_count = 0;
+  for (auto it = first; it != last && max_count < m_capacity; ++it) {
+    ++max_count;
+  }
+  size_t position;
+  auto count = max_count == 0 ? 0 : claim(m_enqueue_position, 0, max_count, position);
+  for (size_t i = 0; i < count; ++i, ++first) {
+    auto& cell = get_cell(position + i);
+    new (cell.slot.data) T(std::move(*first));
+    cell.sequence.store(position + i + 1, std::memory_order_release);
+  }
+  return first;
+}
+
+template<typename T>
+template<typename OutputIt>
+size_t
+MPMCQueue<T>::try_pop_batch(OutputIt out, size_t max_count)
+{
+  size_t position;
+  auto count = max_count == 0 ? 0 : claim(m_dequeue_position, 1, std::min(max_count, m_capacity), position);
+  for (size_t i = 0; i < count; ++i) {
+    auto& cell = get_cell(position + i);
+    *out++ = std::move(*cell.slot.get());
+    cell.slot.get()->~T();
+    cell.sequence.store(position + i + m_capacity, std::memory_order_release);
+  }
+  return count;
+}
+
+template<typename T>
+template<typename U>
+bool
+MPMCQueue<T>::push_wait(U&& value, std::atomic<bool> const& running, std::chrono::milliseconds timeout)
+{
+  // try_emplace only moves from value when it succeeds
+  return detail::wait_for_queue([&]() { return try_emplace(std::forward<U>(value)); }, running, timeout);
+}
+
+template<typename T>
+bool
+MPMCQueue<T>::pop_wait(T& value, std::atomic<bool> const& running, std::chrono::milliseconds timeout)
+{
+  return detail::wait_for_queue([&]() { return try_pop(value); }, running, timeout);
+}
+
+template<typename T>
+size_t
+MPMCQueue<T>::size_approx() const
+{
+  // Loading the dequeue position first means the enqueue position cannot be behind it
+  auto dequeue = m_dequeue_position.load(std::memory_order_acquire);
+  auto enqueue = m_enqueue_position.load(std::memory_order_acquire);
+  return enqueue - dequeue;
+}
+
+} // namespace utilities
+} // namespace dunedaq
@@ -0,0 +1,69 @@
+#include <array>
+#include <atomic>
+
+namespace dunedaq {
+namespace utilities {
+
+namespace detail {
+
+constexpr size_t kMetricSlotsPerChunk = 512;
+constexpr size_t kMetricSlotChunks = 16;
+constexpr size_t kMaxMetrics = kMetricSlotsPerChunk * kMetricSlotChunks;
+
+/**
+ * @brief A thread's slots for all metrics, in chunks allocated as the
+ * thread first uses a metric in them. Chunks are cache-line aligned,
+ * so no two threads' slots share a cache line
+ */
+struct alignas(64) MetricSlotChunk
+{
+  std::array<std::atomic<uint64_t>, kMetricSlotsPerChunk> slots{}; // NOLINT(build/unsigned)
+};
+
+struct ThreadMetricSlots
+{
+  std::array<std::atomic<MetricSlotChunk*>, kMetricSlotChunks> chunks{};
+};
+
+inline thread_local ThreadMetricSlots* t_metric_slots = nullptr;
+
+/**
+ * @brief Add n to the calling thread's slot for metric index, when the
+ * slot doesn't exist yet
+ */
+void
+add_to_metric_slow(size_t index, uint64_t n); // NOLINT(build/unsigned)
+
+inline void
+add_to_metric(size_t index, uint64_t n) // NOLINT(build/unsigned)
+{
+  auto slots = t_metric_slots;
+  if (slots != nullptr) {
+    // Only this thread writes its chunk pointers and slots
+    auto chunk = slots->chunks[index / kMetricSlotsPerChunk].load(std::memory_order_relaxed);
+    if (chunk != nullptr) {
+      auto& slot = chunk->slots[index % kMetricSlotsPerChunk];
+      slot.store(slot.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+      return;
+    }
+  }
+  add_to_metric_slow(index, n);
+}
+
+} // namespace detail
+
+inline void
+Counter::increment(uint64_t n) // NOLINT(build/unsigned)
+{
+  detail::add_to_metric(m_index, n);
+}
+
+inline void
+Gauge::add(int64_t delta)
+{
+  // Slots wrap around, so negative changes add up correctly as two's complement
+  detail::add_to_metric(m_index, static_cast<uint64_t>(delta)); // NOLINT(build/unsigned)
+}
+
+} // namespace utilities
+} // namespace dunedaq
@@ -0,0 +1,195 @@
+#include "utilities/Issues.hpp"
+
+#include <thread>
+#include <utility>
+
+namespace dunedaq {
+namespace utilities {
+
+template<typename T>
+NamedRegistry<T>::Registration::Registration(Registration&& other) noexcept
+  : m_registry(std::exchange(other.m_registry, nullptr))
+  , m_name(other.m_name)
+  , m_token(other.m_token)
+{
+}
+
+template<typename T>
+typename NamedRegistry<T>::Registration&
+NamedRegistry<T>::Registration::operator=(Registration&& other) noexcept
+{
+  if (this != &other) {
+    reset();
+    m_registry = std::exchange(other.m_registry, nullptr);
+    m_name = other.m_name;
+    m_token = other.m_token;
+  }
+  return *this;
+}
+
+template<typename T>
+void
+NamedRegistry<T>::Registration::reset()
+{
+  if (m_registry != nullptr) {
+    m_registry->remove(m_name, m_token);
+    m_registry = nullptr;
+  }
+}
+
+template<typename T>
+NamedRegistry<T>::ReadGuard::ReadGuard(NamedRegistry const& registry)
+{
+  // The epoch is checked again once the lookup is counted: a lookup
+  // counted in an epoch which has already ended would not be waited for
+  while (true) {
+    auto epoch = registry.m_epoch.load();
+    m_count = &registry.m_readers[get_thread_stripe()].count[epoch & 1];
+    m_count->fetch_add(1);
+    if (registry.m_epoch.load() == epoch) {
+      break;
+    }
+    m_count->fetch_sub(1);
+  }
+  m_snapshot = registry.m_snapshot.load();
+}
+
+template<typename T>
+NamedRegistry<T>::ReadGuard::~ReadGuard()
+{
+  m_count->fetch_sub(1, std::memory_order_release);
+}
+
+template<typename T>
+size_t
+NamedRegistry<T>::get_thread_stripe()
+{
+  static std::atomic<size_t> s_next_stripe{ 0 };
+  thread_local size_t t_stripe = s_next_stripe.fetch_add(1, std::memory_order_relaxed) % kNumStripes;
+  return t_stripe;
+}
+
+template<typename T>
+NamedRegistry<T>::NamedRegistry()
+  : m_snapshot(new Snapshot())
+{
+}
+
+template<typename T>
+NamedRegistry<T>::~NamedRegistry()
+{
+  delete m_snapshot.load();
+}
+
+template<typename T>
+typename NamedRegistry<T>::Registration
+NamedRegistry<T>::add(object_ptr_t const& object)
+{
+  InternedName name(object->get_name());
+
+  std::lock_guard<std::mutex> lk(m_write_mutex);
+  auto& current = *m_snapshot.load();
+  auto it = current.by_name.find(name);
+  if (it != current.by_name.end() && !it->second.object.expired()) {
+    throw NameAlreadyRegistered(ERS_HERE, name.str());
+  }
+
+  // Objects destroyed before their Registration are dropped from the copy
+  auto snapshot = std::make_unique<Snapshot>();
+  for (auto& [entry_name, entry] : current.by_name) {
+    if (!entry.object.expired() && entry_name != name) {
+      snapshot->by_name.emplace(entry_name, entry);
+      snapshot->by_text.emplace(entry_name.view(), entry_name);
+    }
+  }
+  auto token = m_next_token++;
+  snapshot->by_name.emplace(name, Entry{ object, token });
+  snapshot->by_text.emplace(name.view(), name);
+  publish(std::move(snapshot));
+  return Registration(this, name, token);
+}
+
+template<typename T>
+void
+NamedRegistry<T>::remove(InternedName name, uint64_t token) // NOLINT(build/unsigned)
+{
+  std::lock_guard<std::mutex> lk(m_write_mutex);
+  auto& current = *m_snapshot.load();
+  auto it = current.by_name.find(name);
+  if (it == current.by_name.end() || it->second.token != token) {
+    // Already replaced by a later registration of the same name
+    return;
+  }
+
+  auto snapshot = std::make_unique<Snapshot>(current);
+  snapshot->by_name.erase(name);
+  snapshot->by_text.erase(name.view());
+  publish(std::move(snapshot));
+}
+
+template<typename T>
+void
+NamedRegistry<T>::publish(std::unique_ptr<Snapshot> snapshot)
+{
+  auto previous = m_snapshot.exchange(snapshot.release());
+
+  // Lookups which started before the epoch changed may be reading the
+  // previous snapshot; later ones read the new one
+  auto epoch = m_epoch.fetch_add(1);
+  for (auto& stripe : m_readers) {
+    while (stripe.count[epoch & 1].load() != 0) {
+      std::this_thread::yield();
+    }
+  }
+  delete previous;
+}
+
+template<typename T>
+typename NamedRegistry<T>::object_ptr_t
+NamedRegistry<T>::find(InternedName name) const
+{
+  ReadGuard guard(*this);
+  auto& by_name = guard.get().by_name;
+  auto it = by_name.find(name);
+  return it == by_name.end() ? nullptr : it->second.object.lock();
+}
+
+template<typename T>
+typename NamedRegistry<T>::object_ptr_t
+NamedRegistry<T>::find(std::string_view name) const
+{
+  ReadGuard guard(*this);
+  auto& snapshot = guard.get();
+  auto text = snapshot.by_text.find(name);
+  if (text == snapshot.by_text.end()) {
+    return nullptr;
+  }
+  return snapshot.by_name.at(text->second).object.lock();
+}
+
+template<typename T>
+std::vector<typename NamedRegistry<T>::object_ptr_t>
+NamedRegistry<T>::get_all() const
+{
+  std::vector<object_ptr_t> output;
+  ReadGuard guard(*this);
+  output.reserve(guard.get().by_name.size());
+  for (auto& [name, entry] : guard.get().by_name) {
+    auto object = entry.object.lock();
+    if (object) {
+      output.push_back(std::move(object));
+    }
+  }
+  return output;
+}
+
+template<typename T>
+size_t
+NamedRegistry<T>::size() const
+{
+  ReadGuard guard(*this);
+  return guard.get().by_name.size();
+}
+
+} // namespace utilities
+} // namespace dunedaq
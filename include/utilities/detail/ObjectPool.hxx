@@ -0,0 +1,65 @@
+#include <limits>
+#include <new>
+#include <utility>
+
+namespace dunedaq {
+namespace utilities {
+
+template<typename T>
+template<typename... Args>
+typename ObjectPool<T>::Ptr
+ObjectPool<T>::create(Args&&... args)
+{
+  return Ptr(construct(std::forward<Args>(args)...), Deleter(this));
+}
+
+template<typename T>
+template<typename... Args>
+T*
+ObjectPool<T>::construct(Args&&... args)
+{
+  auto block = m_pool.allocate();
+  try {
+    return new (block) T(std::forward<Args>(args)...);
+  } catch (...) {
+    m_pool.deallocate(block);
+    throw;
+  }
+}
+
+template<typename T>
+void
+ObjectPool<T>::destroy(T* object)
+{
+  if (object != nullptr) {
+    object->~T();
+    m_pool.deallocate(object);
+  }
+}
+
+template<typename T>
+T*
+PoolAllocator<T>::allocate(size_t n)
+{
+  if (is_pooled(n)) {
+    return static_cast<T*>(FixedSizePool::get_size_class_pool(n * sizeof(T)).allocate());
+  }
+  if (n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+    throw std::bad_array_new_length();
+  }
+  return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(alignof(T))));
+}
+
+template<typename T>
+void
+PoolAllocator<T>::deallocate(T* pointer, size_t n) noexcept
+{
+  if (is_pooled(n)) {
+    FixedSizePool::get_size_class_pool(n * sizeof(T)).deallocate(pointer);
+  } else {
+    ::operator delete(pointer, std::align_val_t(alignof(T)));
+  }
+}
+
+} // namespace utilities
+} // namespace dunedaq
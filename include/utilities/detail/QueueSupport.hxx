@@ -0,0 +1,111 @@
+/**
+ * @file QueueSupport.hxx Helpers shared by SPSCQueue and MPMCQueue
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef UTILITIES_INCLUDE_UTILITIES_DETAIL_QUEUESUPPORT_HXX_
+#define UTILITIES_INCLUDE_UTILITIES_DETAIL_QUEUESUPPORT_HXX_
+
+#include "utilities/detail/CpuRelax.hxx"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <new>
+#include <thread>
+
+namespace dunedaq {
+namespace utilities {
+namespace detail {
+
+constexpr size_t kCacheLineSize = 64;
+
+/**
+ * @brief Waits of increasing cost for a queue to become ready: spins
+ * first, since a handoff between running threads takes well under a
+ * microsecond, then yields, then sleeps for up to kMaxSleep
+ */
+class WaitBackoff
+{
+public:
+  static constexpr size_t kSpins = 128;
+  static constexpr size_t kYields = 16;
+  static constexpr std::chrono::microseconds kMaxSleep{ 100 };
+
+  void wait()
+  {
+    if (m_spins < kSpins) {
+      ++m_spins;
+      cpu_relax();
+    } else if (m_yields < kYields) {
+      ++m_yields;
+      std::this_thread::yield();
+    } else {
+      std::this_thread::sleep_for(m_sleep);
+      m_sleep = std::min(m_sleep * 2, kMaxSleep);
+    }
+  }
+
+private:
+  size_t m_spins{ 0 };
+  size_t m_yields{ 0 };
+  std::chrono::microseconds m_sleep{ 1 };
+};
+
+/**
+ * @brief Call attempt until it succeeds, running is cleared or timeout
+ * passes. Once running is cleared, attempt is called once more, so
+ * that elements queued before the stop are not lost
+ * @param timeout How long to wait; milliseconds::max() waits indefinitely
+ */
+template<typename Attempt>
+bool
+wait_for_queue(Attempt&& attempt, std::atomic<bool> const& running, std::chrono::milliseconds timeout)
+{
+  auto deadline = timeout == std::chrono::milliseconds::max() ? std::chrono::steady_clock::time_point::max()
+                                                              : std::chrono::steady_clock::now() + timeout;
+  WaitBackoff backoff;
+  while (true) {
+    if (attempt()) {
+      return true;
+    }
+    if (!running.load(std::memory_order_relaxed)) {
+      return attempt();
+    }
+    if (deadline != std::chrono::steady_clock::time_point::max() && std::chrono::steady_clock::now() >= deadline) {
+      return false;
+    }
+    backoff.wait();
+  }
+}
+
+inline size_t
+round_up_to_power_of_two(size_t n)
+{
+  size_t output = 1;
+  while (output < n) {
+    output <<= 1;
+  }
+  return output;
+}
+
+/**
+ * @brief Uninitialised storage for one element
+ */
+template<typename T>
+struct Slot
+{
+  alignas(T) unsigned char data[sizeof(T)];
+
+  T* get() { return std::launder(reinterpret_cast<T*>(data)); } // NOLINT
+};
+
+} // namespace detail
+} // namespace utilities
+} // namespace dunedaq
+
+#endif // UTILITIES_INCLUDE_UTILITIES_DETAIL_QUEUESUPPORT_HXX_
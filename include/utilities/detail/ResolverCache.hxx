@@ -0,0 +1,165 @@
+#include <algorithm>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace dunedaq {
+namespace utilities {
+
+namespace detail {
+constexpr size_t kMinResolverCacheSweepSize = 64;
+} // namespace detail
+
+template<typename Value>
+ResolverCache<Value>::ResolverCache(std::chrono::milliseconds max_age, size_t max_entries)
+  : m_max_age(max_age)
+  , m_max_entries(std::max<size_t>(max_entries, 1))
+  , m_sweep_size(detail::kMinResolverCacheSweepSize)
+{
+}
+
+template<typename Value>
+std::shared_ptr<const Value>
+ResolverCache<Value>::get(const std::string& name) const
+{
+  std::shared_lock<std::shared_mutex> lk(m_mutex);
+  auto it = m_entries.find(name);
+  if (it == m_entries.end() || it->second.expiry <= clock_t::now()) {
+    ++m_misses;
+    return nullptr;
+  }
+  ++m_hits;
+  return it->second.value;
+}
+
+template<typename Value>
+void
+ResolverCache<Value>::put(const std::string& name, const Value& value, std::chrono::milliseconds ttl)
+{
+  // Allocated before taking the lock, so that readers wait less
+  auto shared_value = std::make_shared<const Value>(value);
+  std::unique_lock<std::shared_mutex> lk(m_mutex);
+  auto lifetime = std::min(ttl, m_max_age);
+  if (lifetime.count() <= 0) {
+    m_entries.erase(name);
+    return;
+  }
+  auto now = clock_t::now();
+  auto it = m_entries.find(name);
+  if (it != m_entries.end()) {
+    it->second = Entry{ std::move(shared_value), now + lifetime };
+    return;
+  }
+  if (m_entries.size() >= std::min(m_sweep_size, m_max_entries)) {
+    make_room(now);
+  }
+  m_entries.emplace(name, Entry{ std::move(shared_value), now + lifetime });
+}
+
+template<typename Value>
+void
+ResolverCache<Value>::make_room(clock_t::time_point now)
+{
+  for (auto it = m_entries.begin(); it != m_entries.end();) {
+    if (it->second.expiry <= now) {
+      it = m_entries.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  if (m_entries.size() >= m_max_entries) {
+    // Full of live entries: drop the eighth which would expire soonest
+    std::vector<clock_t::time_point> expiries;
+    expiries.reserve(m_entries.size());
+    for (auto& [name, entry] : m_entries) {
+      expiries.push_back(entry.expiry);
+    }
+    auto n_drop = std::max<size_t>(m_entries.size() / 8, 1);
+    std::nth_element(expiries.begin(), expiries.begin() + (n_drop - 1), expiries.end());
+    auto cutoff = expiries[n_drop - 1];
+    for (auto it = m_entries.begin(); it != m_entries.end() && n_drop > 0;) {
+      if (it->second.expiry <= cutoff) {
+        it = m_entries.erase(it);
+        --n_drop;
+      } else {
+        ++it;
+      }
+    }
+  }
+
+  m_sweep_size = std::max(detail::kMinResolverCacheSweepSize, 2 * m_entries.size());
+}
+
+template<typename Value>
+void
+ResolverCache<Value>::invalidate()
+{
+  std::unique_lock<std::shared_mutex> lk(m_mutex);
+  m_entries.clear();
+}
+
+template<typename Value>
+void
+ResolverCache<Value>::invalidate(const std::string& name)
+{
+  std::unique_lock<std::shared_mutex> lk(m_mutex);
+  m_entries.erase(name);
+}
+
+template<typename Value>
+void
+ResolverCache<Value>::set_max_age(std::chrono::milliseconds max_age)
+{
+  std::unique_lock<std::shared_mutex> lk(m_mutex);
+  m_max_age = max_age;
+
+  // Don't let existing entries outlive the new maximum age
+  auto latest_expiry = clock_t::now() + m_max_age;
+  for (auto it = m_entries.begin(); it != m_entries.end();) {
+    if (m_max_age.count() <= 0) {
+      it = m_entries.erase(it);
+    } else {
+      it->second.expiry = std::min(it->second.expiry, latest_expiry);
+      ++it;
+    }
+  }
+}
+
+template<typename Value>
+void
+ResolverCache<Value>::set_max_entries(size_t max_entries)
+{
+  std::unique_lock<std::shared_mutex> lk(m_mutex);
+  m_max_entries = std::max<size_t>(max_entries, 1);
+  while (m_entries.size() > m_max_entries) {
+    make_room(clock_t::now());
+  }
+}
+
+template<typename Value>
+size_t
+ResolverCache<Value>::get_max_entries() const
+{
+  std::shared_lock<std::shared_mutex> lk(m_mutex);
+  return m_max_entries;
+}
+
+template<typename Value>
+std::chrono::milliseconds
+ResolverCache<Value>::get_max_age() const
+{
+  std::shared_lock<std::shared_mutex> lk(m_mutex);
+  return m_max_age;
+}
+
+template<typename Value>
+size_t
+ResolverCache<Value>::size() const
+{
+  std::shared_lock<std::shared_mutex> lk(m_mutex);
+  return m_entries.size();
+}
+
+} // namespace utilities
+} // namespace dunedaq
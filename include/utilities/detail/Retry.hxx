@@ -0,0 +1,50 @@
+#include <algorithm>
+#include <random>
+#include <thread>
+
+namespace dunedaq {
+namespace utilities {
+
+template<typename Attempt>
+auto
+retry_with_backoff(Attempt&& attempt, RetryPolicy const& policy, const std::atomic<bool>* running)
+  -> decltype(attempt())
+{
+  thread_local std::mt19937_64 s_rng{ std::random_device()() };
+
+  auto start = std::chrono::steady_clock::now();
+  auto deadline = policy.timeout.count() > 0 ? start + policy.timeout : std::chrono::steady_clock::time_point::max();
+  auto delay = std::chrono::duration<double, std::milli>(policy.initial_delay);
+  auto jitter = std::clamp(policy.jitter, 0.0, 1.0);
+
+  for (size_t n_attempts = 1;; ++n_attempts) {
+    auto result = attempt();
+    if (!result.empty()) {
+      return result;
+    }
+    if ((policy.max_attempts > 0 && n_attempts >= policy.max_attempts) ||
+        (running != nullptr && !running->load())) {
+      return result;
+    }
+
+    std::uniform_real_distribution<double> fraction(1.0 - jitter, 1.0);
+    auto wake = std::chrono::steady_clock::now() +
+                std::chrono::duration_cast<std::chrono::steady_clock::duration>(delay * fraction(s_rng));
+    if (wake >= deadline) {
+      return result;
+    }
+    // Sleep in short steps, so that a cleared running flag is noticed promptly
+    while (std::chrono::steady_clock::now() < wake) {
+      if (running != nullptr && !running->load()) {
+        return result;
+      }
+      std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(wake - std::chrono::steady_clock::now(),
+                                                                                std::chrono::milliseconds(10)));
+    }
+
+    delay = std::min(delay * policy.multiplier, std::chrono::duration<double, std::milli>(policy.max_delay));
+  }
+}
+
+} // namespace utilities
+} // namespace dunedaq
@@ -0,0 +1,119 @@
+#include <utility>
+
+namespace dunedaq {
+namespace utilities {
+
+template<typename T>
+SPSCQueue<T>::SPSCQueue(size_t capacity)
+  : m_capacity(detail::round_up_to_power_of_two(std::max<size_t>(capacity, 1)))
+  , m_slots(new detail::Slot<T>[m_capacity])
+{
+}
+
+template<typename T>
+SPSCQueue<T>::~SPSCQueue()
+{
+  auto tail = m_tail.load();
+  for (auto head = m_head.load(); head != tail; ++head) {
+    m_slots[head & (m_capacity - 1)].get()->~T();
+  }
+}
+
+template<typename T>
+template<typename... Args>
+bool
+SPSCQueue<T>::try_emplace(Args&&... args)
+{
+  auto tail = m_tail.load(std::memory_order_relaxed);
+  if (tail - m_cached_head == m_capacity) {
+    m_cached_head = m_head.load(std::memory_order_acquire);
+    if (tail - m_cached_head == m_capacity) {
+      return false;
+    }
+  }
+  new (m_slots[tail & (m_capacity - 1)].data) T(std::forward<Args>(args)...);
+  m_tail.store(tail + 1, std::memory_order_release);
+  return true;
+}
+
+template<typename T>
+bool
+SPSCQueue<T>::try_pop(T& value)
+{
+  auto head = m_head.load(std::memory_order_relaxed);
+  if (head == m_cached_tail) {
+    m_cached_tail = m_tail.load(std::memory_order_acquire);
+    if (head == m_cached_tail) {
+      return false;
+    }
+  }
+  auto element = m_slots[head & (m_capacity - 1)].get();
+  value = std::move(*element);
+  element->~T();
+  m_head.store(head + 1, std::memory_order_release);
+  return true;
+}
+
+template<typename T>
+template<typename InputIt>
+InputIt
+SPSCQueue<T>::try_push_batch(InputIt first, InputIt last)
+{
+  // One refresh of the consumer's position serves the whole batch
+  auto tail = m_tail.load(std::memory_order_relaxed);
+  m_cached_head = m_head.load(std::memory_order_acquire);
+
+  auto end = m_cached_head + m_capacity;
+  for (; first != last && tail != end; ++first, ++tail) {
+    new (m_slots[tail & (m_capacity - 1)].data) T(std::move(*first));
+  }
+  m_tail.store(tail, std::memory_order_release);
+  return first;
+}
+
+template<typename T>
+template<typename OutputIt>
+size_t
+SPSCQueue<T>::try_pop_batch(OutputIt out, size_t max_count)
+{
+  auto head = m_head.load(std::memory_order_relaxed);
+  m_cached_tail = m_tail.load(std::memory_order_acquire);
+
+  auto count = std::min(m_cached_tail - head, max_count);
+  for (size_t i = 0; i < count; ++i, ++head) {
+    auto element = m_slots[head & (m_capacity - 1)].get();
+    *out++ = std::move(*element);
+    element->~T();
+  }
+  m_head.store(head, std::memory_order_release);
+  return count;
+}
+
+template<typename T>
+template<typename U>
+bool
+SPSCQueue<T>::push_wait(U&& value, std::atomic<bool> const& running, std::chrono::milliseconds timeout)
+{
+  // try_emplace only moves from value when it succeeds
+  return detail::wait_for_queue([&]() { return try_emplace(std::forward<U>(value)); }, running, timeout);
+}
+
+template<typename T>
+bool
+SPSCQueue<T>::pop_wait(T& value, std::atomic<bool> const& running, std::chrono::milliseconds timeout)
+{
+  return detail::wait_for_queue([&]() { return try_pop(value); }, running, timeout);
+}
+
+template<typename T>
+size_t
+SPSCQueue<T>::size_approx() const
+{
+  // Loading the head first means the tail cannot be behind it
+  auto head = m_head.load(std::memory_order_acquire);
+  auto tail = m_tail.load(std::memory_order_acquire);
+  return tail - head;
+}
+
+} // namespace utilities
+} // namespace dunedaq
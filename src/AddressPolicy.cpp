@@ -0,0 +1,289 @@
+/**
+ *
+ * @file AddressPolicy.cpp Locality-aware ordering of resolved addresses
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/AddressPolicy.hpp"
+#include "utilities/Issues.hpp"
+#include "utilities/Resolver.hpp"
+
+#include "logging/Logging.hpp"
+
+#include <arpa/inet.h>
+#include <ifaddrs.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <tuple>
+#include <utility>
+
+namespace {
+
+/**
+ * @brief The policy is replaced as a whole when it changes, so lookups
+ * load it atomically without locking
+ */
+struct PolicyHolder
+{
+  std::shared_ptr<const dunedaq::utilities::AddressPolicy> policy{
+    std::make_shared<const dunedaq::utilities::AddressPolicy>()
+  };
+};
+
+PolicyHolder&
+get_policy_holder()
+{
+  static PolicyHolder s_holder;
+  return s_holder;
+}
+
+/**
+ * @brief Get the address bytes of a sockaddr (4 for IPv4, 16 for IPv6)
+ * @return The number of bytes, or 0 for other families
+ */
+size_t
+get_address_bytes(const sockaddr* addr, std::array<uint8_t, 16>& bytes) // NOLINT(build/unsigned)
+{
+  if (addr->sa_family == AF_INET) {
+    std::memcpy(bytes.data(), &reinterpret_cast<const sockaddr_in*>(addr)->sin_addr, 4); // NOLINT
+    return 4;
+  }
+  if (addr->sa_family == AF_INET6) {
+    std::memcpy(bytes.data(), &reinterpret_cast<const sockaddr_in6*>(addr)->sin6_addr, 16); // NOLINT
+    return 16;
+  }
+  return 0;
+}
+
+bool
+prefix_matches(std::array<uint8_t, 16> const& a, std::array<uint8_t, 16> const& b, unsigned length) // NOLINT
+{
+  auto whole = length / 8;
+  if (std::memcmp(a.data(), b.data(), whole) != 0) {
+    return false;
+  }
+  auto bits = length % 8;
+  if (bits == 0) {
+    return true;
+  }
+  uint8_t mask = static_cast<uint8_t>(0xff << (8 - bits)); // NOLINT(build/unsigned)
+  return (a[whole] & mask) == (b[whole] & mask);
+}
+
+} // namespace
+
+std::optional<dunedaq::utilities::AddressPolicy::Subnet>
+dunedaq::utilities::AddressPolicy::Subnet::parse(std::string_view cidr)
+{
+  auto slash = cidr.find('/');
+  auto address = cidr.substr(0, slash);
+
+  char text[INET6_ADDRSTRLEN] = {};
+  if (address.size() >= sizeof(text)) {
+    return std::nullopt;
+  }
+  std::memcpy(text, address.data(), address.size());
+
+  Subnet output;
+  unsigned max_length = 0;
+  if (inet_pton(AF_INET, text, output.address.data()) == 1) {
+    output.family = AF_INET;
+    max_length = 32;
+  } else if (inet_pton(AF_INET6, text, output.address.data()) == 1) {
+    output.family = AF_INET6;
+    max_length = 128;
+  } else {
+    return std::nullopt;
+  }
+
+  output.prefix_length = max_length;
+  if (slash != std::string_view::npos) {
+    auto length = cidr.substr(slash + 1);
+    if (length.empty() || length.size() > 3) {
+      return std::nullopt;
+    }
+    output.prefix_length = 0;
+    for (auto c : length) {
+      if (c < '0' || c > '9') {
+        return std::nullopt;
+      }
+      output.prefix_length = output.prefix_length * 10 + static_cast<unsigned>(c - '0');
+    }
+    if (output.prefix_length > max_length) {
+      return std::nullopt;
+    }
+  }
+  return output;
+}
+
+bool
+dunedaq::utilities::AddressPolicy::Subnet::contains(Endpoint const& endpoint) const
+{
+  if (!endpoint.is_valid() || endpoint.get_family() != family) {
+    return false;
+  }
+  std::array<uint8_t, 16> bytes{}; // NOLINT(build/unsigned)
+  get_address_bytes(endpoint.get_sockaddr(), bytes);
+  return prefix_matches(bytes, address, prefix_length);
+}
+
+dunedaq::utilities::AddressPolicy::AddressPolicy()
+{
+  struct ifaddrs* interfaces;
+  if (getifaddrs(&interfaces) != 0) {
+    TLOG_DEBUG(12) << "Cannot list the local interfaces: " << std::strerror(errno);
+    return;
+  }
+
+  for (auto ifa = interfaces; ifa != nullptr; ifa = ifa->ifa_next) {
+    if (ifa->ifa_addr == nullptr || ifa->ifa_netmask == nullptr) {
+      continue;
+    }
+    Interface interface;
+    interface.name = ifa->ifa_name;
+    interface.subnet.family = ifa->ifa_addr->sa_family;
+    std::array<uint8_t, 16> mask{}; // NOLINT(build/unsigned)
+    auto size = get_address_bytes(ifa->ifa_addr, interface.subnet.address);
+    if (size == 0 || get_address_bytes(ifa->ifa_netmask, mask) != size) {
+      continue;
+    }
+    // Netmasks are contiguous, so the prefix length is the number of bits set
+    for (size_t i = 0; i < size; ++i) {
+      interface.subnet.prefix_length += static_cast<unsigned>(__builtin_popcount(mask[i]));
+    }
+    TLOG_DEBUG(13) << "Local interface " << interface.name << " has a subnet of prefix length "
+                   << interface.subnet.prefix_length;
+    m_interfaces.push_back(std::move(interface));
+  }
+
+  freeifaddrs(interfaces);
+}
+
+std::shared_ptr<dunedaq::utilities::AddressPolicy>
+dunedaq::utilities::AddressPolicy::from_json(nlohmann::json const& json)
+{
+  if (!json.is_object()) {
+    throw InvalidResolverConfiguration(ERS_HERE, "the address policy is not a JSON object");
+  }
+
+  auto output = std::make_shared<AddressPolicy>();
+  try {
+    output->set_ipv6_enabled(json.value("ipv6", false));
+    output->set_prefer_local_subnets(json.value("prefer_local_subnets", true));
+
+    auto rules = json.value("rules", nlohmann::json::array());
+    if (!rules.is_array()) {
+      throw InvalidResolverConfiguration(ERS_HERE, "the address policy rules are not a list");
+    }
+    for (auto& rule : rules) {
+      if (!rule.is_object()) {
+        throw InvalidResolverConfiguration(ERS_HERE, "an address policy rule is not a JSON object");
+      }
+      auto rank = rule.value("rank", 0);
+      if (rule.contains("cidr") == rule.contains("interface")) {
+        throw InvalidResolverConfiguration(ERS_HERE, "an address policy rule needs one of cidr and interface");
+      }
+      if (rule.contains("cidr")) {
+        output->add_subnet_rule(rule.at("cidr").get<std::string>(), rank);
+      } else {
+        output->add_interface_rule(rule.at("interface").get<std::string>(), rank);
+      }
+    }
+  } catch (nlohmann::json::exception const& e) {
+    throw InvalidResolverConfiguration(ERS_HERE, std::string("address policy: ") + e.what());
+  }
+  return output;
+}
+
+void
+dunedaq::utilities::AddressPolicy::add_subnet_rule(std::string_view cidr, int rank)
+{
+  auto subnet = Subnet::parse(cidr);
+  if (!subnet) {
+    throw InvalidResolverConfiguration(ERS_HERE, std::string(cidr) + " is not a valid subnet");
+  }
+  m_rules.push_back(Rule{ *subnet, rank });
+}
+
+void
+dunedaq::utilities::AddressPolicy::add_interface_rule(std::string const& interface_name, int rank)
+{
+  for (auto& interface : m_interfaces) {
+    if (interface.name == interface_name) {
+      m_rules.push_back(Rule{ interface.subnet, rank });
+    }
+  }
+}
+
+int
+dunedaq::utilities::AddressPolicy::get_rank(Endpoint const& endpoint) const
+{
+  for (auto& rule : m_rules) {
+    if (rule.subnet.contains(endpoint)) {
+      return rule.rank;
+    }
+  }
+  return kDefaultRank;
+}
+
+bool
+dunedaq::utilities::AddressPolicy::is_local(Endpoint const& endpoint) const
+{
+  return std::any_of(m_interfaces.begin(), m_interfaces.end(), [&](Interface const& interface) {
+    return interface.subnet.contains(endpoint);
+  });
+}
+
+void
+dunedaq::utilities::AddressPolicy::apply(std::vector<Endpoint>& endpoints, bool filter_ipv6) const
+{
+  if (filter_ipv6 && !m_ipv6_enabled) {
+    endpoints.erase(std::remove_if(endpoints.begin(),
+                                   endpoints.end(),
+                                   [](Endpoint const& endpoint) { return endpoint.get_family() == AF_INET6; }),
+                    endpoints.end());
+  }
+  if (endpoints.size() < 2) {
+    return;
+  }
+
+  // Sort keys are computed once per address; the index keeps the sort stable
+  std::vector<std::tuple<int, bool, bool, size_t>> keys;
+  keys.reserve(endpoints.size());
+  for (size_t i = 0; i < endpoints.size(); ++i) {
+    keys.emplace_back(get_rank(endpoints[i]),
+                      m_prefer_local_subnets && !is_local(endpoints[i]),
+                      endpoints[i].get_family() == AF_INET6,
+                      i);
+  }
+  std::sort(keys.begin(), keys.end());
+
+  std::vector<Endpoint> ordered;
+  ordered.reserve(endpoints.size());
+  for (auto& key : keys) {
+    ordered.push_back(std::move(endpoints[std::get<3>(key)]));
+  }
+  endpoints = std::move(ordered);
+}
+
+void
+dunedaq::utilities::set_address_policy(std::shared_ptr<const AddressPolicy> policy)
+{
+  if (!policy) {
+    policy = std::make_shared<const AddressPolicy>();
+  }
+  std::atomic_store(&get_policy_holder().policy, std::move(policy));
+  invalidate_resolver_cache();
+}
+
+std::shared_ptr<const dunedaq::utilities::AddressPolicy>
+dunedaq::utilities::get_address_policy()
+{
+  return std::atomic_load(&get_policy_holder().policy);
+}
@@ -0,0 +1,75 @@
+/**
+ *
+ * @file Arena.cpp Monotonic arena for per-thread scratch memory, reset between batches
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/Arena.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+dunedaq::utilities::Arena::Arena(ArenaOptions options)
+  : m_options(options)
+{}
+
+void*
+dunedaq::utilities::Arena::allocate(size_t size, size_t alignment)
+{
+  // Find the first chunk from the current one with room, adding one if
+  // none has. Chunks passed over keep their unused space until the reset
+  for (; m_current_chunk < m_chunks.size(); ++m_current_chunk, m_offset = 0) {
+    auto& chunk = m_chunks[m_current_chunk];
+    auto base = reinterpret_cast<uintptr_t>(chunk.data()); // NOLINT
+    auto start = (base + m_offset + alignment - 1) & ~(alignment - 1);
+    if (start + size <= base + chunk.size()) {
+      m_stats.bytes_allocated += start + size - (base + m_offset);
+      m_stats.high_water_mark = std::max(m_stats.high_water_mark, m_stats.bytes_allocated);
+      ++m_stats.allocations;
+      m_offset = start + size - base;
+      return reinterpret_cast<void*>(start); // NOLINT
+    }
+  }
+
+  // Chunks are page-aligned, so alignments up to a page need no padding at the start
+  auto& chunk =
+    m_chunks.emplace_back(std::max(m_options.chunk_size, size + std::max(alignment, PageMemory::get_page_size())),
+                          m_options.use_hugepages);
+  ++m_stats.chunks;
+  m_stats.bytes_reserved += chunk.size();
+  m_stats.hugepages = (m_stats.chunks == 1 || m_stats.hugepages) && chunk.is_huge();
+  m_current_chunk = m_chunks.size() - 1;
+  m_offset = 0;
+  return allocate(size, alignment);
+}
+
+void
+dunedaq::utilities::Arena::reset()
+{
+  m_current_chunk = 0;
+  m_offset = 0;
+  m_stats.bytes_allocated = 0;
+  ++m_stats.resets;
+}
+
+void
+dunedaq::utilities::Arena::release()
+{
+  m_chunks.clear();
+  m_current_chunk = 0;
+  m_offset = 0;
+  m_stats.bytes_allocated = 0;
+  m_stats.chunks = 0;
+  m_stats.bytes_reserved = 0;
+  m_stats.hugepages = false;
+}
+
+dunedaq::utilities::Arena&
+dunedaq::utilities::Arena::this_thread()
+{
+  thread_local Arena t_arena;
+  return t_arena;
+}
@@ -0,0 +1,106 @@
+/**
+ * @file Clock.cpp
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/Clock.hpp"
+
+#include "utilities/detail/CpuRelax.hxx"
+
+#include <thread>
+
+namespace dunedaq {
+namespace utilities {
+
+Clock::time_point
+SystemClock::now() const
+{
+  return std::chrono::time_point_cast<duration>(std::chrono::system_clock::now());
+}
+
+void
+SystemClock::sleep_for(duration d)
+{
+  std::this_thread::sleep_for(d);
+}
+
+void
+SystemClock::pause()
+{
+  detail::cpu_relax();
+}
+
+void
+SystemClock::yield()
+{
+  std::this_thread::yield();
+}
+
+SimulatedClock::SimulatedClock(time_point start, bool advance_on_sleep)
+  : m_now_us(start.time_since_epoch().count())
+  , m_advance_on_sleep(advance_on_sleep)
+{}
+
+void
+SimulatedClock::sleep_for(duration d)
+{
+  if (m_advance_on_sleep) {
+    advance(d);
+    return;
+  }
+
+  auto target = now() + d;
+  std::unique_lock<std::mutex> lk(m_mutex);
+  m_cv.wait_for(lk, std::chrono::milliseconds(1), [&] { return now() >= target; });
+}
+
+void
+SimulatedClock::pause()
+{
+  if (m_advance_on_sleep) {
+    advance(duration(1));
+  }
+}
+
+void
+SimulatedClock::yield()
+{
+  if (m_advance_on_sleep) {
+    advance(duration(1));
+  } else {
+    std::this_thread::yield();
+  }
+}
+
+void
+SimulatedClock::advance(duration d)
+{
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_now_us += d.count();
+  }
+  m_cv.notify_all();
+}
+
+void
+SimulatedClock::set(time_point t)
+{
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_now_us = t.time_since_epoch().count();
+  }
+  m_cv.notify_all();
+}
+
+std::shared_ptr<Clock>
+get_system_clock()
+{
+  static std::shared_ptr<Clock> s_system_clock = std::make_shared<SystemClock>();
+  return s_system_clock;
+}
+
+} // namespace utilities
+} // namespace dunedaq
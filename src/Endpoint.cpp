@@ -0,0 +1,147 @@
+/**
+ *
+ * @file Endpoint.cpp Resolved network endpoint
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/Endpoint.hpp"
+#include "utilities/ZmqUri.hpp"
+
+#include <arpa/inet.h>
+
+#include <cstring>
+#include <functional>
+#include <utility>
+
+dunedaq::utilities::Endpoint::Endpoint(std::string scheme, const sockaddr* addr, socklen_t addr_len)
+  : m_scheme(std::move(scheme))
+{
+  if (addr != nullptr && (addr->sa_family == AF_INET || addr->sa_family == AF_INET6) &&
+      addr_len <= sizeof(m_addr)) {
+    std::memcpy(&m_addr, addr, addr_len);
+    m_addr_len = addr_len;
+  }
+  update_string();
+}
+
+std::optional<dunedaq::utilities::Endpoint>
+dunedaq::utilities::Endpoint::from_numeric(std::string scheme, std::string_view address, uint16_t port)
+{
+  // inet_pton needs a terminated string; numeric addresses are short
+  char text[INET6_ADDRSTRLEN] = {};
+  if (address.size() >= sizeof(text)) {
+    return std::nullopt;
+  }
+  std::memcpy(text, address.data(), address.size());
+
+  Endpoint output;
+  output.m_scheme = std::move(scheme);
+  auto* in4 = reinterpret_cast<sockaddr_in*>(&output.m_addr);  // NOLINT
+  auto* in6 = reinterpret_cast<sockaddr_in6*>(&output.m_addr); // NOLINT
+  if (inet_pton(AF_INET, text, &in4->sin_addr) == 1) {
+    in4->sin_family = AF_INET;
+    output.m_addr_len = sizeof(sockaddr_in);
+  } else if (inet_pton(AF_INET6, text, &in6->sin6_addr) == 1) {
+    in6->sin6_family = AF_INET6;
+    output.m_addr_len = sizeof(sockaddr_in6);
+  } else {
+    return std::nullopt;
+  }
+  output.set_port(port);
+  return output;
+}
+
+void
+dunedaq::utilities::Endpoint::set_scheme(std::string scheme)
+{
+  m_scheme = std::move(scheme);
+  update_string();
+}
+
+uint16_t
+dunedaq::utilities::Endpoint::get_port() const
+{
+  if (m_addr.ss_family == AF_INET) {
+    return ntohs(reinterpret_cast<const sockaddr_in*>(&m_addr)->sin_port); // NOLINT
+  }
+  if (m_addr.ss_family == AF_INET6) {
+    return ntohs(reinterpret_cast<const sockaddr_in6*>(&m_addr)->sin6_port); // NOLINT
+  }
+  return 0;
+}
+
+void
+dunedaq::utilities::Endpoint::set_port(uint16_t port)
+{
+  if (m_addr.ss_family == AF_INET) {
+    reinterpret_cast<sockaddr_in*>(&m_addr)->sin_port = htons(port); // NOLINT
+  } else if (m_addr.ss_family == AF_INET6) {
+    reinterpret_cast<sockaddr_in6*>(&m_addr)->sin6_port = htons(port); // NOLINT
+  }
+  update_string();
+}
+
+std::string
+dunedaq::utilities::Endpoint::get_address() const
+{
+  char text[INET6_ADDRSTRLEN] = {};
+  if (m_addr.ss_family == AF_INET) {
+    inet_ntop(AF_INET, &reinterpret_cast<const sockaddr_in*>(&m_addr)->sin_addr, text, sizeof(text)); // NOLINT
+  } else if (m_addr.ss_family == AF_INET6) {
+    inet_ntop(AF_INET6, &reinterpret_cast<const sockaddr_in6*>(&m_addr)->sin6_addr, text, sizeof(text)); // NOLINT
+  }
+  return text;
+}
+
+void
+dunedaq::utilities::Endpoint::update_string()
+{
+  if (!is_valid()) {
+    m_string.clear();
+    return;
+  }
+  auto address = get_address();
+  auto port = get_port();
+  auto port_text = port == 0 ? std::string() : std::to_string(port);
+  m_string = ZmqUriView{ m_scheme, "", address, port_text }.to_string();
+}
+
+bool
+dunedaq::utilities::Endpoint::operator==(const Endpoint& other) const
+{
+  if (m_scheme != other.m_scheme || m_addr.ss_family != other.m_addr.ss_family || get_port() != other.get_port()) {
+    return false;
+  }
+  if (m_addr.ss_family == AF_INET) {
+    return std::memcmp(&reinterpret_cast<const sockaddr_in*>(&m_addr)->sin_addr,       // NOLINT
+                       &reinterpret_cast<const sockaddr_in*>(&other.m_addr)->sin_addr, // NOLINT
+                       sizeof(in_addr)) == 0;
+  }
+  if (m_addr.ss_family == AF_INET6) {
+    auto* a = reinterpret_cast<const sockaddr_in6*>(&m_addr);       // NOLINT
+    auto* b = reinterpret_cast<const sockaddr_in6*>(&other.m_addr); // NOLINT
+    return std::memcmp(&a->sin6_addr, &b->sin6_addr, sizeof(in6_addr)) == 0 && a->sin6_scope_id == b->sin6_scope_id;
+  }
+  return m_addr_len == other.m_addr_len;
+}
+
+size_t
+dunedaq::utilities::Endpoint::hash() const
+{
+  // Hash what operator== compares, so that equal endpoints hash equally
+  std::string_view address;
+  if (m_addr.ss_family == AF_INET) {
+    auto* in4 = reinterpret_cast<const sockaddr_in*>(&m_addr);                                // NOLINT
+    address = std::string_view(reinterpret_cast<const char*>(&in4->sin_addr), sizeof(in_addr)); // NOLINT
+  } else if (m_addr.ss_family == AF_INET6) {
+    auto* in6 = reinterpret_cast<const sockaddr_in6*>(&m_addr);                                  // NOLINT
+    address = std::string_view(reinterpret_cast<const char*>(&in6->sin6_addr), sizeof(in6_addr)); // NOLINT
+  }
+  auto output = std::hash<std::string_view>()(address);
+  output ^= std::hash<std::string>()(m_scheme) + 0x9e3779b9 + (output << 6) + (output >> 2);
+  output ^= (static_cast<size_t>(m_addr.ss_family) << 16) | get_port();
+  return output;
+}
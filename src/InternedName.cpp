@@ -0,0 +1,104 @@
+/**
+ *
+ * @file InternedName.cpp Names held once in a process-wide pool, compared and hashed by id
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/InternedName.hpp"
+
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace {
+
+/**
+ * @brief The pool of interned strings. Most interning is of names which
+ * are already there, so lookups share the lock
+ */
+class NamePool
+{
+public:
+  using Entry = dunedaq::utilities::InternedName::Entry;
+
+  NamePool()
+    : m_empty(intern(""))
+  {}
+
+  const Entry* find(std::string_view name) const
+  {
+    std::shared_lock<std::shared_mutex> lk(m_mutex);
+    auto it = m_index.find(name);
+    return it == m_index.end() ? nullptr : it->second;
+  }
+
+  const Entry* intern(std::string_view name)
+  {
+    auto found = find(name);
+    if (found != nullptr) {
+      return found;
+    }
+
+    std::unique_lock<std::shared_mutex> lk(m_mutex);
+    // Another thread may have added it between the two locks
+    auto it = m_index.find(name);
+    if (it != m_index.end()) {
+      return it->second;
+    }
+    // Deque elements don't move when it grows, so the index can point into them
+    auto& entry = m_entries.emplace_back(Entry{ std::string(name), static_cast<uint32_t>(m_entries.size()) }); // NOLINT
+    m_index.emplace(entry.text, &entry);
+    return &entry;
+  }
+
+  const Entry* get_empty() const { return m_empty; }
+
+  size_t size() const
+  {
+    std::shared_lock<std::shared_mutex> lk(m_mutex);
+    return m_entries.size();
+  }
+
+private:
+  mutable std::shared_mutex m_mutex;
+  std::deque<Entry> m_entries;
+  std::unordered_map<std::string_view, const Entry*> m_index;
+  const Entry* m_empty;
+};
+
+NamePool&
+get_name_pool()
+{
+  static NamePool s_pool;
+  return s_pool;
+}
+
+} // namespace
+
+dunedaq::utilities::InternedName::InternedName()
+  : m_entry(get_name_pool().get_empty())
+{}
+
+dunedaq::utilities::InternedName::InternedName(std::string_view name)
+  : m_entry(get_name_pool().intern(name))
+{}
+
+std::optional<dunedaq::utilities::InternedName>
+dunedaq::utilities::InternedName::find(std::string_view name)
+{
+  auto entry = get_name_pool().find(name);
+  if (entry == nullptr) {
+    return std::nullopt;
+  }
+  return InternedName(entry);
+}
+
+size_t
+dunedaq::utilities::InternedName::get_pool_size()
+{
+  return get_name_pool().size();
+}
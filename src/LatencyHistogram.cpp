@@ -0,0 +1,123 @@
+/**
+ *
+ * @file LatencyHistogram.cpp Log-linear latency histogram, recorded into per-thread shards
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/LatencyHistogram.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+uint64_t // NOLINT(build/unsigned)
+get_next_histogram_id()
+{
+  static std::atomic<uint64_t> s_next_id{ 1 }; // NOLINT(build/unsigned)
+  return s_next_id++;
+}
+
+} // namespace
+
+uint64_t // NOLINT(build/unsigned)
+dunedaq::utilities::HistogramSnapshot::get_percentile(double fraction) const
+{
+  if (m_count == 0) {
+    return 0;
+  }
+  // The rank of the value, counting from 1
+  auto rank = static_cast<uint64_t>(std::ceil(std::clamp(fraction, 0., 1.) * m_count)); // NOLINT(build/unsigned)
+  rank = std::max<uint64_t>(rank, 1);                                                   // NOLINT(build/unsigned)
+
+  uint64_t seen = 0; // NOLINT(build/unsigned)
+  for (size_t i = 0; i < m_buckets.size(); ++i) {
+    seen += m_buckets[i];
+    // The last bucket also holds everything beyond the range
+    if (seen >= rank && i + 1 < m_buckets.size()) {
+      return std::min(LatencyHistogram::get_bucket_upper_bound(i), m_max);
+    }
+  }
+  return m_max;
+}
+
+nlohmann::json
+dunedaq::utilities::HistogramSnapshot::to_json(bool with_buckets) const
+{
+  nlohmann::json json{ { "count", get_count() },
+                       { "min", get_min() },
+                       { "mean", get_mean() },
+                       { "p50", get_percentile(0.5) },
+                       { "p90", get_percentile(0.9) },
+                       { "p99", get_percentile(0.99) },
+                       { "p999", get_percentile(0.999) },
+                       { "max", get_max() } };
+  if (with_buckets) {
+    auto buckets = nlohmann::json::array();
+    for (size_t i = 0; i < m_buckets.size(); ++i) {
+      if (m_buckets[i] != 0) {
+        buckets.push_back({ LatencyHistogram::get_bucket_upper_bound(i), m_buckets[i] });
+      }
+    }
+    json["buckets"] = std::move(buckets);
+  }
+  return json;
+}
+
+dunedaq::utilities::LatencyHistogram::LatencyHistogram()
+  : m_id(get_next_histogram_id())
+{}
+
+dunedaq::utilities::LatencyHistogram::~LatencyHistogram() = default;
+
+dunedaq::utilities::LatencyHistogram::Shard&
+dunedaq::utilities::LatencyHistogram::find_shard()
+{
+  auto thread_id = std::this_thread::get_id();
+  std::lock_guard<std::mutex> lk(m_mutex);
+  for (auto& [id, shard] : m_shards) {
+    if (id == thread_id) {
+      return *shard;
+    }
+  }
+  return *m_shards.emplace_back(thread_id, std::make_unique<Shard>()).second;
+}
+
+dunedaq::utilities::HistogramSnapshot
+dunedaq::utilities::LatencyHistogram::get_snapshot() const
+{
+  HistogramSnapshot snapshot;
+  snapshot.m_buckets.assign(kBuckets, 0);
+  std::lock_guard<std::mutex> lk(m_mutex);
+  for (auto& [id, shard] : m_shards) {
+    for (size_t i = 0; i < kBuckets; ++i) {
+      snapshot.m_buckets[i] += shard->buckets[i].load(std::memory_order_relaxed);
+    }
+    snapshot.m_sum += shard->sum.load(std::memory_order_relaxed);
+    snapshot.m_min = std::min(snapshot.m_min, shard->min.load(std::memory_order_relaxed));
+    snapshot.m_max = std::max(snapshot.m_max, shard->max.load(std::memory_order_relaxed));
+  }
+  // Counted from the buckets, so that percentiles are consistent with
+  // them even while other threads record
+  for (auto count : snapshot.m_buckets) {
+    snapshot.m_count += count;
+  }
+  return snapshot;
+}
+
+void
+dunedaq::utilities::LatencyHistogram::reset()
+{
+  std::lock_guard<std::mutex> lk(m_mutex);
+  for (auto& [id, shard] : m_shards) {
+    for (auto& bucket : shard->buckets) {
+      bucket.store(0, std::memory_order_relaxed);
+    }
+    shard->sum.store(0, std::memory_order_relaxed);
+    shard->min.store(std::numeric_limits<uint64_t>::max(), std::memory_order_relaxed); // NOLINT(build/unsigned)
+    shard->max.store(0, std::memory_order_relaxed);
+  }
+}
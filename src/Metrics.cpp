@@ -0,0 +1,278 @@
+/**
+ *
+ * @file Metrics.cpp Process-wide named counters, gauges and latency histograms
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/Metrics.hpp"
+
+#include "utilities/Issues.hpp"
+
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+using dunedaq::utilities::detail::kMaxMetrics;
+using dunedaq::utilities::detail::kMetricSlotChunks;
+using dunedaq::utilities::detail::kMetricSlotsPerChunk;
+using dunedaq::utilities::detail::MetricSlotChunk;
+using dunedaq::utilities::detail::ThreadMetricSlots;
+
+/**
+ * @brief The names of the metrics, and the slots of the threads which
+ * have used them
+ */
+class MetricsRegistry
+{
+public:
+  enum class Kind
+  {
+    kCounter,
+    kGauge
+  };
+
+  size_t get_index(std::string const& name, Kind kind)
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    auto& indices = kind == Kind::kCounter ? m_counter_indices : m_gauge_indices;
+    auto it = indices.find(name);
+    if (it != indices.end()) {
+      return it->second;
+    }
+    if (m_names.size() == kMaxMetrics) {
+      throw dunedaq::utilities::MetricsLimitReached(ERS_HERE, name, kMaxMetrics);
+    }
+    m_names.push_back(name);
+    m_kinds.push_back(kind);
+    indices.emplace(name, m_names.size() - 1);
+    return m_names.size() - 1;
+  }
+
+  const std::string& get_name(size_t index) const
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    return m_names[index];
+  }
+
+  dunedaq::utilities::LatencyHistogram& get_histogram(std::string const& name)
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    auto& histogram = m_histograms[name];
+    if (histogram == nullptr) {
+      histogram = std::make_unique<dunedaq::utilities::LatencyHistogram>();
+    }
+    return *histogram;
+  }
+
+  uint64_t get_value(size_t index) const // NOLINT(build/unsigned)
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    return get_value_locked(index);
+  }
+
+  void set_value(size_t index, uint64_t value) // NOLINT(build/unsigned)
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_retired[index].fetch_add(value - get_value_locked(index), std::memory_order_relaxed);
+  }
+
+  nlohmann::json get_snapshot() const
+  {
+    nlohmann::json counters = nlohmann::json::object();
+    nlohmann::json gauges = nlohmann::json::object();
+    nlohmann::json histograms = nlohmann::json::object();
+    std::lock_guard<std::mutex> lk(m_mutex);
+    for (size_t i = 0; i < m_names.size(); ++i) {
+      auto value = get_value_locked(i);
+      if (m_kinds[i] == Kind::kCounter) {
+        counters[m_names[i]] = value;
+      } else {
+        gauges[m_names[i]] = static_cast<int64_t>(value);
+      }
+    }
+    for (auto& [name, histogram] : m_histograms) {
+      histograms[name] = histogram->get_snapshot().to_json();
+    }
+    return { { "counters", std::move(counters) },
+             { "gauges", std::move(gauges) },
+             { "histograms", std::move(histograms) } };
+  }
+
+  void add_thread(ThreadMetricSlots* slots)
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_threads.push_back(slots);
+  }
+
+  /**
+   * @brief Keep the counts of an exiting thread
+   */
+  void retire_thread(ThreadMetricSlots* slots)
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    for (size_t c = 0; c < kMetricSlotChunks; ++c) {
+      auto chunk = slots->chunks[c].load(std::memory_order_acquire);
+      if (chunk == nullptr) {
+        continue;
+      }
+      for (size_t s = 0; s < kMetricSlotsPerChunk; ++s) {
+        m_retired[c * kMetricSlotsPerChunk + s].fetch_add(chunk->slots[s].load(std::memory_order_relaxed),
+                                                          std::memory_order_relaxed);
+      }
+    }
+    m_threads.erase(std::remove(m_threads.begin(), m_threads.end(), slots), m_threads.end());
+  }
+
+  void add_retired(size_t index, uint64_t n) // NOLINT(build/unsigned)
+  {
+    m_retired[index].fetch_add(n, std::memory_order_relaxed);
+  }
+
+private:
+  uint64_t get_value_locked(size_t index) const // NOLINT(build/unsigned)
+  {
+    auto value = m_retired[index].load(std::memory_order_relaxed);
+    for (auto slots : m_threads) {
+      auto chunk = slots->chunks[index / kMetricSlotsPerChunk].load(std::memory_order_acquire);
+      if (chunk != nullptr) {
+        value += chunk->slots[index % kMetricSlotsPerChunk].load(std::memory_order_relaxed);
+      }
+    }
+    return value;
+  }
+
+  mutable std::mutex m_mutex;
+  std::deque<std::string> m_names; // A deque, so that get_name() references stay valid
+  std::vector<Kind> m_kinds;
+  std::unordered_map<std::string, size_t> m_counter_indices;
+  std::unordered_map<std::string, size_t> m_gauge_indices;
+  std::map<std::string, std::unique_ptr<dunedaq::utilities::LatencyHistogram>> m_histograms;
+  std::vector<ThreadMetricSlots*> m_threads;
+  std::array<std::atomic<uint64_t>, kMaxMetrics> m_retired{}; // NOLINT(build/unsigned)
+};
+
+MetricsRegistry&
+get_registry()
+{
+  // Never deleted, so that threads exiting during static destruction can still retire their slots
+  static auto s_registry = new MetricsRegistry(); // NOLINT(cppcoreguidelines-owning-memory)
+  return *s_registry;
+}
+
+// Set once the calling thread's slots have been retired, after which
+// its changes go straight to the retired totals
+thread_local bool t_metric_slots_retired = false;
+
+/**
+ * @brief Owns the calling thread's slots, and retires them when the
+ * thread exits
+ */
+class ThreadMetricSlotsOwner
+{
+public:
+  ThreadMetricSlotsOwner()
+  {
+    get_registry().add_thread(&m_slots);
+    dunedaq::utilities::detail::t_metric_slots = &m_slots;
+  }
+
+  ~ThreadMetricSlotsOwner()
+  {
+    dunedaq::utilities::detail::t_metric_slots = nullptr;
+    t_metric_slots_retired = true;
+    get_registry().retire_thread(&m_slots);
+    for (auto& chunk : m_slots.chunks) {
+      delete chunk.load(); // NOLINT(cppcoreguidelines-owning-memory)
+    }
+  }
+
+  ThreadMetricSlotsOwner(const ThreadMetricSlotsOwner&) = delete; ///< Not copy-constructible
+  ThreadMetricSlotsOwner& operator=(const ThreadMetricSlotsOwner&) = delete; ///< Not copy-assignable
+
+  ThreadMetricSlots& get() { return m_slots; }
+
+private:
+  ThreadMetricSlots m_slots;
+};
+
+} // namespace
+
+void
+dunedaq::utilities::detail::add_to_metric_slow(size_t index, uint64_t n) // NOLINT(build/unsigned)
+{
+  if (t_metric_slots_retired) {
+    get_registry().add_retired(index, n);
+    return;
+  }
+
+  thread_local ThreadMetricSlotsOwner t_owner;
+  auto& chunk = t_owner.get().chunks[index / kMetricSlotsPerChunk];
+  if (chunk.load(std::memory_order_relaxed) == nullptr) {
+    // Released, so that readers see the zeroed slots
+    chunk.store(new MetricSlotChunk(), std::memory_order_release); // NOLINT(cppcoreguidelines-owning-memory)
+  }
+  add_to_metric(index, n);
+}
+
+uint64_t // NOLINT(build/unsigned)
+dunedaq::utilities::Counter::get_value() const
+{
+  return get_registry().get_value(m_index);
+}
+
+const std::string&
+dunedaq::utilities::Counter::get_name() const
+{
+  return get_registry().get_name(m_index);
+}
+
+void
+dunedaq::utilities::Gauge::set(int64_t value)
+{
+  get_registry().set_value(m_index, static_cast<uint64_t>(value)); // NOLINT(build/unsigned)
+}
+
+int64_t
+dunedaq::utilities::Gauge::get_value() const
+{
+  return static_cast<int64_t>(get_registry().get_value(m_index));
+}
+
+const std::string&
+dunedaq::utilities::Gauge::get_name() const
+{
+  return get_registry().get_name(m_index);
+}
+
+dunedaq::utilities::Counter
+dunedaq::utilities::get_counter(std::string const& name)
+{
+  return Counter(get_registry().get_index(name, MetricsRegistry::Kind::kCounter));
+}
+
+dunedaq::utilities::Gauge
+dunedaq::utilities::get_gauge(std::string const& name)
+{
+  return Gauge(get_registry().get_index(name, MetricsRegistry::Kind::kGauge));
+}
+
+dunedaq::utilities::LatencyHistogram&
+dunedaq::utilities::get_latency_histogram(std::string const& name)
+{
+  return get_registry().get_histogram(name);
+}
+
+nlohmann::json
+dunedaq::utilities::get_metrics_snapshot()
+{
+  return get_registry().get_snapshot();
+}
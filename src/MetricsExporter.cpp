@@ -0,0 +1,132 @@
+/**
+ *
+ * @file MetricsExporter.cpp Periodic export of the metrics snapshot from a WorkerThread
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/MetricsExporter.hpp"
+
+#include "utilities/Issues.hpp"
+#include "utilities/Metrics.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <utility>
+
+namespace {
+
+dunedaq::utilities::MetricsExporter::Sink
+make_file_sink(std::string const& path)
+{
+  // Fail early if the file can't be written at all
+  if (!std::ofstream(path, std::ios::app)) {
+    throw dunedaq::utilities::MetricsExportFailed(ERS_HERE, path, std::strerror(errno));
+  }
+  return [path](nlohmann::json const& report) {
+    std::ofstream file(path, std::ios::app);
+    file << report.dump() << '\n';
+    if (!file) {
+      ers::warning(dunedaq::utilities::MetricsExportFailed(ERS_HERE, path, std::strerror(errno)));
+    }
+  };
+}
+
+} // namespace
+
+dunedaq::utilities::MetricsExporter::MetricsExporter(std::chrono::milliseconds interval, Sink sink)
+  : m_interval(interval)
+  , m_sink(std::move(sink))
+  , m_previous_counters(nlohmann::json::object())
+  , m_previous_time(std::chrono::steady_clock::now())
+  , m_thread([this](std::atomic<bool>& running_flag) { do_work(running_flag); })
+{}
+
+dunedaq::utilities::MetricsExporter::MetricsExporter(std::chrono::milliseconds interval, std::string const& path)
+  : MetricsExporter(interval, make_file_sink(path))
+{}
+
+dunedaq::utilities::MetricsExporter::~MetricsExporter()
+{
+  if (is_running()) {
+    stop();
+  }
+}
+
+void
+dunedaq::utilities::MetricsExporter::start()
+{
+  {
+    std::lock_guard<std::mutex> lk(m_wait_mutex);
+    m_stop_requested = false;
+  }
+  m_thread.start_working_thread("metrics-export");
+}
+
+void
+dunedaq::utilities::MetricsExporter::stop()
+{
+  {
+    std::lock_guard<std::mutex> lk(m_wait_mutex);
+    m_stop_requested = true;
+  }
+  m_wait_cv.notify_all();
+  m_thread.stop_working_thread();
+  export_or_warn();
+}
+
+void
+dunedaq::utilities::MetricsExporter::export_now()
+{
+  // Reports made on different threads must not reach the sink at the same time, or out of order
+  std::lock_guard<std::mutex> lk(m_sink_mutex);
+  auto report = get_metrics_snapshot();
+  auto now = std::chrono::steady_clock::now();
+  auto elapsed = std::chrono::duration<double>(now - m_previous_time).count();
+
+  auto rates = nlohmann::json::object();
+  for (auto& [name, value] : report["counters"].items()) {
+    auto previous = m_previous_counters.value(name, uint64_t(0)); // NOLINT(build/unsigned)
+    auto current = value.get<uint64_t>();                         // NOLINT(build/unsigned)
+    rates[name] = elapsed > 0 ? (current - previous) / elapsed : 0.;
+  }
+  report["time_ms"] =
+    std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch())
+      .count();
+  report["interval_ms"] = std::chrono::duration_cast<std::chrono::milliseconds>(now - m_previous_time).count();
+  report["rates"] = std::move(rates);
+
+  m_previous_counters = report["counters"];
+  m_previous_time = now;
+  m_sink(report);
+}
+
+void
+dunedaq::utilities::MetricsExporter::export_or_warn()
+{
+  try {
+    export_now();
+  } catch (std::exception const& e) {
+    ers::warning(MetricsExportFailed(ERS_HERE, "the sink", e.what()));
+  }
+}
+
+void
+dunedaq::utilities::MetricsExporter::do_work(std::atomic<bool>& running_flag)
+{
+  auto next = std::chrono::steady_clock::now() + m_interval;
+  while (running_flag.load()) {
+    {
+      std::unique_lock<std::mutex> lk(m_wait_mutex);
+      if (m_wait_cv.wait_until(lk, next, [&]() { return m_stop_requested; })) {
+        return;
+      }
+    }
+    export_or_warn();
+    next += m_interval;
+  }
+}
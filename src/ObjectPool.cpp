@@ -0,0 +1,364 @@
+/**
+ *
+ * @file ObjectPool.cpp Thread-caching pools of fixed-size blocks
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/ObjectPool.hpp"
+
+#include "utilities/Issues.hpp"
+#include "utilities/PageMemory.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using dunedaq::utilities::FixedSizePool;
+
+struct ThreadCache;
+
+} // namespace
+
+/**
+ * @brief The state shared by the threads using a pool. Thread caches
+ * hold a reference to it, so it outlives the pool until they have
+ * returned their blocks
+ */
+struct dunedaq::utilities::FixedSizePool::Central
+{
+  Central(size_t block_size_, size_t stride_, PoolOptions options_)
+    : block_size(block_size_)
+    , stride(stride_)
+    , options(options_)
+  {}
+
+  void add_chunk();
+
+  /**
+   * @brief Move up to count free blocks to cache
+   */
+  void refill(ThreadCache& cache, size_t count);
+
+  /**
+   * @brief Move all but keep of the blocks of cache to the free list
+   */
+  void flush(ThreadCache& cache, size_t keep);
+
+  /**
+   * @brief Take back all of the blocks and counts of a thread's cache,
+   * when the thread or the pool goes away
+   */
+  void retire(ThreadCache& cache);
+
+  const size_t block_size;
+  const size_t stride;
+  const PoolOptions options;
+  std::atomic<bool> alive{ true };
+
+  mutable std::mutex mutex;
+  std::vector<void*> free_blocks;
+  std::vector<dunedaq::utilities::PageMemory> chunks;
+  std::vector<ThreadCache*> caches;
+  size_t blocks_reserved{ 0 };
+  size_t retired_allocations{ 0 };
+  size_t retired_deallocations{ 0 };
+  size_t central_transfers{ 0 };
+};
+
+namespace {
+
+/**
+ * @brief A thread's free blocks for one pool. The counters are only
+ * written by the owning thread, and atomic so that get_stats() can read
+ * them
+ */
+struct ThreadCache
+{
+  explicit ThreadCache(std::shared_ptr<FixedSizePool::Central> central_)
+    : central(std::move(central_))
+  {
+    blocks.reserve(central->options.thread_cache_size);
+  }
+
+  static void increment(std::atomic<size_t>& counter)
+  {
+    counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  }
+
+  std::shared_ptr<FixedSizePool::Central> central;
+  std::vector<void*> blocks;
+  std::atomic<size_t> allocations{ 0 };
+  std::atomic<size_t> deallocations{ 0 };
+};
+
+// Set once the calling thread's caches are destroyed, so that blocks freed
+// during thread exit (eg by other thread_local objects) bypass them
+thread_local bool t_caches_destroyed = false;
+
+/**
+ * @brief The caches of the calling thread, one per pool it has used
+ */
+class ThreadCaches
+{
+public:
+  ThreadCaches() = default;
+  ThreadCaches(const ThreadCaches&) = delete;            ///< ThreadCaches is not copy-constructible
+  ThreadCaches& operator=(const ThreadCaches&) = delete; ///< ThreadCaches is not copy-assignable
+
+  ~ThreadCaches()
+  {
+    for (auto& cache : m_caches) {
+      cache->central->retire(*cache);
+    }
+    t_caches_destroyed = true;
+  }
+
+  ThreadCache& get(const std::shared_ptr<FixedSizePool::Central>& central)
+  {
+    if (m_last != nullptr && m_last->central == central) {
+      return *m_last;
+    }
+    for (auto& cache : m_caches) {
+      if (cache->central == central) {
+        m_last = cache.get();
+        return *m_last;
+      }
+    }
+
+    // Drop the caches of pools which have been destroyed, before adding one
+    m_caches.erase(std::remove_if(m_caches.begin(),
+                                  m_caches.end(),
+                                  [](auto& cache) {
+                                    if (cache->central->alive.load()) {
+                                      return false;
+                                    }
+                                    cache->central->retire(*cache);
+                                    return true;
+                                  }),
+                   m_caches.end());
+
+    auto& cache = m_caches.emplace_back(std::make_unique<ThreadCache>(central));
+    {
+      std::lock_guard<std::mutex> lk(central->mutex);
+      central->caches.push_back(cache.get());
+    }
+    m_last = cache.get();
+    return *m_last;
+  }
+
+private:
+  std::vector<std::unique_ptr<ThreadCache>> m_caches;
+  ThreadCache* m_last{ nullptr };
+};
+
+thread_local ThreadCaches t_caches;
+
+constexpr size_t kSizeClassGranularity = 16;
+constexpr size_t kSmallSizeClassLimit = 256;
+
+/**
+ * @brief Sizes up to kSmallSizeClassLimit are rounded up to a multiple of
+ * kSizeClassGranularity, larger ones to a power of two
+ */
+size_t
+get_size_class(size_t size)
+{
+  if (size <= kSmallSizeClassLimit) {
+    return std::max<size_t>((size + kSizeClassGranularity - 1) / kSizeClassGranularity, 1) * kSizeClassGranularity;
+  }
+  size_t size_class = kSmallSizeClassLimit;
+  while (size_class < size) {
+    size_class <<= 1;
+  }
+  return size_class;
+}
+
+size_t
+get_size_class_index(size_t size_class)
+{
+  if (size_class <= kSmallSizeClassLimit) {
+    return size_class / kSizeClassGranularity - 1;
+  }
+  size_t index = kSmallSizeClassLimit / kSizeClassGranularity - 1;
+  for (auto s = kSmallSizeClassLimit; s < size_class; s <<= 1) {
+    ++index;
+  }
+  return index;
+}
+
+} // namespace
+
+void
+dunedaq::utilities::FixedSizePool::Central::add_chunk()
+{
+  auto& chunk = chunks.emplace_back(options.blocks_per_chunk * stride, options.use_hugepages);
+  auto n_blocks = chunk.size() / stride;
+  auto data = static_cast<char*>(chunk.data());
+  free_blocks.reserve(free_blocks.size() + n_blocks);
+  // Reversed, so that blocks are handed out in address order
+  for (auto i = n_blocks; i > 0; --i) {
+    free_blocks.push_back(data + (i - 1) * stride);
+  }
+  blocks_reserved += n_blocks;
+}
+
+void
+dunedaq::utilities::FixedSizePool::Central::refill(ThreadCache& cache, size_t count)
+{
+  std::lock_guard<std::mutex> lk(mutex);
+  if (free_blocks.empty()) {
+    add_chunk();
+  }
+  count = std::min(count, free_blocks.size());
+  cache.blocks.insert(cache.blocks.end(), free_blocks.end() - count, free_blocks.end());
+  free_blocks.resize(free_blocks.size() - count);
+  ++central_transfers;
+}
+
+void
+dunedaq::utilities::FixedSizePool::Central::flush(ThreadCache& cache, size_t keep)
+{
+  std::lock_guard<std::mutex> lk(mutex);
+  free_blocks.insert(free_blocks.end(), cache.blocks.begin() + keep, cache.blocks.end());
+  cache.blocks.resize(keep);
+  ++central_transfers;
+}
+
+void
+dunedaq::utilities::FixedSizePool::Central::retire(ThreadCache& cache)
+{
+  std::lock_guard<std::mutex> lk(mutex);
+  free_blocks.insert(free_blocks.end(), cache.blocks.begin(), cache.blocks.end());
+  cache.blocks.clear();
+  retired_allocations += cache.allocations.load();
+  retired_deallocations += cache.deallocations.load();
+  caches.erase(std::remove(caches.begin(), caches.end(), &cache), caches.end());
+}
+
+dunedaq::utilities::FixedSizePool::FixedSizePool(size_t block_size, size_t alignment, PoolOptions options)
+  : m_central(std::make_shared<Central>(block_size,
+                                        (block_size + alignment - 1) / std::max<size_t>(alignment, 1) * alignment,
+                                        options))
+{
+  if (alignment == 0 || (alignment & (alignment - 1)) != 0 || alignment > PageMemory::get_page_size()) {
+    throw InvalidPoolConfiguration(ERS_HERE, "alignment " + std::to_string(alignment) + " is not supported");
+  }
+  if (block_size == 0 || options.blocks_per_chunk == 0 || options.thread_cache_size == 0) {
+    throw InvalidPoolConfiguration(ERS_HERE, "block size, blocks per chunk and thread cache size must be non-zero");
+  }
+}
+
+dunedaq::utilities::FixedSizePool::~FixedSizePool()
+{
+  // Thread caches of this pool are dropped the next time their thread adds one, or when it exits
+  m_central->alive = false;
+}
+
+void*
+dunedaq::utilities::FixedSizePool::allocate()
+{
+  if (t_caches_destroyed) {
+    std::lock_guard<std::mutex> lk(m_central->mutex);
+    if (m_central->free_blocks.empty()) {
+      m_central->add_chunk();
+    }
+    auto block = m_central->free_blocks.back();
+    m_central->free_blocks.pop_back();
+    ++m_central->retired_allocations;
+    return block;
+  }
+
+  auto& cache = t_caches.get(m_central);
+  if (cache.blocks.empty()) {
+    m_central->refill(cache, std::max<size_t>(m_central->options.thread_cache_size / 2, 1));
+  }
+  auto block = cache.blocks.back();
+  cache.blocks.pop_back();
+  ThreadCache::increment(cache.allocations);
+  return block;
+}
+
+void
+dunedaq::utilities::FixedSizePool::deallocate(void* block)
+{
+  if (block == nullptr) {
+    return;
+  }
+  if (t_caches_destroyed) {
+    std::lock_guard<std::mutex> lk(m_central->mutex);
+    m_central->free_blocks.push_back(block);
+    ++m_central->retired_deallocations;
+    return;
+  }
+
+  auto& cache = t_caches.get(m_central);
+  if (cache.blocks.size() == m_central->options.thread_cache_size) {
+    m_central->flush(cache, m_central->options.thread_cache_size / 2);
+  }
+  cache.blocks.push_back(block);
+  ThreadCache::increment(cache.deallocations);
+}
+
+size_t
+dunedaq::utilities::FixedSizePool::get_block_size() const
+{
+  return m_central->block_size;
+}
+
+dunedaq::utilities::FixedSizePool::Stats
+dunedaq::utilities::FixedSizePool::get_stats() const
+{
+  std::lock_guard<std::mutex> lk(m_central->mutex);
+  Stats stats;
+  stats.block_size = m_central->block_size;
+  stats.chunks = m_central->chunks.size();
+  stats.blocks_reserved = m_central->blocks_reserved;
+  stats.allocations = m_central->retired_allocations;
+  stats.deallocations = m_central->retired_deallocations;
+  for (auto cache : m_central->caches) {
+    stats.allocations += cache->allocations.load(std::memory_order_relaxed);
+    stats.deallocations += cache->deallocations.load(std::memory_order_relaxed);
+  }
+  stats.blocks_in_use = stats.allocations >= stats.deallocations ? stats.allocations - stats.deallocations : 0;
+  stats.central_transfers = m_central->central_transfers;
+  stats.hugepages = !m_central->chunks.empty();
+  for (auto& chunk : m_central->chunks) {
+    stats.bytes_reserved += chunk.size();
+    stats.hugepages = stats.hugepages && chunk.is_huge();
+  }
+  return stats;
+}
+
+dunedaq::utilities::FixedSizePool&
+dunedaq::utilities::FixedSizePool::get_size_class_pool(size_t size)
+{
+  constexpr size_t kSizeClasses = kSmallSizeClassLimit / kSizeClassGranularity + 2; // Then 512 and 1024
+  static_assert(kMaxSizeClass == kSmallSizeClassLimit << 2);
+  static std::array<std::atomic<FixedSizePool*>, kSizeClasses> s_pools{};
+  static std::mutex s_mutex;
+
+  auto size_class = get_size_class(size);
+  auto& pool = s_pools[get_size_class_index(size_class)];
+  auto existing = pool.load(std::memory_order_acquire);
+  if (existing != nullptr) {
+    return *existing;
+  }
+
+  std::lock_guard<std::mutex> lk(s_mutex);
+  existing = pool.load(std::memory_order_relaxed);
+  if (existing == nullptr) {
+    // Never deleted, so that containers destroyed during static destruction can still free into it
+    existing = new FixedSizePool(size_class); // NOLINT(cppcoreguidelines-owning-memory)
+    pool.store(existing, std::memory_order_release);
+  }
+  return *existing;
+}
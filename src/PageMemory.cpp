@@ -0,0 +1,86 @@
+/**
+ *
+ * @file PageMemory.cpp Memory mapped directly from the kernel, optionally on huge pages
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/PageMemory.hpp"
+
+#include "logging/Logging.hpp"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <new>
+#include <utility>
+
+namespace {
+
+size_t
+round_up(size_t size, size_t multiple)
+{
+  return (size + multiple - 1) / multiple * multiple;
+}
+
+void*
+map_pages(size_t size, int extra_flags)
+{
+  auto data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | extra_flags, -1, 0);
+  return data == MAP_FAILED ? nullptr : data;
+}
+
+} // namespace
+
+dunedaq::utilities::PageMemory::PageMemory(size_t size, bool use_hugepages)
+  : m_data(nullptr)
+  , m_size(round_up(std::max<size_t>(size, 1), use_hugepages ? kHugePageSize : get_page_size()))
+  , m_huge(false)
+{
+  if (use_hugepages) {
+    m_data = map_pages(m_size, MAP_HUGETLB);
+    m_huge = m_data != nullptr;
+  }
+  if (m_data == nullptr) {
+    m_data = map_pages(m_size, 0);
+    if (m_data == nullptr) {
+      throw std::bad_alloc();
+    }
+    if (use_hugepages) {
+      TLOG_DEBUG(10) << "No reserved huge pages for " << m_size << " bytes, using transparent huge pages";
+      madvise(m_data, m_size, MADV_HUGEPAGE);
+    }
+  }
+}
+
+dunedaq::utilities::PageMemory::~PageMemory()
+{
+  if (m_data != nullptr) {
+    munmap(m_data, m_size);
+  }
+}
+
+dunedaq::utilities::PageMemory::PageMemory(PageMemory&& other) noexcept
+  : m_data(std::exchange(other.m_data, nullptr))
+  , m_size(std::exchange(other.m_size, 0))
+  , m_huge(std::exchange(other.m_huge, false))
+{}
+
+dunedaq::utilities::PageMemory&
+dunedaq::utilities::PageMemory::operator=(PageMemory&& other) noexcept
+{
+  std::swap(m_data, other.m_data);
+  std::swap(m_size, other.m_size);
+  std::swap(m_huge, other.m_huge);
+  return *this;
+}
+
+size_t
+dunedaq::utilities::PageMemory::get_page_size()
+{
+  static const size_t s_page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  return s_page_size;
+}
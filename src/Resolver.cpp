@@ -8,72 +8,1192 @@
  */
 
 #include "utilities/Resolver.hpp"
+#include "utilities/AddressPolicy.hpp"
+#include "utilities/LatencyHistogram.hpp"
+#include "utilities/Metrics.hpp"
 
-std::vector<std::string>
-dunedaq::utilities::get_ips_from_hostname(std::string hostname)
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+namespace {
+
+std::atomic<int64_t> s_negative_ttl_ms{ dunedaq::utilities::kDefaultResolverNegativeTtl.count() };
+
+struct ResolverMetrics
 {
-  std::vector<std::string> output;
+  dunedaq::utilities::Counter host_lookups{ dunedaq::utilities::get_counter("resolver.host_lookups") };
+  dunedaq::utilities::Counter host_cache_hits{ dunedaq::utilities::get_counter("resolver.host_cache_hits") };
+  dunedaq::utilities::Counter host_failures{ dunedaq::utilities::get_counter("resolver.host_failures") };
+  dunedaq::utilities::Counter service_lookups{ dunedaq::utilities::get_counter("resolver.service_lookups") };
+  dunedaq::utilities::Counter service_cache_hits{ dunedaq::utilities::get_counter("resolver.service_cache_hits") };
+  dunedaq::utilities::Counter service_failures{ dunedaq::utilities::get_counter("resolver.service_failures") };
+  dunedaq::utilities::Counter dns_queries{ dunedaq::utilities::get_counter("resolver.dns_queries") };
+  dunedaq::utilities::Counter dns_tcp_retries{ dunedaq::utilities::get_counter("resolver.dns_tcp_retries") };
+  dunedaq::utilities::LatencyHistogram& dns_query_time{ dunedaq::utilities::get_latency_histogram(
+    "resolver.dns_query_time") };
+  dunedaq::utilities::LatencyHistogram& getaddrinfo_time{ dunedaq::utilities::get_latency_histogram(
+    "resolver.getaddrinfo_time") };
+};
+
+ResolverMetrics&
+get_metrics()
+{
+  static ResolverMetrics s_metrics;
+  return s_metrics;
+}
+
+std::chrono::milliseconds
+get_negative_ttl()
+{
+  return std::chrono::milliseconds(s_negative_ttl_ms.load(std::memory_order_relaxed));
+}
+
+/**
+ * @brief FailureReporter collapses repeated failures for the same name:
+ * the first failure in each interval is reported, and the rest are
+ * only counted. The count is reported when the interval has passed,
+ * with the next report for the name or by flush_expired()
+ */
+class FailureReporter
+{
+public:
+  /**
+   * @brief Call report (which raises the ERS issue), unless name has
+   * already been reported within the interval
+   */
+  void report(std::string const& name, std::function<void()> const& report)
+  {
+    flush_expired();
+
+    auto now = std::chrono::steady_clock::now();
+    auto interval = std::chrono::milliseconds(m_interval_ms.load(std::memory_order_relaxed));
+    uint64_t suppressed = 0; // NOLINT(build/unsigned)
+    {
+      std::lock_guard<std::mutex> lk(m_mutex);
+      auto it = m_entries.find(name);
+      if (it != m_entries.end() && now - it->second.reported < interval) {
+        ++it->second.suppressed;
+        return;
+      }
+      if (it != m_entries.end()) {
+        // Expired since flush_expired() looked
+        suppressed = it->second.suppressed;
+      }
+      m_entries[name] = Entry{ now, 0 };
+      auto expiry = (now + interval).time_since_epoch().count();
+      if (expiry < m_next_expiry_ns.load(std::memory_order_relaxed)) {
+        m_next_expiry_ns.store(expiry, std::memory_order_relaxed);
+      }
+    }
+
+    if (suppressed > 0) {
+      ers::warning(dunedaq::utilities::ResolveFailuresSuppressed(ERS_HERE, name, suppressed, interval.count()));
+    }
+    report();
+  }
+
+  /**
+   * @brief Report the counts of the names whose interval has passed,
+   * and forget those names. Cheap when no interval has passed, so it
+   * is called on every lookup
+   */
+  void flush_expired()
+  {
+    auto now = std::chrono::steady_clock::now();
+    if (now.time_since_epoch().count() < m_next_expiry_ns.load(std::memory_order_relaxed)) {
+      return;
+    }
+
+    auto interval = std::chrono::milliseconds(m_interval_ms.load(std::memory_order_relaxed));
+    std::vector<std::pair<std::string, uint64_t>> expired; // NOLINT(build/unsigned)
+    {
+      std::lock_guard<std::mutex> lk(m_mutex);
+      auto next_expiry = std::numeric_limits<int64_t>::max();
+      for (auto it = m_entries.begin(); it != m_entries.end();) {
+        auto expiry = (it->second.reported + interval).time_since_epoch().count();
+        if (expiry > now.time_since_epoch().count()) {
+          next_expiry = std::min(next_expiry, expiry);
+          ++it;
+          continue;
+        }
+        if (it->second.suppressed > 0) {
+          expired.emplace_back(it->first, it->second.suppressed);
+        }
+        it = m_entries.erase(it);
+      }
+      m_next_expiry_ns.store(next_expiry, std::memory_order_relaxed);
+    }
+
+    for (auto& [name, suppressed] : expired) {
+      ers::warning(dunedaq::utilities::ResolveFailuresSuppressed(ERS_HERE, name, suppressed, interval.count()));
+    }
+  }
+
+  void set_interval(std::chrono::milliseconds interval)
+  {
+    m_interval_ms = interval.count();
+    // Entries may now expire sooner
+    m_next_expiry_ns = 0;
+  }
+
+private:
+  struct Entry
+  {
+    std::chrono::steady_clock::time_point reported;
+    uint64_t suppressed; // NOLINT(build/unsigned)
+  };
+
+  std::mutex m_mutex;
+  std::unordered_map<std::string, Entry> m_entries;
+  std::atomic<int64_t> m_interval_ms{ dunedaq::utilities::kDefaultResolverErrorReportInterval.count() };
+  std::atomic<int64_t> m_next_expiry_ns{ std::numeric_limits<int64_t>::max() }; // Earliest end of an entry's interval
+};
+
+FailureReporter&
+get_failure_reporter()
+{
+  static FailureReporter s_reporter;
+  return s_reporter;
+}
+
+void
+report_name_not_found(std::string const& hostname, std::string const& error)
+{
+  get_failure_reporter().report(
+    hostname, [&]() { ers::error(dunedaq::utilities::NameNotFound(ERS_HERE, hostname, error)); });
+}
+
+void
+report_service_not_found(std::string const& service_name)
+{
+  get_failure_reporter().report(
+    service_name, [&]() { ers::error(dunedaq::utilities::ServiceNotFound(ERS_HERE, service_name)); });
+}
+
+/**
+ * @brief Nameservers set with set_resolver_nameservers. Threads
+ * reinitialise their resolver state when the generation changes
+ */
+struct NameserverConfig
+{
+  std::mutex mutex;
+  std::vector<dunedaq::utilities::Endpoint> nameservers;
+  std::chrono::seconds timeout{ 0 };
+  int attempts{ 0 };
+  std::atomic<uint64_t> generation{ 0 }; // NOLINT(build/unsigned)
+  std::atomic<bool> overridden{ false };
+};
+
+NameserverConfig&
+get_nameserver_config()
+{
+  static NameserverConfig s_config;
+  return s_config;
+}
+
+/**
+ * @brief Resolver state owned by a single thread. res_search works on
+ * the process-wide _res, so each thread doing DNS queries gets its own
+ * state for res_nsearch instead
+ */
+class ThreadResolverState
+{
+public:
+  ThreadResolverState() { std::memset(&m_state, 0, sizeof(m_state)); }
+  ~ThreadResolverState()
+  {
+    if (m_initialized) {
+      res_nclose(&m_state);
+    }
+  }
+
+  ThreadResolverState(const ThreadResolverState&) = delete;
+  ThreadResolverState& operator=(const ThreadResolverState&) = delete;
+
+  res_state get()
+  {
+    auto generation = get_nameserver_config().generation.load(std::memory_order_acquire);
+    // Initialise on first use, after a failure (in case it was transient) and when the nameservers change
+    if (!m_initialized || generation != m_generation) {
+      initialize(generation);
+    }
+    return m_initialized ? &m_state : nullptr;
+  }
+
+private:
+  void initialize(uint64_t generation) // NOLINT(build/unsigned)
+  {
+    if (m_initialized) {
+      res_nclose(&m_state);
+    }
+    std::memset(&m_state, 0, sizeof(m_state));
+    m_initialized = res_ninit(&m_state) == 0;
+    m_generation = generation;
+    if (!m_initialized) {
+      return;
+    }
+
+    auto& config = get_nameserver_config();
+    std::lock_guard<std::mutex> lk(config.mutex);
+    if (!config.nameservers.empty()) {
+      m_state.nscount = 0;
+      for (auto& nameserver : config.nameservers) {
+        std::memcpy(&m_state.nsaddr_list[m_state.nscount++], nameserver.get_sockaddr(), sizeof(sockaddr_in));
+      }
+      // Don't let the resolver reload resolv.conf over these
+      m_state.options |= RES_NORELOAD;
+    }
+    if (config.timeout.count() > 0) {
+      m_state.retrans = static_cast<int>(config.timeout.count());
+    }
+    if (config.attempts > 0) {
+      m_state.retry = config.attempts;
+    }
+  }
+
+  struct __res_state m_state;
+  bool m_initialized{ false };
+  uint64_t m_generation{ 0 }; // NOLINT(build/unsigned)
+};
+
+res_state
+get_thread_resolver_state()
+{
+  thread_local ThreadResolverState s_state;
+  return s_state.get();
+}
+
+/**
+ * @brief How a lookup ended. Refreshes, which bypass the caches, keep
+ * the previous answer only when the lookup failed
+ */
+enum class LookupOutcome
+{
+  kFound,
+  kNotFound, ///< The name, or the records asked for, do not exist
+  kFailed    ///< No answer, eg after a timeout
+};
+
+/**
+ * @brief Whether a query which failed with the given h_errno found that
+ * the name or its records do not exist, rather than getting no answer
+ */
+bool
+is_definite_miss(int error)
+{
+  return error == HOST_NOT_FOUND || error == NO_DATA;
+}
+
+/**
+ * @brief Query DNS for the records of the given type for name into buffer.
+ *
+ * If the answer does not fit in the buffer, or the server truncated
+ * it to fit in a UDP datagram, the query is repeated over TCP with a
+ * buffer of the maximum DNS message size. An answer which is still
+ * truncated is used as it is, with a warning naming the query type.
+ *
+ * @return The length of the answer, or -1 if the query failed
+ */
+int
+query_dns(res_state state, std::string const& name, ns_type type, std::vector<unsigned char>& buffer)
+{
+  buffer.resize(4096);
+  auto saved_options = state->options;
+  int response = -1;
+
+  while (true) {
+    get_metrics().dns_queries.increment();
+    response = dunedaq::utilities::time_call(get_metrics().dns_query_time, [&]() {
+      return res_nsearch(state, name.c_str(), C_IN, type, buffer.data(), buffer.size());
+    });
+    if (response < 0) {
+      break;
+    }
+
+    ns_msg msg;
+    bool truncated = static_cast<size_t>(response) > buffer.size() ||
+                     (ns_initparse(buffer.data(), response, &msg) == 0 && ns_msg_getflag(msg, ns_f_tc));
+    if (!truncated) {
+      break;
+    }
+    if (buffer.size() < NS_MAXMSG || !(state->options & RES_USEVC)) {
+      TLOG_DEBUG(14) << "Answer for " << name << " was truncated, retrying over TCP";
+      get_metrics().dns_tcp_retries.increment();
+      buffer.resize(NS_MAXMSG);
+      state->options |= RES_USEVC;
+      continue;
+    }
+
+    if (type == ns_t_srv) {
+      ers::warning(dunedaq::utilities::TruncatedServiceAnswer(ERS_HERE, name));
+    } else {
+      ers::warning(dunedaq::utilities::TruncatedDnsAnswer(ERS_HERE, name, type == ns_t_aaaa ? "AAAA" : "A"));
+    }
+    response = std::min(response, static_cast<int>(buffer.size()));
+    break;
+  }
+
+  state->options = saved_options;
+  return response;
+}
+
+/**
+ * @brief Addresses of a host found in a DNS answer
+ */
+struct HostAddresses
+{
+  std::vector<dunedaq::utilities::Endpoint> endpoints;
+  uint32_t ttl{ std::numeric_limits<uint32_t>::max() }; // NOLINT(build/unsigned)
+};
+
+/**
+ * @brief Collect the A and AAAA records of a section of msg, by owner name
+ */
+void
+collect_addresses(ns_msg& msg, ns_sect section, std::unordered_map<std::string, HostAddresses>& output)
+{
+  for (int x = 0; x < ns_msg_count(msg, section); x++) {
+    ns_rr rr;
+    if (ns_parserr(&msg, section, x, &rr) < 0) {
+      continue;
+    }
+    dunedaq::utilities::Endpoint endpoint;
+    if (ns_rr_type(rr) == ns_t_a && ns_rr_rdlen(rr) == sizeof(in_addr)) {
+      sockaddr_in addr{};
+      addr.sin_family = AF_INET;
+      std::memcpy(&addr.sin_addr, ns_rr_rdata(rr), sizeof(in_addr));
+      endpoint = dunedaq::utilities::Endpoint("", reinterpret_cast<sockaddr*>(&addr), sizeof(addr)); // NOLINT
+    } else if (ns_rr_type(rr) == ns_t_aaaa && ns_rr_rdlen(rr) == sizeof(in6_addr)) {
+      sockaddr_in6 addr{};
+      addr.sin6_family = AF_INET6;
+      std::memcpy(&addr.sin6_addr, ns_rr_rdata(rr), sizeof(in6_addr));
+      endpoint = dunedaq::utilities::Endpoint("", reinterpret_cast<sockaddr*>(&addr), sizeof(addr)); // NOLINT
+    } else {
+      continue;
+    }
+
+    auto& host = output[ns_rr_name(rr)];
+    if (std::find(host.endpoints.begin(), host.endpoints.end(), endpoint) == host.endpoints.end()) {
+      host.endpoints.push_back(std::move(endpoint));
+    }
+    host.ttl = std::min(host.ttl, static_cast<uint32_t>(ns_rr_ttl(rr))); // NOLINT(build/unsigned)
+  }
+}
+
+/**
+ * @brief Query DNS for the SRV records of service_name, appending them
+ * (without their target addresses) to output. Addresses of the
+ * targets which the server sent along in the additional section are
+ * put in additional
+ * @return kNotFound if the service has no SRV records (which has not
+ * been reported), or kFailed if the query failed (which has been)
+ */
+LookupOutcome
+query_service_records(std::string const& service_name,
+                      std::vector<dunedaq::utilities::ServiceRecord>& output,
+                      std::unordered_map<std::string, HostAddresses>& additional)
+{
+  auto resolver_state = get_thread_resolver_state();
+  if (resolver_state == nullptr) {
+    report_service_not_found(service_name);
+    return LookupOutcome::kFailed;
+  }
+
+  std::vector<unsigned char> query_buffer;
+  auto response = query_dns(resolver_state, service_name, ns_t_srv, query_buffer);
+  if (response < 0 && is_definite_miss(h_errno)) {
+    return LookupOutcome::kNotFound;
+  }
+  if (response < 0) {
+    report_service_not_found(service_name);
+    return LookupOutcome::kFailed;
+  }
+
+  ns_msg nsMsg;
+  if (ns_initparse(query_buffer.data(), response, &nsMsg) < 0) {
+    report_service_not_found(service_name);
+    return LookupOutcome::kFailed;
+  }
+
+  for (int x = 0; x < ns_msg_count(nsMsg, ns_s_an); x++) {
+    ns_rr rr;
+    if (ns_parserr(&nsMsg, ns_s_an, x, &rr) < 0) {
+      ers::warning(dunedaq::utilities::MalformedServiceRecord(ERS_HERE, service_name, x));
+      continue;
+    }
+    // The answer may also hold eg CNAMEs; SRV RDATA is priority, weight, port, target
+    if (ns_rr_type(rr) != ns_t_srv) {
+      continue;
+    }
+    char name[NS_MAXDNAME];
+    if (ns_rr_rdlen(rr) < 7 ||
+        dn_expand(ns_msg_base(nsMsg), ns_msg_end(nsMsg), ns_rr_rdata(rr) + 6, name, sizeof(name)) < 0) {
+      ers::warning(dunedaq::utilities::MalformedServiceRecord(ERS_HERE, service_name, x));
+      continue;
+    }
+
+    dunedaq::utilities::ServiceRecord record;
+    record.target = name;
+    record.priority = ns_get16(ns_rr_rdata(rr));
+    record.weight = ns_get16(ns_rr_rdata(rr) + 2);
+    record.port = ns_get16(ns_rr_rdata(rr) + 4);
+    record.ttl = ns_rr_ttl(rr);
+    output.push_back(std::move(record));
+  }
+
+  collect_addresses(nsMsg, ns_s_ar, additional);
+  return output.empty() ? LookupOutcome::kNotFound : LookupOutcome::kFound;
+}
+
+/**
+ * @brief Query DNS (rather than getaddrinfo) for the A records of
+ * hostname, and its AAAA records if ipv6 is set. Used when the
+ * nameservers are set explicitly. Unless any query succeeded, error is
+ * set to the reason
+ * @return kFound if any address was found, kNotFound if the host has
+ * none, or kFailed if a query got no answer
+ */
+LookupOutcome
+query_host_addresses(std::string const& hostname, bool ipv6, HostAddresses& output, std::string& error)
+{
+  auto resolver_state = get_thread_resolver_state();
+  if (resolver_state == nullptr) {
+    error = "resolver initialisation failed";
+    return LookupOutcome::kFailed;
+  }
+
+  bool answered = false;
+  bool failed = false;
+  std::vector<unsigned char> query_buffer;
+  for (auto type : { ns_t_a, ns_t_aaaa }) {
+    if (type == ns_t_aaaa && !ipv6) {
+      break;
+    }
+    auto response = query_dns(resolver_state, hostname, type, query_buffer);
+    ns_msg nsMsg;
+    if (response < 0 || ns_initparse(query_buffer.data(), response, &nsMsg) < 0) {
+      error = hstrerror(h_errno);
+      failed = failed || response >= 0 || !is_definite_miss(h_errno);
+      continue;
+    }
+    answered = true;
+
+    // Owners differ from hostname when it is an alias, so take every address in the answer
+    std::unordered_map<std::string, HostAddresses> answer;
+    collect_addresses(nsMsg, ns_s_an, answer);
+    for (auto& [name, host] : answer) {
+      output.endpoints.insert(output.endpoints.end(), host.endpoints.begin(), host.endpoints.end());
+      output.ttl = std::min(output.ttl, host.ttl);
+    }
+  }
 
+  if (answered) {
+    error.clear();
+  }
+  if (!output.endpoints.empty()) {
+    return LookupOutcome::kFound;
+  }
+  return failed ? LookupOutcome::kFailed : LookupOutcome::kNotFound;
+}
+
+/**
+ * @brief Threads shared by all batch lookups. Threads are created on
+ * demand, up to kMaxBatchWorkers, and kept for later batches. They
+ * are never detached: shutdown_resolver_workers(), or the destruction
+ * of the pool, joins them, waiting for any lookup they are stuck in.
+ * Tasks submitted while the threads are being joined are refused
+ */
+class BatchWorkerPool
+{
+public:
+  static constexpr size_t kMaxBatchWorkers = 64;
+
+  BatchWorkerPool()
+  {
+    // The statics used by lookups are constructed first, so that they
+    // are destroyed after the pool has joined its threads
+    get_metrics();
+    get_failure_reporter();
+    get_nameserver_config();
+    dunedaq::utilities::get_hostname_cache();
+    dunedaq::utilities::get_service_cache();
+    dunedaq::utilities::get_resolver_backends();
+    dunedaq::utilities::get_address_policy();
+  }
+
+  ~BatchWorkerPool() { shutdown(); }
+
+  BatchWorkerPool(const BatchWorkerPool&) = delete;            ///< BatchWorkerPool is not copy-constructible
+  BatchWorkerPool& operator=(const BatchWorkerPool&) = delete; ///< BatchWorkerPool is not copy-assignable
+
+  /**
+   * @brief Run task on a pool thread
+   * @return false, without queueing the task, if no thread is free and
+   * none can be added, or the pool is shut down
+   */
+  bool submit(std::function<void()> task)
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    if (m_shut_down) {
+      return false;
+    }
+    if (m_tasks.size() >= m_idle) {
+      if (m_threads.size() == kMaxBatchWorkers) {
+        return false;
+      }
+      m_threads.emplace_back(&BatchWorkerPool::run, this);
+    }
+    m_tasks.push_back(std::move(task));
+    m_cv.notify_one();
+    return true;
+  }
+
+  void shutdown()
+  {
+    std::vector<std::thread> threads;
+    {
+      std::lock_guard<std::mutex> lk(m_mutex);
+      m_shut_down = true;
+      threads.swap(m_threads);
+    }
+    m_cv.notify_all();
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    // Later batches start new threads
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_shut_down = false;
+  }
+
+private:
+  void run()
+  {
+    std::unique_lock<std::mutex> lk(m_mutex);
+    while (true) {
+      ++m_idle;
+      m_cv.wait(lk, [&] { return !m_tasks.empty() || m_shut_down; });
+      --m_idle;
+      if (m_tasks.empty()) {
+        return;
+      }
+      auto task = std::move(m_tasks.front());
+      m_tasks.pop_front();
+      lk.unlock();
+      task();
+      lk.lock();
+    }
+  }
+
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  std::deque<std::function<void()>> m_tasks;
+  std::vector<std::thread> m_threads;
+  size_t m_idle{ 0 };
+  bool m_shut_down{ false };
+};
+
+BatchWorkerPool&
+get_batch_pool()
+{
+  static BatchWorkerPool s_pool;
+  return s_pool;
+}
+
+/**
+ * @brief State shared between the caller of run_batch and its workers.
+ * Workers hold a reference, so that a worker stuck in a lookup which
+ * the caller has given up on can finish safely later
+ */
+template<typename Result>
+struct BatchState
+{
+  enum class ItemState
+  {
+    kPending,
+    kRunning,
+    kDone,
+    kAbandoned
+  };
+
+  std::function<Result(std::string const&)> lookup;
+  std::vector<std::string> names;
+  std::vector<Result> results;
+  std::vector<ItemState> states;
+  // Running items, in the order in which they started (and so of their deadlines)
+  std::deque<std::pair<std::chrono::steady_clock::time_point, size_t>> running;
+  size_t next{ 0 };
+  size_t remaining{ 0 };
+  size_t active_workers{ 0 }; // Workers which will take another item when they finish theirs
+
+  std::mutex mutex;
+  std::condition_variable cv;
+};
+
+/**
+ * @brief Run the lookup of item index, with the state's mutex held on
+ * entry and exit
+ * @return false if the caller gave up on the lookup while it ran
+ */
+template<typename Result>
+bool
+run_batch_item(BatchState<Result>& state, size_t index, std::unique_lock<std::mutex>& lk)
+{
+  using ItemState = typename BatchState<Result>::ItemState;
+
+  state.states[index] = ItemState::kRunning;
+  state.running.emplace_back(std::chrono::steady_clock::now(), index);
+  if (state.running.size() == 1) {
+    // So that the caller sets its deadline; otherwise it is waiting for an earlier one
+    state.cv.notify_all();
+  }
+  lk.unlock();
+
+  Result result;
+  try {
+    result = state.lookup(state.names[index]);
+  } catch (ers::Issue const& issue) {
+    ers::error(issue);
+  } catch (std::exception const& e) {
+    ers::error(dunedaq::utilities::NameNotFound(ERS_HERE, state.names[index], e.what()));
+  }
+
+  lk.lock();
+  if (state.states[index] == ItemState::kAbandoned) {
+    return false;
+  }
+  state.results[index] = std::move(result);
+  state.states[index] = ItemState::kDone;
+  if (--state.remaining == 0) {
+    state.cv.notify_all();
+  }
+  return true;
+}
+
+template<typename Result>
+void
+run_batch_worker(std::shared_ptr<BatchState<Result>> state)
+{
+  std::unique_lock<std::mutex> lk(state->mutex);
+  while (state->next < state->names.size()) {
+    if (!run_batch_item(*state, state->next++, lk)) {
+      // The caller has given up on this worker, and started a replacement
+      return;
+    }
+  }
+  --state->active_workers;
+  state->cv.notify_all();
+}
+
+template<typename Result>
+bool
+start_batch_worker(std::shared_ptr<BatchState<Result>> const& state)
+{
+  if (!get_batch_pool().submit([state]() { run_batch_worker<Result>(state); })) {
+    return false;
+  }
+  ++state->active_workers;
+  return true;
+}
+
+/**
+ * @brief Run lookup on each of names, on at most max_concurrency pool
+ * threads at once, abandoning lookups which take longer than timeout.
+ * If the pool has no thread to spare (eg all are stuck in abandoned
+ * lookups), the items which no worker can take are failed with
+ * ResolveTimeout, rather than run on the caller where the timeout could
+ * not be enforced
+ */
+template<typename Result>
+std::vector<Result>
+run_batch(std::vector<std::string> const& names,
+          std::function<Result(std::string const&)> lookup,
+          dunedaq::utilities::BatchResolveOptions const& options)
+{
+  using ItemState = typename BatchState<Result>::ItemState;
+  auto state = std::make_shared<BatchState<Result>>();
+  state->lookup = std::move(lookup);
+  state->names = names;
+  state->results.resize(names.size());
+  state->states.resize(names.size(), ItemState::kPending);
+  state->remaining = names.size();
+
+  std::unique_lock<std::mutex> lk(state->mutex);
+  auto n_workers = std::min(std::max(options.max_concurrency, size_t(1)), names.size());
+  while (state->active_workers < n_workers && start_batch_worker(state)) {
+    // Started another worker
+  }
+
+  while (state->remaining > 0) {
+    if (state->next < names.size() && state->active_workers == 0) {
+      // No worker to take the remaining items, and none can be started
+      for (; state->next < names.size(); ++state->next) {
+        state->states[state->next] = ItemState::kAbandoned;
+        --state->remaining;
+        ers::warning(dunedaq::utilities::ResolveTimeout(ERS_HERE, names[state->next], options.timeout.count()));
+      }
+      continue;
+    }
+
+    // Items finished since the caller last looked are dropped here
+    auto now = std::chrono::steady_clock::now();
+    while (!state->running.empty()) {
+      auto [start, i] = state->running.front();
+      if (state->states[i] != ItemState::kRunning) {
+        state->running.pop_front();
+        continue;
+      }
+      if (start + options.timeout > now) {
+        break;
+      }
+
+      // Give up on this lookup, and replace its (blocked) worker so that
+      // the rest of the batch keeps its concurrency
+      state->running.pop_front();
+      state->states[i] = ItemState::kAbandoned;
+      --state->remaining;
+      --state->active_workers;
+      ers::warning(dunedaq::utilities::ResolveTimeout(ERS_HERE, names[i], options.timeout.count()));
+      if (state->next < names.size()) {
+        start_batch_worker(state);
+      }
+    }
+    if (state->remaining == 0 || (state->next < names.size() && state->active_workers == 0)) {
+      continue;
+    }
+    if (state->running.empty()) {
+      state->cv.wait(lk);
+    } else {
+      state->cv.wait_until(lk, state->running.front().first + options.timeout);
+    }
+  }
+
+  return std::move(state->results);
+}
+
+/**
+ * @brief Look up the addresses of hostname, and order them by the
+ * address policy. The endpoints have no scheme, and port 0. The answer
+ * is put in the hostname cache. If use_cache is false, the cache is
+ * not read, and failed lookups leave the cached answer as it is
+ */
+std::vector<dunedaq::utilities::Endpoint>
+lookup_host(std::string const& hostname, bool use_cache, LookupOutcome& outcome)
+{
   TLOG_DEBUG(12) << "Name is " << hostname;
+  get_failure_reporter().flush_expired();
+  get_metrics().host_lookups.increment();
+
+  for (auto& backend : *dunedaq::utilities::get_resolver_backends()) {
+    auto found = backend->find_host(hostname);
+    if (found) {
+      TLOG_DEBUG(13) << "Using resolver backend addresses for hostname " << hostname;
+      dunedaq::utilities::get_address_policy()->apply(*found, false);
+      outcome = found->empty() ? LookupOutcome::kNotFound : LookupOutcome::kFound;
+      return std::move(*found);
+    }
+  }
+
+  auto cached = use_cache ? dunedaq::utilities::get_hostname_cache().get(hostname) : nullptr;
+  if (cached) {
+    TLOG_DEBUG(13) << "Using cached addresses for hostname " << hostname;
+    get_metrics().host_cache_hits.increment();
+    if (cached->empty()) {
+      report_name_not_found(hostname, "lookup failed recently");
+    }
+    outcome = cached->empty() ? LookupOutcome::kNotFound : LookupOutcome::kFound;
+    return *cached;
+  }
+
+  auto policy = dunedaq::utilities::get_address_policy();
+  std::vector<dunedaq::utilities::Endpoint> output;
+  if (get_nameserver_config().overridden.load()) {
+    auto numeric = dunedaq::utilities::Endpoint::from_numeric("", hostname, 0);
+    if (numeric) {
+      outcome = LookupOutcome::kFound;
+      return { std::move(*numeric) };
+    }
+
+    HostAddresses host;
+    std::string error;
+    outcome = query_host_addresses(hostname, policy->get_ipv6_enabled(), host, error);
+    if (!error.empty()) {
+      get_metrics().host_failures.increment();
+      report_name_not_found(hostname, error);
+    }
+    policy->apply(host.endpoints);
+    if (!host.endpoints.empty()) {
+      dunedaq::utilities::get_hostname_cache().put(hostname, host.endpoints, std::chrono::seconds(host.ttl));
+    } else {
+      if (outcome == LookupOutcome::kFound) {
+        // The policy left no address
+        outcome = LookupOutcome::kNotFound;
+      }
+      if (use_cache || outcome == LookupOutcome::kNotFound) {
+        dunedaq::utilities::get_hostname_cache().put(hostname, host.endpoints, get_negative_ttl());
+      }
+    }
+    return host.endpoints;
+  }
 
+  // One socket type gives one entry per address; without IPv6 there's no need to ask for AAAA records
+  struct addrinfo hints{};
+  hints.ai_family = policy->get_ipv6_enabled() ? AF_UNSPEC : AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
   struct addrinfo* result;
-  auto s = getaddrinfo(hostname.c_str(), nullptr, nullptr, &result);
+  auto s = dunedaq::utilities::time_call(get_metrics().getaddrinfo_time,
+                                         [&]() { return getaddrinfo(hostname.c_str(), nullptr, &hints, &result); });
 
   if (s != 0) {
-    ers::error(NameNotFound(ERS_HERE, hostname, std::string(gai_strerror(s))));
+    get_metrics().host_failures.increment();
+    report_name_not_found(hostname, gai_strerror(s));
+    outcome = s == EAI_NONAME || s == EAI_NODATA ? LookupOutcome::kNotFound : LookupOutcome::kFailed;
+    if (use_cache || outcome == LookupOutcome::kNotFound) {
+      dunedaq::utilities::get_hostname_cache().put(hostname, output, get_negative_ttl());
+    }
     return output;
   }
 
+  std::unordered_set<dunedaq::utilities::Endpoint> seen;
   for (auto rp = result; rp != nullptr; rp = rp->ai_next) {
-    char hbuf[NI_MAXHOST], sbuf[NI_MAXSERV];
-
-    // Let's skip all the IPv6 here
-    if (rp->ai_family == AF_INET6)
+    dunedaq::utilities::Endpoint endpoint("", rp->ai_addr, rp->ai_addrlen);
+    if (!endpoint.is_valid()) {
       continue;
+    }
+    endpoint.set_port(0);
+    // Hosts files and multi-homed hosts can list the same address more than once
+    if (seen.insert(endpoint).second) {
+      TLOG_DEBUG(13) << "Found address " << endpoint.get_address() << " for hostname " << hostname;
+      output.push_back(std::move(endpoint));
+    }
+  }
 
-    getnameinfo(rp->ai_addr, rp->ai_addrlen, hbuf, sizeof(hbuf), sbuf, sizeof(sbuf), NI_NUMERICHOST | NI_NUMERICSERV);
-    auto result = std::string(hbuf);
-    bool duplicate = false;
-    for (auto& res : output) {
-      if (res == result) {
-        duplicate = true;
-        break;
+  freeaddrinfo(result);
+  policy->apply(output);
+
+  outcome = output.empty() ? LookupOutcome::kNotFound : LookupOutcome::kFound;
+  if (!output.empty()) {
+    dunedaq::utilities::get_hostname_cache().put(hostname, output);
+  } else {
+    dunedaq::utilities::get_hostname_cache().put(hostname, output, get_negative_ttl());
+  }
+  return output;
+}
+
+/**
+ * @brief Look up the addresses of hostname, using the hostname cache
+ */
+std::vector<dunedaq::utilities::Endpoint>
+lookup_host(std::string const& hostname)
+{
+  LookupOutcome outcome;
+  return lookup_host(hostname, true, outcome);
+}
+
+/**
+ * @brief Drop the negative cache entry for hostname, if it has one, so
+ * that the next lookup queries again
+ */
+void
+forget_host_failure(std::string const& hostname)
+{
+  auto cached = dunedaq::utilities::get_hostname_cache().get(hostname);
+  if (cached && cached->empty()) {
+    dunedaq::utilities::get_hostname_cache().invalidate(hostname);
+  }
+}
+
+/**
+ * @brief Drop the cache entry for service_name if none of its targets
+ * has addresses, and the negative entries of its targets, so that the
+ * next lookup queries again
+ */
+void
+forget_service_failure(std::string const& service_name)
+{
+  auto cached = dunedaq::utilities::get_service_cache().get(service_name);
+  if (!cached) {
+    return;
+  }
+  for (auto& record : *cached) {
+    if (!record.endpoints.empty()) {
+      return;
+    }
+  }
+  for (auto& record : *cached) {
+    forget_host_failure(record.target);
+  }
+  dunedaq::utilities::get_service_cache().invalidate(service_name);
+}
+
+/**
+ * @brief Resolve the host of a connection string into endpoints, as
+ * resolve_uri_endpoints does. use_cache and outcome are as for lookup_host
+ */
+std::vector<dunedaq::utilities::Endpoint>
+lookup_uri_endpoints(std::string_view connection_string, bool use_cache, LookupOutcome& outcome)
+{
+  auto uri = dunedaq::utilities::parse_connection_string_view(connection_string);
+
+  if (uri.scheme != "tcp") {
+    outcome = LookupOutcome::kNotFound;
+    return {};
+  }
+
+  uint32_t port = 0; // NOLINT(build/unsigned)
+  if (uri.port.empty() || uri.port.size() > 5) {
+    throw dunedaq::utilities::InvalidUri(ERS_HERE, std::string(connection_string));
+  }
+  for (auto c : uri.port) {
+    if (c < '0' || c > '9') {
+      throw dunedaq::utilities::InvalidUri(ERS_HERE, std::string(connection_string));
+    }
+    port = port * 10 + static_cast<uint32_t>(c - '0'); // NOLINT(build/unsigned)
+  }
+  if (port > std::numeric_limits<uint16_t>::max()) { // NOLINT(build/unsigned)
+    throw dunedaq::utilities::InvalidUri(ERS_HERE, std::string(connection_string));
+  }
+
+  // Numeric hosts need no lookup
+  auto numeric =
+    dunedaq::utilities::Endpoint::from_numeric(std::string(uri.scheme), uri.host, static_cast<uint16_t>(port)); // NOLINT
+  if (numeric) {
+    outcome = LookupOutcome::kFound;
+    return { std::move(*numeric) };
+  }
+  auto output = lookup_host(std::string(uri.host), use_cache, outcome);
+  for (auto& endpoint : output) {
+    endpoint.set_scheme(std::string(uri.scheme));
+    endpoint.set_port(static_cast<uint16_t>(port)); // NOLINT(build/unsigned)
+  }
+  return output;
+}
+
+/**
+ * @brief Look up the SRV records of service_name (a DNS name, see
+ * get_service_dns_name) and the addresses of their targets. The answer
+ * is put in the service cache. If use_cache is false, the caches are
+ * not read, and failed lookups leave the cached answers as they are.
+ * A service whose targets all fail to resolve has failed
+ */
+std::vector<dunedaq::utilities::ServiceRecord>
+lookup_service(std::string const& service_name, bool use_cache, LookupOutcome& outcome)
+{
+  std::vector<dunedaq::utilities::ServiceRecord> output;
+
+  get_metrics().service_lookups.increment();
+  get_failure_reporter().flush_expired();
+  bool from_backend = false;
+  for (auto& backend : *dunedaq::utilities::get_resolver_backends()) {
+    auto found = backend->find_service(service_name);
+    if (found) {
+      TLOG_DEBUG(13) << "Using resolver backend records for service " << service_name;
+      output = std::move(*found);
+      from_backend = true;
+      break;
+    }
+  }
+
+  uint32_t min_ttl = std::numeric_limits<uint32_t>::max(); // NOLINT(build/unsigned)
+  std::unordered_map<std::string, HostAddresses> additional;
+  if (!from_backend) {
+    auto cached = use_cache ? dunedaq::utilities::get_service_cache().get(service_name) : nullptr;
+    if (cached) {
+      TLOG_DEBUG(13) << "Using cached records for service " << service_name;
+      get_metrics().service_cache_hits.increment();
+      if (cached->empty()) {
+        report_service_not_found(service_name);
       }
+      outcome = cached->empty() ? LookupOutcome::kNotFound : LookupOutcome::kFound;
+      return *cached;
     }
-    if (!duplicate) {
-      TLOG_DEBUG(13) << "Found address " << result << " for hostname " << hostname;
-      output.push_back(result);
+
+    // Failed queries have been reported already; services without SRV records have not
+    outcome = query_service_records(service_name, output, additional);
+    if (outcome == LookupOutcome::kNotFound) {
+      report_service_not_found(service_name);
+    }
+    if (outcome != LookupOutcome::kFound) {
+      get_metrics().service_failures.increment();
+      if (use_cache || outcome == LookupOutcome::kNotFound) {
+        dunedaq::utilities::get_service_cache().put(service_name, output, get_negative_ttl());
+      }
+      return output;
+    }
+    for (auto& record : output) {
+      min_ttl = std::min(min_ttl, record.ttl);
     }
   }
 
-  freeaddrinfo(result);
+  // Resolve the target hosts concurrently, each one once. Addresses which the server
+  // sent along with the answer need no lookup, and are cached for later lookups
+  std::vector<std::string> unique_names;
+  std::vector<std::vector<dunedaq::utilities::Endpoint>> unique_hosts;
+  std::unordered_map<std::string, size_t> name_indices;
+  std::vector<std::string> lookup_names;
+  std::vector<size_t> lookup_indices;
+  for (auto& record : output) {
+    if (!name_indices.emplace(record.target, unique_names.size()).second) {
+      continue;
+    }
+    unique_names.push_back(record.target);
+    auto it = additional.find(record.target);
+    if (it != additional.end()) {
+      dunedaq::utilities::get_address_policy()->apply(it->second.endpoints);
+    }
+    if (it != additional.end() && !it->second.endpoints.empty()) {
+      dunedaq::utilities::get_hostname_cache().put(
+        record.target, it->second.endpoints, std::chrono::seconds(it->second.ttl));
+      unique_hosts.push_back(std::move(it->second.endpoints));
+    } else {
+      unique_hosts.emplace_back();
+      lookup_names.push_back(record.target);
+      lookup_indices.push_back(unique_names.size() - 1);
+    }
+  }
+  auto lookup_target = [use_cache](std::string const& name) {
+    LookupOutcome target_outcome;
+    return lookup_host(name, use_cache, target_outcome);
+  };
+  if (lookup_names.size() == 1) {
+    unique_hosts[lookup_indices[0]] = lookup_target(lookup_names[0]);
+  } else if (lookup_names.size() > 1) {
+    auto looked_up = run_batch<std::vector<dunedaq::utilities::Endpoint>>(
+      lookup_names, lookup_target, dunedaq::utilities::BatchResolveOptions());
+    for (size_t i = 0; i < looked_up.size(); ++i) {
+      unique_hosts[lookup_indices[i]] = std::move(looked_up[i]);
+    }
+  }
+  for (auto& record : output) {
+    record.endpoints = unique_hosts[name_indices[record.target]];
+    for (auto& endpoint : record.endpoints) {
+      endpoint.set_scheme("tcp");
+      endpoint.set_port(record.port);
+    }
+  }
 
+  bool resolved = std::any_of(output.begin(), output.end(), [](dunedaq::utilities::ServiceRecord const& r) {
+    return !r.endpoints.empty();
+  });
+  if (output.empty()) {
+    outcome = LookupOutcome::kNotFound;
+  } else {
+    outcome = resolved ? LookupOutcome::kFound : LookupOutcome::kFailed;
+  }
+
+  // Answers whose targets could not be resolved are only kept for the negative TTL,
+  // so that they're retried soon. Backend answers are not cached at all, since asking the backend again costs no more
+  if (!from_backend) {
+    if (resolved) {
+      dunedaq::utilities::get_service_cache().put(service_name, output, std::chrono::seconds(min_ttl));
+    } else if (use_cache) {
+      dunedaq::utilities::get_service_cache().put(service_name, output, get_negative_ttl());
+    }
+  }
+  return output;
+}
+
+} // namespace
+
+std::vector<std::string>
+dunedaq::utilities::get_ips_from_hostname(std::string hostname)
+{
+  std::vector<std::string> output;
+  for (auto& endpoint : lookup_host(hostname)) {
+    output.push_back(endpoint.get_address());
+  }
+  return output;
+}
+
+std::vector<dunedaq::utilities::Endpoint>
+dunedaq::utilities::get_endpoints_from_hostname(std::string const& hostname, uint16_t port, std::string const& scheme)
+{
+  auto output = lookup_host(hostname);
+  for (auto& endpoint : output) {
+    endpoint.set_scheme(scheme);
+    endpoint.set_port(port);
+  }
   return output;
 }
 
 std::vector<std::string>
 dunedaq::utilities::resolve_uri_hostname(std::string connection_string)
 {
-  auto uri = parse_connection_string(connection_string);
+  auto uri = parse_connection_string_view(connection_string);
 
-  if(uri.scheme == "tcp") {
-  auto output = get_ips_from_hostname(uri.host);
+  if (uri.scheme != "tcp") {
+    return { connection_string };
+  }
 
-  for (size_t ii = 0; ii < output.size(); ++ii) {
-    output[ii] = "tcp://" + output[ii] + ":" + uri.port;
+  auto output = get_ips_from_hostname(std::string(uri.host));
+  for (auto& ip : output) {
+    // Keep everything but the host, which may need brackets now that it's numeric
+    auto resolved = uri;
+    resolved.host = ip;
+    ip = resolved.to_string();
   }
   return output;
-  } else {
-  return { connection_string }; 
+}
+
+std::vector<dunedaq::utilities::Endpoint>
+dunedaq::utilities::resolve_uri_endpoints(std::string_view connection_string)
+{
+  LookupOutcome outcome;
+  return lookup_uri_endpoints(connection_string, true, outcome);
+}
+
+std::optional<std::vector<dunedaq::utilities::Endpoint>>
+dunedaq::utilities::refresh_uri_endpoints(std::string_view connection_string)
+{
+  LookupOutcome outcome;
+  auto output = lookup_uri_endpoints(connection_string, false, outcome);
+  if (outcome == LookupOutcome::kFailed) {
+    return std::nullopt;
   }
+  return output;
 }
 
 std::vector<std::string>
 dunedaq::utilities::get_service_addresses(std::string service_name, std::string const& hostname)
 {
   std::vector<std::string> output;
-  unsigned char query_buffer[1024];
+  for (auto& record : get_service_records(service_name, hostname)) {
+    for (auto& endpoint : record.endpoints) {
+      auto address = endpoint.get_address();
+      if (endpoint.get_family() == AF_INET6) {
+        address = "[" + address + "]";
+      }
+      output.push_back(address + ":" + std::to_string(record.port));
+    }
+  }
+  return output;
+}
+
+std::vector<dunedaq::utilities::Endpoint>
+dunedaq::utilities::get_service_endpoints(std::string service_name, std::string const& hostname)
+{
+  std::vector<Endpoint> output;
+  for (auto& record : get_service_records(service_name, hostname)) {
+    output.insert(output.end(), record.endpoints.begin(), record.endpoints.end());
+  }
+  return output;
+}
 
+std::string
+dunedaq::utilities::get_service_dns_name(std::string service_name, std::string const& hostname)
+{
   // Check if we're given a "bare" service name, convert to DNS service name, assuming TCP
   if (std::count(service_name.begin(), service_name.end(), '.') == 0) {
     service_name = "_" + service_name + "._tcp";
@@ -82,51 +1202,156 @@ dunedaq::utilities::get_service_addresses(std::string service_name, std::string
       service_name += "." + hostname;
     }
   }
+  return service_name;
+}
 
-  auto response = res_search(service_name.c_str(), C_IN, ns_t_srv, query_buffer, sizeof(query_buffer));
-  if (response < 0) {
-    ers::error(ServiceNotFound(ERS_HERE, service_name));
-    return output;
+std::vector<dunedaq::utilities::ServiceRecord>
+dunedaq::utilities::get_service_records(std::string service_name, std::string const& hostname)
+{
+  LookupOutcome outcome;
+  return lookup_service(get_service_dns_name(service_name, hostname), true, outcome);
+}
+
+std::optional<std::vector<dunedaq::utilities::ServiceRecord>>
+dunedaq::utilities::refresh_service_records(std::string service_name, std::string const& hostname)
+{
+  LookupOutcome outcome;
+  auto output = lookup_service(get_service_dns_name(service_name, hostname), false, outcome);
+  if (outcome == LookupOutcome::kFailed) {
+    return std::nullopt;
   }
+  return output;
+}
 
-  ns_msg nsMsg;
-  ns_initparse(query_buffer, response, &nsMsg);
+std::vector<std::vector<std::string>>
+dunedaq::utilities::resolve_many(std::vector<std::string> const& connection_strings,
+                                 BatchResolveOptions const& options)
+{
+  return run_batch<std::vector<std::string>>(
+    connection_strings, [](std::string const& name) { return resolve_uri_hostname(name); }, options);
+}
 
-  for (int x = 0; x < ns_msg_count(nsMsg, ns_s_an); x++) {
-    ns_rr rr;
-    ns_parserr(&nsMsg, ns_s_an, x, &rr);
+std::vector<std::vector<std::string>>
+dunedaq::utilities::get_service_addresses_many(std::vector<std::string> const& service_names,
+                                               std::string const& hostname,
+                                               BatchResolveOptions const& options)
+{
+  return run_batch<std::vector<std::string>>(
+    service_names, [hostname](std::string const& name) { return get_service_addresses(name, hostname); }, options);
+}
 
-    char name[1024];
-    dn_expand(ns_msg_base(nsMsg), ns_msg_end(nsMsg), ns_rr_rdata(rr) + 6, name, sizeof(name));
+dunedaq::utilities::ResolverCache<std::vector<dunedaq::utilities::Endpoint>>&
+dunedaq::utilities::get_hostname_cache()
+{
+  static ResolverCache<std::vector<Endpoint>> s_cache(kDefaultResolverCacheMaxAge);
+  return s_cache;
+}
 
-    auto port = ntohs(*((unsigned short*)ns_rr_rdata(rr) + 2)); // NOLINT(runtime/int)
+dunedaq::utilities::ResolverCache<std::vector<dunedaq::utilities::ServiceRecord>>&
+dunedaq::utilities::get_service_cache()
+{
+  static ResolverCache<std::vector<ServiceRecord>> s_cache(kDefaultResolverCacheMaxAge);
+  return s_cache;
+}
 
-    auto ips = get_ips_from_hostname(name);
-    for (auto& ip : ips) {
-      output.push_back(ip + ":" + std::to_string(port));
+void
+dunedaq::utilities::set_resolver_nameservers(std::vector<Endpoint> const& nameservers,
+                                             std::chrono::seconds timeout,
+                                             int attempts)
+{
+  if (nameservers.size() > MAXNS) {
+    throw InvalidResolverConfiguration(ERS_HERE, "at most " + std::to_string(MAXNS) + " nameservers can be set");
+  }
+  for (auto& nameserver : nameservers) {
+    if (nameserver.get_family() != AF_INET) {
+      throw InvalidResolverConfiguration(ERS_HERE, "nameserver " + nameserver.to_string() + " is not an IPv4 address");
     }
   }
-  return output;
+
+  auto& config = get_nameserver_config();
+  {
+    std::lock_guard<std::mutex> lk(config.mutex);
+    config.nameservers = nameservers;
+    config.timeout = timeout;
+    config.attempts = attempts;
+    config.overridden = !nameservers.empty();
+  }
+  config.generation.fetch_add(1, std::memory_order_release);
+  invalidate_resolver_cache();
 }
 
-dunedaq::utilities::ZmqUri
-dunedaq::utilities::parse_connection_string(std::string connection_string)
+void
+dunedaq::utilities::set_resolver_negative_ttl(std::chrono::milliseconds ttl)
 {
-  // ZMQ URIs are formatted as follows: tcp://{host}:{port}
-  ZmqUri output;
+  s_negative_ttl_ms = ttl.count();
+}
 
-  if (connection_string.find("://") == std::string::npos) {
-    throw InvalidUri(ERS_HERE, connection_string);
-  }
+std::chrono::milliseconds
+dunedaq::utilities::get_resolver_negative_ttl()
+{
+  return get_negative_ttl();
+}
 
-  output.scheme = connection_string.substr(0, connection_string.find("://"));
-  connection_string = connection_string.substr(connection_string.find("://") + 3);
+void
+dunedaq::utilities::set_resolver_error_report_interval(std::chrono::milliseconds interval)
+{
+  get_failure_reporter().set_interval(interval);
+}
 
-  if (connection_string.find(":") != std::string::npos) {
-    output.port = connection_string.substr(connection_string.find(":") + 1);
-    connection_string = connection_string.substr(0, connection_string.find(":"));
-  }
-  output.host = connection_string;
+std::vector<std::string>
+dunedaq::utilities::get_service_addresses_with_retry(std::string const& service_name,
+                                                     std::string const& hostname,
+                                                     RetryPolicy const& policy,
+                                                     const std::atomic<bool>* running)
+{
+  auto dns_name = get_service_dns_name(service_name, hostname);
+  bool retrying = false;
+  return retry_with_backoff(
+    [&]() {
+      if (retrying) {
+        forget_service_failure(dns_name);
+      }
+      retrying = true;
+      return get_service_addresses(service_name, hostname);
+    },
+    policy,
+    running);
+}
 
-  return output;
-}
\ No newline at end of file
+std::vector<std::string>
+dunedaq::utilities::resolve_uri_hostname_with_retry(std::string const& connection_string,
+                                                    RetryPolicy const& policy,
+                                                    const std::atomic<bool>* running)
+{
+  bool retrying = false;
+  return retry_with_backoff(
+    [&]() {
+      if (retrying) {
+        forget_host_failure(std::string(parse_connection_string_view(connection_string).host));
+      }
+      retrying = true;
+      return resolve_uri_hostname(connection_string);
+    },
+    policy,
+    running);
+}
+
+void
+dunedaq::utilities::shutdown_resolver_workers()
+{
+  get_batch_pool().shutdown();
+}
+
+void
+dunedaq::utilities::set_resolver_cache_max_age(std::chrono::milliseconds max_age)
+{
+  get_hostname_cache().set_max_age(max_age);
+  get_service_cache().set_max_age(max_age);
+}
+
+void
+dunedaq::utilities::invalidate_resolver_cache()
+{
+  get_hostname_cache().invalidate();
+  get_service_cache().invalidate();
+}
@@ -0,0 +1,245 @@
+/**
+ *
+ * @file ResolverBackend.cpp Name sources consulted by the Resolver before DNS
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/ResolverBackend.hpp"
+#include "utilities/Issues.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace {
+
+using backend_list_t = std::vector<std::shared_ptr<dunedaq::utilities::ResolverBackend>>;
+
+/**
+ * @brief The chain is replaced as a whole when it changes, so lookups
+ * load it atomically without locking. The mutex only serialises changes
+ */
+struct BackendChain
+{
+  std::mutex mutex;
+  std::shared_ptr<const backend_list_t> backends{ std::make_shared<const backend_list_t>() };
+};
+
+BackendChain&
+get_backend_chain()
+{
+  static BackendChain s_chain;
+  return s_chain;
+}
+
+template<typename Value>
+Value
+get_json_field(nlohmann::json const& json, const char* field, Value default_value, std::string const& context)
+{
+  if (!json.contains(field)) {
+    return default_value;
+  }
+  try {
+    return json.at(field).get<Value>();
+  } catch (nlohmann::json::exception const& e) {
+    throw dunedaq::utilities::InvalidResolverConfiguration(ERS_HERE,
+                                                           "field " + std::string(field) + " of " + context + ": " +
+                                                             e.what());
+  }
+}
+
+/**
+ * @brief As get_json_field, but also rejecting values out of the range of Value
+ */
+template<typename Value>
+Value
+get_json_integer(nlohmann::json const& json, const char* field, std::string const& context)
+{
+  auto value = get_json_field<int64_t>(json, field, 0, context);
+  if (value < 0 || static_cast<uint64_t>(value) > std::numeric_limits<Value>::max()) { // NOLINT(build/unsigned)
+    throw dunedaq::utilities::InvalidResolverConfiguration(
+      ERS_HERE, "field " + std::string(field) + " of " + context + " is out of range");
+  }
+  return static_cast<Value>(value);
+}
+
+} // namespace
+
+template<typename Result>
+Result
+dunedaq::utilities::ResolverBackend::count(Result&& result)
+{
+  if (result) {
+    m_hits.fetch_add(1, std::memory_order_relaxed);
+  } else {
+    m_misses.fetch_add(1, std::memory_order_relaxed);
+  }
+  return std::forward<Result>(result);
+}
+
+std::optional<std::vector<dunedaq::utilities::Endpoint>>
+dunedaq::utilities::ResolverBackend::find_host(std::string const& hostname)
+{
+  return count(lookup_host(hostname));
+}
+
+std::optional<std::vector<dunedaq::utilities::ServiceRecord>>
+dunedaq::utilities::ResolverBackend::find_service(std::string const& service_name)
+{
+  return count(lookup_service(service_name));
+}
+
+void
+dunedaq::utilities::ResolverBackend::reset_statistics()
+{
+  m_hits = 0;
+  m_misses = 0;
+}
+
+std::shared_ptr<dunedaq::utilities::StaticResolverBackend>
+dunedaq::utilities::StaticResolverBackend::from_json(nlohmann::json const& json)
+{
+  if (!json.is_object()) {
+    throw InvalidResolverConfiguration(ERS_HERE, "the configuration is not a JSON object");
+  }
+
+  auto output = std::make_shared<StaticResolverBackend>();
+
+  auto hosts = get_json_field(json, "hosts", nlohmann::json::object(), "the configuration");
+  for (auto& item : hosts.items()) {
+    output->add_host(item.key(), get_json_field(hosts, item.key().c_str(), std::vector<std::string>(), "hosts"));
+  }
+
+  auto services = get_json_field(json, "services", nlohmann::json::object(), "the configuration");
+  for (auto& item : services.items()) {
+    auto& service_name = item.key();
+    auto& entries = item.value();
+    if (!entries.is_array()) {
+      throw InvalidResolverConfiguration(ERS_HERE, "service " + service_name + " is not a list of records");
+    }
+    std::vector<ServiceRecord> records;
+    for (auto& entry : entries) {
+      auto context = "a record of service " + service_name;
+      ServiceRecord record;
+      record.target = get_json_field(entry, "target", std::string(), context);
+      record.port = get_json_integer<uint16_t>(entry, "port", context);         // NOLINT(build/unsigned)
+      record.priority = get_json_integer<uint16_t>(entry, "priority", context); // NOLINT(build/unsigned)
+      record.weight = get_json_integer<uint16_t>(entry, "weight", context);     // NOLINT(build/unsigned)
+      record.ttl = get_json_integer<uint32_t>(entry, "ttl", context);           // NOLINT(build/unsigned)
+      if (record.target.empty() || record.port == 0) {
+        throw InvalidResolverConfiguration(ERS_HERE, context + " has no target or port");
+      }
+      records.push_back(std::move(record));
+    }
+    output->add_service(service_name, std::move(records));
+  }
+
+  return output;
+}
+
+std::shared_ptr<dunedaq::utilities::StaticResolverBackend>
+dunedaq::utilities::StaticResolverBackend::from_file(std::string const& path)
+{
+  std::ifstream file(path);
+  if (!file) {
+    throw InvalidResolverConfiguration(ERS_HERE, "cannot open " + path);
+  }
+  nlohmann::json json;
+  try {
+    file >> json;
+  } catch (nlohmann::json::exception const& e) {
+    throw InvalidResolverConfiguration(ERS_HERE, "cannot parse " + path + ": " + e.what());
+  }
+  return from_json(json);
+}
+
+void
+dunedaq::utilities::StaticResolverBackend::add_host(std::string const& hostname,
+                                                    std::vector<std::string> const& addresses)
+{
+  std::vector<Endpoint> endpoints;
+  for (auto& address : addresses) {
+    auto endpoint = Endpoint::from_numeric("", address, 0);
+    if (!endpoint) {
+      throw InvalidResolverConfiguration(ERS_HERE, "address " + address + " of host " + hostname + " is not numeric");
+    }
+    endpoints.push_back(std::move(*endpoint));
+  }
+
+  std::unique_lock<std::shared_mutex> lk(m_mutex);
+  m_hosts[hostname] = std::move(endpoints);
+}
+
+void
+dunedaq::utilities::StaticResolverBackend::add_service(std::string const& service_name,
+                                                       std::vector<ServiceRecord> records)
+{
+  for (auto& record : records) {
+    record.endpoints.clear();
+  }
+
+  std::unique_lock<std::shared_mutex> lk(m_mutex);
+  m_services[service_name] = std::move(records);
+}
+
+std::optional<std::vector<dunedaq::utilities::Endpoint>>
+dunedaq::utilities::StaticResolverBackend::lookup_host(std::string const& hostname)
+{
+  std::shared_lock<std::shared_mutex> lk(m_mutex);
+  auto it = m_hosts.find(hostname);
+  if (it == m_hosts.end()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
+std::optional<std::vector<dunedaq::utilities::ServiceRecord>>
+dunedaq::utilities::StaticResolverBackend::lookup_service(std::string const& service_name)
+{
+  std::shared_lock<std::shared_mutex> lk(m_mutex);
+  auto it = m_services.find(service_name);
+  if (it == m_services.end()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
+void
+dunedaq::utilities::add_resolver_backend(std::shared_ptr<ResolverBackend> backend)
+{
+  auto& chain = get_backend_chain();
+  std::lock_guard<std::mutex> lk(chain.mutex);
+  auto backends = std::make_shared<backend_list_t>(*chain.backends);
+  backends->push_back(std::move(backend));
+  std::atomic_store(&chain.backends, std::shared_ptr<const backend_list_t>(std::move(backends)));
+}
+
+void
+dunedaq::utilities::remove_resolver_backend(std::shared_ptr<ResolverBackend> const& backend)
+{
+  auto& chain = get_backend_chain();
+  std::lock_guard<std::mutex> lk(chain.mutex);
+  auto backends = std::make_shared<backend_list_t>(*chain.backends);
+  backends->erase(std::remove(backends->begin(), backends->end(), backend), backends->end());
+  std::atomic_store(&chain.backends, std::shared_ptr<const backend_list_t>(std::move(backends)));
+}
+
+void
+dunedaq::utilities::clear_resolver_backends()
+{
+  auto& chain = get_backend_chain();
+  std::lock_guard<std::mutex> lk(chain.mutex);
+  std::atomic_store(&chain.backends, std::make_shared<const backend_list_t>());
+}
+
+std::shared_ptr<const std::vector<std::shared_ptr<dunedaq::utilities::ResolverBackend>>>
+dunedaq::utilities::get_resolver_backends()
+{
+  return std::atomic_load(&get_backend_chain().backends);
+}
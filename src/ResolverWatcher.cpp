@@ -0,0 +1,207 @@
+/**
+ *
+ * @file ResolverWatcher.cpp Background re-resolution of names and services
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/ResolverWatcher.hpp"
+#include "utilities/Resolver.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <optional>
+#include <string>
+#include <utility>
+
+namespace {
+
+bool
+same_endpoints(std::vector<dunedaq::utilities::Endpoint> const& a, std::vector<dunedaq::utilities::Endpoint> const& b)
+{
+  return a.size() == b.size() && std::is_permutation(a.begin(), a.end(), b.begin());
+}
+
+} // namespace
+
+dunedaq::utilities::ResolverWatcher::ResolverWatcher(std::chrono::milliseconds min_interval,
+                                                     std::chrono::milliseconds max_interval)
+  : m_min_interval(min_interval)
+  , m_max_interval(std::max(min_interval, max_interval))
+  , m_thread(std::bind(&ResolverWatcher::run, this, std::placeholders::_1))
+{
+  m_thread.start_working_thread("resolver-watch");
+}
+
+dunedaq::utilities::ResolverWatcher::~ResolverWatcher()
+{
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_stopping = true;
+  }
+  m_cv.notify_all();
+  m_thread.stop_working_thread();
+}
+
+size_t
+dunedaq::utilities::ResolverWatcher::watch_uri(std::string const& connection_string, callback_t callback)
+{
+  auto uri = parse_connection_string_view(connection_string);
+  if (uri.scheme != "tcp") {
+    throw InvalidUri(ERS_HERE, connection_string);
+  }
+
+  Watch watch;
+  watch.kind = Kind::kUri;
+  watch.name = connection_string;
+  watch.callback = std::move(callback);
+  return add_watch(std::move(watch));
+}
+
+size_t
+dunedaq::utilities::ResolverWatcher::watch_service(std::string const& service_name,
+                                                   std::string const& hostname,
+                                                   callback_t callback)
+{
+  Watch watch;
+  watch.kind = Kind::kService;
+  watch.name = service_name;
+  watch.hostname = hostname;
+  watch.callback = std::move(callback);
+  return add_watch(std::move(watch));
+}
+
+size_t
+dunedaq::utilities::ResolverWatcher::add_watch(Watch watch)
+{
+  size_t id = 0;
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    id = m_next_id++;
+    watch.next_refresh = std::chrono::steady_clock::now();
+    m_watches.emplace(id, std::move(watch));
+  }
+  m_cv.notify_all();
+  return id;
+}
+
+void
+dunedaq::utilities::ResolverWatcher::unwatch(size_t id)
+{
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_watches.erase(id);
+  }
+  // Wait for a callback in progress to finish
+  std::lock_guard<std::recursive_mutex> callback_lk(m_callback_mutex);
+}
+
+std::vector<dunedaq::utilities::Endpoint>
+dunedaq::utilities::ResolverWatcher::get_endpoints(size_t id) const
+{
+  std::lock_guard<std::mutex> lk(m_mutex);
+  auto it = m_watches.find(id);
+  return it == m_watches.end() ? std::vector<Endpoint>() : it->second.endpoints;
+}
+
+size_t
+dunedaq::utilities::ResolverWatcher::get_num_watched() const
+{
+  std::lock_guard<std::mutex> lk(m_mutex);
+  return m_watches.size();
+}
+
+std::chrono::milliseconds
+dunedaq::utilities::ResolverWatcher::clamp_interval(std::chrono::milliseconds interval) const
+{
+  return std::clamp(interval, m_min_interval, m_max_interval);
+}
+
+void
+dunedaq::utilities::ResolverWatcher::refresh(size_t id, Watch watch)
+{
+  std::optional<std::vector<Endpoint>> endpoints;
+  auto interval = get_resolver_negative_ttl();
+
+  try {
+    if (watch.kind == Kind::kUri) {
+      endpoints = refresh_uri_endpoints(watch.name);
+      if (endpoints && !endpoints->empty()) {
+        interval = get_hostname_cache().get_max_age();
+      }
+    } else {
+      auto records = refresh_service_records(watch.name, watch.hostname);
+      if (records) {
+        uint32_t min_ttl = std::numeric_limits<uint32_t>::max(); // NOLINT(build/unsigned)
+        endpoints.emplace();
+        for (auto& record : *records) {
+          min_ttl = std::min(min_ttl, record.ttl);
+          endpoints->insert(endpoints->end(), record.endpoints.begin(), record.endpoints.end());
+        }
+        if (!endpoints->empty()) {
+          interval = std::chrono::seconds(min_ttl);
+        }
+      }
+    }
+  } catch (ers::Issue const& issue) {
+    ers::error(issue);
+  }
+  TLOG_DEBUG(15) << "Refreshed " << watch.name << ": "
+                 << (endpoints ? std::to_string(endpoints->size()) + " endpoints" : std::string("lookup failed"))
+                 << ", next refresh in " << clamp_interval(interval).count() << " ms";
+
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    auto it = m_watches.find(id);
+    if (it == m_watches.end()) {
+      return;
+    }
+    it->second.next_refresh = std::chrono::steady_clock::now() + clamp_interval(interval);
+    // Keep the previous endpoints when the lookup fails
+    if (!endpoints || same_endpoints(it->second.endpoints, *endpoints)) {
+      return;
+    }
+    it->second.endpoints = *endpoints;
+  }
+
+  std::lock_guard<std::recursive_mutex> callback_lk(m_callback_mutex);
+  {
+    // Don't call back after unwatch()
+    std::lock_guard<std::mutex> lk(m_mutex);
+    if (m_watches.count(id) == 0) {
+      return;
+    }
+  }
+  watch.callback(*endpoints);
+}
+
+void
+dunedaq::utilities::ResolverWatcher::run(std::atomic<bool>& running_flag)
+{
+  std::unique_lock<std::mutex> lk(m_mutex);
+  while (running_flag.load() && !m_stopping) {
+    auto due = m_watches.end();
+    for (auto it = m_watches.begin(); it != m_watches.end(); ++it) {
+      if (due == m_watches.end() || it->second.next_refresh < due->second.next_refresh) {
+        due = it;
+      }
+    }
+    if (due == m_watches.end()) {
+      m_cv.wait(lk);
+      continue;
+    }
+    if (due->second.next_refresh > std::chrono::steady_clock::now()) {
+      m_cv.wait_until(lk, due->second.next_refresh);
+      continue;
+    }
+
+    auto id = due->first;
+    auto watch = due->second;
+    due->second.next_refresh = std::chrono::steady_clock::time_point::max();
+    lk.unlock();
+    refresh(id, std::move(watch));
+    lk.lock();
+  }
+}
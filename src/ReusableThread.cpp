@@ -11,12 +11,38 @@
 
 #include "utilities/ReusableThread.hpp"
 
+#include "utilities/LatencyHistogram.hpp"
+#include "utilities/Metrics.hpp"
+
+namespace {
+
+struct ReusableThreadMetrics
+{
+  dunedaq::utilities::Counter tasks_assigned{ dunedaq::utilities::get_counter("reusable_thread.tasks_assigned") };
+  dunedaq::utilities::Counter tasks_rejected{ dunedaq::utilities::get_counter("reusable_thread.tasks_rejected") };
+  dunedaq::utilities::Counter tasks_completed{ dunedaq::utilities::get_counter("reusable_thread.tasks_completed") };
+  dunedaq::utilities::LatencyHistogram& task_time{ dunedaq::utilities::get_latency_histogram(
+    "reusable_thread.task_time") };
+  dunedaq::utilities::LatencyHistogram& batch_time{ dunedaq::utilities::get_latency_histogram(
+    "reusable_thread.batch_time") };
+};
+
+ReusableThreadMetrics&
+get_metrics()
+{
+  static ReusableThreadMetrics s_metrics;
+  return s_metrics;
+}
+
+} // namespace
+
 dunedaq::utilities::ReusableThread::ReusableThread(int threadid)
   : m_thread_id(threadid)
   , m_task_executed(true)
   , m_task_assigned(false)
   , m_thread_quit(false)
   , m_worker_done(false)
+  , m_batch_open(false)
   , m_thread(&ReusableThread::thread_worker, this)
 {}
 
@@ -50,9 +76,21 @@ dunedaq::utilities::ReusableThread::thread_worker()
 
   while (!m_thread_quit) {
     if (!m_task_executed && m_task_assigned) {
-      m_task();
-      m_task_executed = true;
+      // The flags are only checked with m_mtx held, so the tasks need not hold it
+      lock.unlock();
+      if (m_task) {
+        {
+          LatencyTimer timer(get_metrics().task_time);
+          m_task();
+        }
+        get_metrics().tasks_completed.increment();
+      } else {
+        run_batch();
+      }
+      lock.lock();
+      // Cleared first, so that a caller which sees readiness can assign the next task
       m_task_assigned = false;
+      m_task_executed = true;
     } else {
       m_cv.wait(lock);
     }
@@ -60,3 +98,79 @@ dunedaq::utilities::ReusableThread::thread_worker()
 
   m_worker_done = true;
 }
+
+bool
+dunedaq::utilities::ReusableThread::set_work_batch(std::vector<std::function<void()>>& tasks)
+{
+  if (!m_task_assigned && m_task_executed.exchange(false)) {
+    {
+      std::lock_guard<std::mutex> lk(m_batch_mtx);
+      m_batch.swap(tasks);
+      m_batch_open = true;
+    }
+    tasks.clear();
+    m_task = nullptr;
+    m_task_assigned = true;
+    wake_worker();
+    count_assignment(true);
+    return true;
+  }
+  count_assignment(false);
+  return false;
+}
+
+bool
+dunedaq::utilities::ReusableThread::append_work(std::function<void()> task)
+{
+  std::lock_guard<std::mutex> lk(m_batch_mtx);
+  if (!m_batch_open) {
+    return false;
+  }
+  m_batch.push_back(std::move(task));
+  return true;
+}
+
+void
+dunedaq::utilities::ReusableThread::run_batch()
+{
+  LatencyTimer timer(get_metrics().batch_time);
+  std::vector<std::function<void()>> tasks;
+  while (true) {
+    {
+      // The batch closes once the worker finds nothing more to run, so
+      // a task is never appended after the batch completes
+      std::lock_guard<std::mutex> lk(m_batch_mtx);
+      if (m_batch.empty()) {
+        m_batch_open = false;
+        // Keep the storage, which set_work_batch hands back with the next batch
+        m_batch.swap(tasks);
+        return;
+      }
+      tasks.swap(m_batch);
+    }
+    for (auto& task : tasks) {
+      task();
+    }
+    get_metrics().tasks_completed.increment(tasks.size());
+    tasks.clear();
+  }
+}
+
+void
+dunedaq::utilities::ReusableThread::wake_worker()
+{
+  // The worker checks the flags and waits with m_mtx held, so taking it
+  // here means it either sees the new task or is already waiting
+  { std::lock_guard<std::mutex> lk(m_mtx); }
+  m_cv.notify_all();
+}
+
+void
+dunedaq::utilities::ReusableThread::count_assignment(bool accepted)
+{
+  if (accepted) {
+    get_metrics().tasks_assigned.increment();
+  } else {
+    get_metrics().tasks_rejected.increment();
+  }
+}
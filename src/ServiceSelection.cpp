@@ -0,0 +1,186 @@
+/**
+ *
+ * @file ServiceSelection.cpp Choosing among the SRV records of a service
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/ServiceSelection.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+
+namespace {
+
+using dunedaq::utilities::ServiceRecord;
+
+std::mt19937_64&
+get_thread_rng()
+{
+  thread_local std::mt19937_64 s_rng(std::random_device{}());
+  return s_rng;
+}
+
+/**
+ * @brief Indices of the usable records with the best (lowest) priority
+ */
+std::vector<size_t>
+best_priority_group(std::vector<ServiceRecord> const& records)
+{
+  std::vector<size_t> group;
+  for (size_t i = 0; i < records.size(); ++i) {
+    if (records[i].endpoints.empty()) {
+      continue;
+    }
+    if (!group.empty() && records[i].priority < records[group[0]].priority) {
+      group.clear();
+    }
+    if (group.empty() || records[i].priority == records[group[0]].priority) {
+      group.push_back(i);
+    }
+  }
+  return group;
+}
+
+/**
+ * @brief The RFC 2782 weighted selection step: pick a record with
+ * probability proportional to its weight. Unlike the RFC's literal
+ * algorithm (a random number in [0, total weight] inclusive), this is
+ * exactly proportional; records of weight zero are chosen, uniformly,
+ * only once no record with a non-zero weight remains.
+ * @return The position in group of the chosen record
+ */
+size_t
+weighted_pick(std::vector<ServiceRecord> const& records, std::vector<size_t> const& group, std::mt19937_64& rng)
+{
+  uint32_t total = 0; // NOLINT(build/unsigned)
+  for (auto i : group) {
+    total += records[i].weight;
+  }
+  if (total == 0) {
+    return std::uniform_int_distribution<size_t>(0, group.size() - 1)(rng);
+  }
+
+  auto target = std::uniform_int_distribution<uint32_t>(0, total - 1)(rng); // NOLINT(build/unsigned)
+  uint32_t running = 0;                                                     // NOLINT(build/unsigned)
+  for (size_t pos = 0; pos < group.size(); ++pos) {
+    running += records[group[pos]].weight;
+    if (running > target) {
+      return pos;
+    }
+  }
+  return group.size() - 1;
+}
+
+/**
+ * @brief 64-bit FNV-1a, continuing from hash. Stable across hosts and builds,
+ * unlike std::hash
+ */
+uint64_t // NOLINT(build/unsigned)
+fnv1a(std::string const& data, uint64_t hash = 14695981039346656037ULL) // NOLINT(build/unsigned)
+{
+  for (unsigned char c : data) {
+    hash ^= c;
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+/**
+ * @brief Map a hash to a uniformly-distributed double in (0, 1)
+ */
+double
+to_unit_interval(uint64_t hash) // NOLINT(build/unsigned)
+{
+  // splitmix64 finaliser, to spread FNV's weak low bits
+  hash ^= hash >> 30;
+  hash *= 0xbf58476d1ce4e5b9ULL;
+  hash ^= hash >> 27;
+  hash *= 0x94d049bb133111ebULL;
+  hash ^= hash >> 31;
+  return (static_cast<double>(hash >> 11) + 0.5) / 9007199254740992.0; // 2^53
+}
+
+} // namespace
+
+std::vector<dunedaq::utilities::ServiceRecord>
+dunedaq::utilities::order_service_records(std::vector<ServiceRecord> records, std::mt19937_64& rng)
+{
+  records.erase(std::remove_if(records.begin(), records.end(), [](ServiceRecord const& r) { return r.endpoints.empty(); }),
+                records.end());
+  std::stable_sort(records.begin(), records.end(), [](ServiceRecord const& a, ServiceRecord const& b) {
+    return a.priority < b.priority;
+  });
+
+  std::vector<ServiceRecord> output;
+  output.reserve(records.size());
+  for (size_t begin = 0; begin < records.size();) {
+    auto end = begin;
+    while (end < records.size() && records[end].priority == records[begin].priority) {
+      ++end;
+    }
+    std::vector<size_t> group(end - begin);
+    std::iota(group.begin(), group.end(), begin);
+    while (!group.empty()) {
+      auto pos = weighted_pick(records, group, rng);
+      output.push_back(std::move(records[group[pos]]));
+      group.erase(group.begin() + pos);
+    }
+    begin = end;
+  }
+  return output;
+}
+
+std::vector<dunedaq::utilities::ServiceRecord>
+dunedaq::utilities::order_service_records(std::vector<ServiceRecord> records)
+{
+  return order_service_records(std::move(records), get_thread_rng());
+}
+
+const dunedaq::utilities::ServiceRecord*
+dunedaq::utilities::select_service_record(std::vector<ServiceRecord> const& records, std::mt19937_64& rng)
+{
+  auto group = best_priority_group(records);
+  if (group.empty()) {
+    return nullptr;
+  }
+  return &records[group[weighted_pick(records, group, rng)]];
+}
+
+const dunedaq::utilities::ServiceRecord*
+dunedaq::utilities::select_service_record(std::vector<ServiceRecord> const& records)
+{
+  return select_service_record(records, get_thread_rng());
+}
+
+const dunedaq::utilities::ServiceRecord*
+dunedaq::utilities::select_service_record(std::vector<ServiceRecord> const& records, std::string const& client_key)
+{
+  auto group = best_priority_group(records);
+  if (group.empty()) {
+    return nullptr;
+  }
+  bool all_zero = std::all_of(group.begin(), group.end(), [&](size_t i) { return records[i].weight == 0; });
+
+  const ServiceRecord* best = nullptr;
+  double best_score = -1;
+  // Hash of the key and a separator; each record's hash continues from it
+  auto key_hash = fnv1a(client_key + '\0');
+  for (auto i : group) {
+    auto& record = records[i];
+    double weight = all_zero ? 1. : record.weight;
+    auto hash = fnv1a(record.target + ":" + std::to_string(record.port), key_hash);
+    // Weighted rendezvous hashing: score = -w / ln(u), u uniform in (0, 1)
+    double score = weight / -std::log(to_unit_interval(hash));
+    if (score > best_score) {
+      best_score = score;
+      best = &record;
+    }
+  }
+  return best;
+}
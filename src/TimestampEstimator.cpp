@@ -8,23 +8,51 @@
 
 #include "utilities/TimestampEstimator.hpp"
 #include "utilities/Issues.hpp"
+#include "utilities/Metrics.hpp"
 
 #include "logging/Logging.hpp"
 
+#include <iomanip>
+#include <limits>
 #include <memory>
+#include <utility>
 
 #define TRACE_NAME "TimestampEstimator" // NOLINT
 
+namespace {
+
+struct TimestampEstimatorMetrics
+{
+  dunedaq::utilities::Counter datapoints{ dunedaq::utilities::get_counter("timestamp_estimator.datapoints") };
+  dunedaq::utilities::Counter estimate_updates{ dunedaq::utilities::get_counter(
+    "timestamp_estimator.estimate_updates") };
+  dunedaq::utilities::Counter early_timesyncs{ dunedaq::utilities::get_counter("timestamp_estimator.early_timesyncs") };
+  dunedaq::utilities::Counter late_timesyncs{ dunedaq::utilities::get_counter("timestamp_estimator.late_timesyncs") };
+};
+
+TimestampEstimatorMetrics&
+get_metrics()
+{
+  static TimestampEstimatorMetrics s_metrics;
+  return s_metrics;
+}
+
+} // namespace
+
 namespace dunedaq {
 namespace utilities {
-TimestampEstimator::TimestampEstimator(uint32_t run_number, uint64_t clock_frequency_hz) // NOLINT(build/unsigned)
-  : TimestampEstimator(clock_frequency_hz)
+TimestampEstimator::TimestampEstimator(uint32_t run_number,
+                                       uint64_t clock_frequency_hz, // NOLINT(build/unsigned)
+                                       std::shared_ptr<Clock> clock)
+  : TimestampEstimator(clock_frequency_hz, std::move(clock))
 {
   m_run_number = run_number;
 }
 
-TimestampEstimator::TimestampEstimator(uint64_t clock_frequency_hz) // NOLINT(build/unsigned)
-  : m_current_timestamp_estimate(std::numeric_limits<uint64_t>::max())
+TimestampEstimator::TimestampEstimator(uint64_t clock_frequency_hz, // NOLINT(build/unsigned)
+                                       std::shared_ptr<Clock> clock)
+  : TimestampEstimatorBase(std::move(clock))
+  , m_current_timestamp_estimate(std::numeric_limits<uint64_t>::max())
   , m_clock_frequency_hz(clock_frequency_hz)
   , m_most_recent_daq_time(0)
   , m_most_recent_system_time(0)
@@ -39,8 +67,16 @@ TimestampEstimator::~TimestampEstimator()
 
 void
 TimestampEstimator::add_timestamp_datapoint(uint64_t daq_time, uint64_t system_time)
+{
+  update_timestamp_estimate(daq_time, system_time);
+  notify_update_callbacks();
+}
+
+void
+TimestampEstimator::update_timestamp_estimate(uint64_t daq_time, uint64_t system_time)
 {
   std::scoped_lock<std::mutex> lk(m_datapoint_mutex);
+  get_metrics().datapoints.increment();
 
   // First, update the latest timestamp
   uint64_t estimate = m_current_timestamp_estimate.load();
@@ -57,10 +93,7 @@ TimestampEstimator::add_timestamp_datapoint(uint64_t daq_time, uint64_t system_t
 
   if (m_most_recent_daq_time != std::numeric_limits<uint64_t>::max()) {
     // Update the current timestamp estimate, based on the most recently-read TimeSync
-    using namespace std::chrono;
-
-    auto time_now =
-      static_cast<uint64_t>(duration_cast<microseconds>(system_clock::now().time_since_epoch()).count()); // NOLINT
+    auto time_now = get_clock()->now_us();
 
     // (PAR 2021-07-22) We only want to _increase_ our timestamp
     // estimate, not _decrease_ it, so we only attempt the update if
@@ -71,6 +104,7 @@ TimestampEstimator::add_timestamp_datapoint(uint64_t daq_time, uint64_t system_t
     // is large, then badness could happen, so emit a warning
 
     if (time_now < m_most_recent_system_time - 10000) {
+      get_metrics().early_timesyncs.increment();
       ers::warning(EarlyTimeSync(ERS_HERE, m_most_recent_system_time - time_now));
     }
 
@@ -82,8 +116,10 @@ TimestampEstimator::add_timestamp_datapoint(uint64_t daq_time, uint64_t system_t
 
       // Warn user if current system time is more than 1s ahead of latest TimeSync system time. This could be a sign of
       // an issue, e.g. machine times out of sync
-      if (delta_time > 1e6)
+      if (delta_time > 1e6) {
+        get_metrics().late_timesyncs.increment();
         ers::warning(LateTimeSync(ERS_HERE, delta_time));
+      }
 
       const uint64_t new_timestamp =
         m_most_recent_daq_time + delta_time * m_clock_frequency_hz / 1000000;
@@ -102,6 +138,7 @@ TimestampEstimator::add_timestamp_datapoint(uint64_t daq_time, uint64_t system_t
               static_cast<double>(m_clock_frequency_hz))
           << " sec), delta_time is " << delta_time << " usec, clock_freq is " << m_clock_frequency_hz << " Hz";
         m_current_timestamp_estimate.store(new_timestamp);
+        get_metrics().estimate_updates.increment();
       } else {
         TLOG_DEBUG(TLVL_TIME_SYNC_NOTES) << "Not updating timestamp estimate backwards from "
                                          << m_current_timestamp_estimate.load() << " to " << new_timestamp;
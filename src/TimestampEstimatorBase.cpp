@@ -8,39 +8,170 @@
 
 #include "utilities/TimestampEstimatorBase.hpp"
 
-#include <thread>
+#include "utilities/Metrics.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+namespace {
+
+struct WaitMetrics
+{
+  dunedaq::utilities::Counter finished{ dunedaq::utilities::get_counter("timestamp_estimator.waits_finished") };
+  dunedaq::utilities::Counter timed_out{ dunedaq::utilities::get_counter("timestamp_estimator.waits_timed_out") };
+  dunedaq::utilities::Counter interrupted{ dunedaq::utilities::get_counter("timestamp_estimator.waits_interrupted") };
+};
+
+WaitMetrics&
+get_metrics()
+{
+  static WaitMetrics s_metrics;
+  return s_metrics;
+}
+
+} // namespace
 
 namespace dunedaq {
 namespace utilities {
+TimestampEstimatorBase::TimestampEstimatorBase()
+  : TimestampEstimatorBase(nullptr)
+{
+}
+
+TimestampEstimatorBase::TimestampEstimatorBase(std::shared_ptr<Clock> clock)
+  : m_clock(clock ? std::move(clock) : get_system_clock())
+{
+}
+
 TimestampEstimatorBase::WaitStatus
 TimestampEstimatorBase::wait_for_valid_timestamp(std::atomic<bool>& continue_flag)
 {
-  if (!continue_flag.load())
-    return TimestampEstimatorBase::kInterrupted;
+  return wait_for_valid_timestamp(continue_flag, Clock::time_point::max(), WaitPolicy::sleeping());
+}
 
-  while (continue_flag.load() && get_timestamp_estimate() == std::numeric_limits<uint64_t>::max()) {
-    std::this_thread::sleep_for(std::chrono::milliseconds(10));
-    if (!continue_flag.load())
-      return TimestampEstimatorBase::kInterrupted;
-  }
+TimestampEstimatorBase::WaitStatus
+TimestampEstimatorBase::wait_for_timestamp(uint64_t ts, std::atomic<bool>& continue_flag)
+{
+  return wait_for_timestamp(ts, continue_flag, Clock::time_point::max(), WaitPolicy::sleeping());
+}
 
-  return TimestampEstimatorBase::kFinished;
+TimestampEstimatorBase::WaitStatus
+TimestampEstimatorBase::wait_for_valid_timestamp(std::atomic<bool>& continue_flag,
+                                                 Clock::time_point deadline,
+                                                 const WaitPolicy& policy)
+{
+  return wait_for_timestamp(0, continue_flag, deadline, policy);
 }
 
 TimestampEstimatorBase::WaitStatus
-TimestampEstimatorBase::wait_for_timestamp(uint64_t ts, std::atomic<bool>& continue_flag)
+TimestampEstimatorBase::wait_for_timestamp(uint64_t ts,
+                                           std::atomic<bool>& continue_flag,
+                                           Clock::time_point deadline,
+                                           const WaitPolicy& policy)
 {
-  if (!continue_flag.load())
-    return TimestampEstimatorBase::kInterrupted;
+  const auto busy_threshold = std::max(policy.spin_threshold, policy.yield_threshold);
 
-  while (continue_flag.load() &&
-         (get_timestamp_estimate() < ts || get_timestamp_estimate() == std::numeric_limits<uint64_t>::max())) {
-    std::this_thread::sleep_for(std::chrono::milliseconds(10));
-    if (!continue_flag.load())
+  while (true) {
+    if (!continue_flag.load()) {
+      get_metrics().interrupted.increment();
       return TimestampEstimatorBase::kInterrupted;
+    }
+
+    auto estimate = get_timestamp_estimate();
+    bool valid = estimate != std::numeric_limits<uint64_t>::max();
+    if (valid && estimate >= ts) {
+      get_metrics().finished.increment();
+      return TimestampEstimatorBase::kFinished;
+    }
+
+    auto now = m_clock->now();
+    if (now >= deadline) {
+      get_metrics().timed_out.increment();
+      return TimestampEstimatorBase::kTimedOut;
+    }
+
+    // How long until we expect the wait to end: at the deadline, or
+    // when the estimate reaches ts, if we can predict that
+    auto remaining = deadline - now;
+    if (valid) {
+      auto to_target = predict_time_to_timestamp(ts);
+      if (to_target) {
+        remaining = std::min(remaining, *to_target);
+      }
+    }
+
+    if (remaining <= policy.spin_threshold) {
+      m_clock->pause();
+    } else if (remaining <= policy.yield_threshold) {
+      m_clock->yield();
+    } else {
+      m_clock->sleep_for(std::min(remaining - busy_threshold, policy.max_sleep));
+    }
+  }
+}
+
+size_t
+TimestampEstimatorBase::add_update_callback(std::function<void()> callback)
+{
+  std::lock_guard<std::mutex> lk(m_update_callbacks_mutex);
+  auto id = m_next_update_callback_id++;
+  m_update_callbacks[id] = std::make_shared<UpdateCallback>(UpdateCallback{ std::move(callback) });
+  m_num_update_callbacks = m_update_callbacks.size();
+  return id;
+}
+
+void
+TimestampEstimatorBase::remove_update_callback(size_t id)
+{
+  std::unique_lock<std::mutex> lk(m_update_callbacks_mutex);
+  auto it = m_update_callbacks.find(id);
+  if (it == m_update_callbacks.end())
+    return;
+  auto callback = std::move(it->second);
+  m_update_callbacks.erase(it);
+  m_num_update_callbacks = m_update_callbacks.size();
+
+  // Wait for other threads which are running the callback, unless this
+  // thread is running callbacks itself: a thread it waits for could be
+  // waiting for it in turn
+  auto self = std::this_thread::get_id();
+  if (std::find(m_notifying_threads.begin(), m_notifying_threads.end(), self) != m_notifying_threads.end())
+    return;
+  m_update_callbacks_cv.wait(lk, [&] { return callback->num_running == 0; });
+}
+
+void
+TimestampEstimatorBase::notify_update_callbacks()
+{
+  // Avoid taking the lock on the update path when nobody is listening
+  if (m_num_update_callbacks.load() == 0)
+    return;
+
+  // The callbacks are called without the lock held, so that they may
+  // add and remove callbacks, or resume code which does
+  std::vector<std::pair<size_t, std::shared_ptr<UpdateCallback>>> callbacks;
+  std::unique_lock<std::mutex> lk(m_update_callbacks_mutex);
+  callbacks.assign(m_update_callbacks.begin(), m_update_callbacks.end());
+  m_notifying_threads.push_back(std::this_thread::get_id());
+
+  for (auto& [id, callback] : callbacks) {
+    // Skip callbacks removed by an earlier callback
+    if (m_update_callbacks.count(id) == 0)
+      continue;
+    ++callback->num_running;
+    lk.unlock();
+    callback->function();
+    lk.lock();
+    --callback->num_running;
+    if (callback->num_running == 0 && m_update_callbacks.count(id) == 0) {
+      // Removed while running
+      m_update_callbacks_cv.notify_all();
+    }
   }
 
-  return TimestampEstimatorBase::kFinished;
+  m_notifying_threads.erase(
+    std::find(m_notifying_threads.begin(), m_notifying_threads.end(), std::this_thread::get_id()));
 }
 
 } // namespace utilities
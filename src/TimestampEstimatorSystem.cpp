@@ -10,13 +10,16 @@
 
 #include "logging/Logging.hpp"
 
-#include <chrono>
+#include <algorithm>
+#include <utility>
 
 namespace dunedaq {
 namespace utilities {
 
-TimestampEstimatorSystem::TimestampEstimatorSystem(uint64_t clock_frequency_hz) // NOLINT(build/unsigned)
-  : m_clock_frequency_hz(clock_frequency_hz)
+TimestampEstimatorSystem::TimestampEstimatorSystem(uint64_t clock_frequency_hz, // NOLINT(build/unsigned)
+                                                   std::shared_ptr<Clock> clock)
+  : TimestampEstimatorBase(std::move(clock))
+  , m_clock_frequency_hz(clock_frequency_hz)
 {
   TLOG_DEBUG(0) << "Clock frequency is " << m_clock_frequency_hz
                 << " clock_frequency_hz/1000000.=" << (m_clock_frequency_hz / 1000000.);
@@ -25,9 +28,19 @@ TimestampEstimatorSystem::TimestampEstimatorSystem(uint64_t clock_frequency_hz)
 uint64_t
 TimestampEstimatorSystem::get_timestamp_estimate() const
 {
-  auto now = std::chrono::system_clock::now().time_since_epoch();
-  auto now_us = std::chrono::duration_cast<std::chrono::microseconds>(now);
-  return (m_clock_frequency_hz / 1000000.) * now_us.count();
+  return (m_clock_frequency_hz / 1000000.) * get_clock()->now_us();
+}
+
+std::optional<Clock::duration>
+TimestampEstimatorSystem::predict_time_to_timestamp(uint64_t ts) const
+{
+  auto estimate = get_timestamp_estimate();
+  if (ts <= estimate) {
+    return Clock::duration::zero();
+  }
+  // Clamp to ~30 years, so that the conversion can't overflow
+  auto us = std::min((ts - estimate) * (1000000. / m_clock_frequency_hz), 1e15);
+  return Clock::duration(static_cast<int64_t>(us));
 }
 
 } // namespace utilities
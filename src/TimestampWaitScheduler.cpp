@@ -0,0 +1,165 @@
+/**
+ * @file TimestampWaitScheduler.cpp
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/TimestampWaitScheduler.hpp"
+
+#include "utilities/Issues.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace dunedaq {
+namespace utilities {
+
+TimestampWaitScheduler::TimestampWaitScheduler(TimestampEstimatorBase& estimator, Clock::duration poll_interval)
+  : m_estimator(estimator)
+  , m_poll_interval(poll_interval)
+  , m_update_callback_id(0)
+  , m_timer(std::bind(&TimestampWaitScheduler::run_timer, this, std::placeholders::_1))
+{
+  // The timer would spin, pushing simulated time forward as fast as it can
+  if (m_poll_interval.count() > 0 && m_estimator.get_clock()->advances_on_sleep()) {
+    throw InvalidSchedulerConfiguration(ERS_HERE, "the timer can't run on a clock which advances when slept on");
+  }
+
+  m_update_callback_id = m_estimator.add_update_callback([this] { poll(); });
+  if (m_poll_interval.count() > 0) {
+    m_timer.start_working_thread("tswait-timer");
+  }
+}
+
+TimestampWaitScheduler::~TimestampWaitScheduler()
+{
+  if (m_timer.thread_running()) {
+    m_timer.stop_working_thread();
+  }
+  m_estimator.remove_update_callback(m_update_callback_id);
+
+  std::multimap<uint64_t, Waiter> remaining; // NOLINT(build/unsigned)
+  {
+    std::lock_guard<std::mutex> lk(m_waiters_mutex);
+    remaining.swap(m_waiters);
+    m_continue_flags.clear();
+  }
+  for (auto& [ts, waiter] : remaining) {
+    waiter.callback(TimestampEstimatorBase::kInterrupted);
+  }
+}
+
+void
+TimestampWaitScheduler::async_wait_for_valid_timestamp(std::atomic<bool>& continue_flag, callback_t callback)
+{
+  async_wait_for_timestamp(0, continue_flag, std::move(callback));
+}
+
+void
+TimestampWaitScheduler::async_wait_for_timestamp(uint64_t ts, std::atomic<bool>& continue_flag, callback_t callback)
+{
+  WaitStatus status;
+  {
+    // Checking the estimate with the lock held means that an update
+    // racing with this call is either seen here, or by the poll() that
+    // the update triggers
+    std::lock_guard<std::mutex> lk(m_waiters_mutex);
+    if (!continue_flag.load()) {
+      status = TimestampEstimatorBase::kInterrupted;
+    } else if (is_reached(m_estimator.get_timestamp_estimate(), ts)) {
+      status = TimestampEstimatorBase::kFinished;
+    } else {
+      m_waiters.emplace(ts, Waiter{ &continue_flag, std::move(callback) });
+      ++m_continue_flags[&continue_flag];
+      return;
+    }
+  }
+  callback(status);
+}
+
+void
+TimestampWaitScheduler::poll()
+{
+  std::vector<std::pair<callback_t, WaitStatus>> completed;
+  {
+    std::lock_guard<std::mutex> lk(m_waiters_mutex);
+    if (m_waiters.empty())
+      return;
+
+    // As in the blocking waits, an interrupted wait reports
+    // kInterrupted even if its timestamp has also been reached, so
+    // interrupted waits are taken first. Their flags are checked once
+    // each, and the table is only scanned when one has been cleared
+    std::vector<std::atomic<bool>*> cleared_flags;
+    for (auto& [flag, count] : m_continue_flags) {
+      if (!flag->load()) {
+        cleared_flags.push_back(flag);
+      }
+    }
+    if (!cleared_flags.empty()) {
+      for (auto it = m_waiters.begin(); it != m_waiters.end();) {
+        auto flag = it->second.continue_flag;
+        if (std::find(cleared_flags.begin(), cleared_flags.end(), flag) != cleared_flags.end()) {
+          completed.emplace_back(std::move(it->second.callback), TimestampEstimatorBase::kInterrupted);
+          it = erase_waiter(it);
+        } else {
+          ++it;
+        }
+      }
+    }
+
+    // The table is ordered by timestamp, so the reached waits are at its start
+    auto estimate = m_estimator.get_timestamp_estimate();
+    if (estimate != std::numeric_limits<uint64_t>::max()) {
+      auto reached_end = m_waiters.upper_bound(estimate);
+      for (auto it = m_waiters.begin(); it != reached_end;) {
+        completed.emplace_back(std::move(it->second.callback), TimestampEstimatorBase::kFinished);
+        it = erase_waiter(it);
+      }
+    }
+  }
+
+  for (auto& [callback, status] : completed) {
+    callback(status);
+  }
+}
+
+size_t
+TimestampWaitScheduler::get_num_pending() const
+{
+  std::lock_guard<std::mutex> lk(m_waiters_mutex);
+  return m_waiters.size();
+}
+
+std::multimap<uint64_t, TimestampWaitScheduler::Waiter>::iterator // NOLINT(build/unsigned)
+TimestampWaitScheduler::erase_waiter(std::multimap<uint64_t, Waiter>::iterator it) // NOLINT(build/unsigned)
+{
+  auto flag = m_continue_flags.find(it->second.continue_flag);
+  if (--flag->second == 0) {
+    m_continue_flags.erase(flag);
+  }
+  return m_waiters.erase(it);
+}
+
+bool
+TimestampWaitScheduler::is_reached(uint64_t estimate, uint64_t ts) const
+{
+  return estimate != std::numeric_limits<uint64_t>::max() && estimate >= ts;
+}
+
+void
+TimestampWaitScheduler::run_timer(std::atomic<bool>& running_flag)
+{
+  auto clock = m_estimator.get_clock();
+  while (running_flag.load()) {
+    poll();
+    clock->sleep_for(m_poll_interval);
+  }
+}
+
+} // namespace utilities
+} // namespace dunedaq
@@ -15,12 +15,100 @@
 
 #include "utilities/WorkerThread.hpp"
 
+#include "utilities/LatencyHistogram.hpp"
+#include "utilities/Metrics.hpp"
+
+#include "logging/Logging.hpp"
+
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <sstream>
+#include <utility>
+
+namespace {
+
+struct WorkerThreadMetrics
+{
+  dunedaq::utilities::Counter starts{ dunedaq::utilities::get_counter("worker_thread.starts") };
+  dunedaq::utilities::Counter stops{ dunedaq::utilities::get_counter("worker_thread.stops") };
+  dunedaq::utilities::Counter threads_created{ dunedaq::utilities::get_counter("worker_thread.threads_created") };
+  dunedaq::utilities::Counter stop_timeouts{ dunedaq::utilities::get_counter("worker_thread.stop_timeouts") };
+  dunedaq::utilities::Gauge running{ dunedaq::utilities::get_gauge("worker_thread.running") };
+  dunedaq::utilities::LatencyHistogram& stop_time{ dunedaq::utilities::get_latency_histogram(
+    "worker_thread.stop_time") };
+};
+
+WorkerThreadMetrics&
+get_metrics()
+{
+  static WorkerThreadMetrics s_metrics;
+  return s_metrics;
+}
+
+// Contents of a /proc file, or the reason it couldn't be read
+std::string
+read_proc_file(std::string const& path)
+{
+  std::ifstream file(path);
+  if (!file) {
+    return "<unavailable>";
+  }
+  std::ostringstream contents;
+  contents << file.rdbuf();
+  auto text = contents.str();
+  while (!text.empty() && text.back() == '\n') {
+    text.pop_back();
+  }
+  return text;
+}
+
+} // namespace
+
 dunedaq::utilities::WorkerThread::WorkerThread(std::function<void(std::atomic<bool>&)> do_work)
+  : WorkerThread(std::move(do_work), WorkerThreadOptions())
+{}
+
+dunedaq::utilities::WorkerThread::WorkerThread(std::function<void(std::atomic<bool>&)> do_work,
+                                               WorkerThreadOptions options)
   : m_thread_running(false)
   , m_working_thread(nullptr)
   , m_do_work(do_work)
+  , m_options(options)
+  , m_thread_tid(0)
+  , m_stop_pending(false)
+  , m_last_stop_latency(0)
+  , m_run_requested(false)
+  , m_run_done(false)
+  , m_quit_requested(false)
 {}
 
+dunedaq::utilities::WorkerThread::~WorkerThread()
+{
+  if (m_working_thread == nullptr || !m_working_thread->joinable() || thread_running()) {
+    return;
+  }
+
+  // do_work() still holds references to this object, so the thread can't be detached
+  bool stopping = thread_stopping();
+  if (stopping) {
+    ers::warning(ThreadingIssue(ERS_HERE,
+                                "Working thread " + m_thread_name +
+                                  " is being destroyed before it stopped, waiting for do_work() to return"));
+  }
+  {
+    std::lock_guard<std::mutex> lk(m_run_mutex);
+    m_quit_requested = true;
+  }
+  m_run_cv.notify_all();
+  m_working_thread->join();
+  if (stopping) {
+    get_metrics().stops.increment();
+    get_metrics().running.decrement();
+  }
+}
+
 void
 dunedaq::utilities::WorkerThread::start_working_thread(const std::string& name)
 {
@@ -29,8 +117,24 @@ dunedaq::utilities::WorkerThread::start_working_thread(const std::string& name)
                          "Attempted to start working thread "
                          "when it is already running!");
   }
+  if (thread_stopping()) {
+    throw ThreadingIssue(ERS_HERE,
+                         "Attempted to start working thread " + m_thread_name +
+                           " when it has not yet stopped!");
+  }
+  m_thread_name = name;
   m_thread_running = true;
-  m_working_thread.reset(new std::thread([&] { m_do_work(std::ref(m_thread_running)); }));
+  get_metrics().starts.increment();
+  get_metrics().running.increment();
+  {
+    std::lock_guard<std::mutex> lk(m_run_mutex);
+    m_run_requested = true;
+    m_run_done = false;
+  }
+  if (m_working_thread == nullptr || !m_options.park_between_runs) {
+    get_metrics().threads_created.increment();
+    m_working_thread.reset(new std::thread([this] { thread_main(); }));
+  }
   auto handle = m_working_thread->native_handle();
   auto rc = pthread_setname_np(handle, name.c_str());
   if (rc != 0) {
@@ -38,21 +142,58 @@ dunedaq::utilities::WorkerThread::start_working_thread(const std::string& name)
     s << "The name " << name << " provided for the thread is too long.";
     ers::warning(ThreadingIssue(ERS_HERE, s.str()));
   }
+  m_run_cv.notify_all();
 }
 
 void
 dunedaq::utilities::WorkerThread::stop_working_thread()
 {
-  if (!thread_running()) {
+  stop_working_thread(m_options.stop_timeout);
+}
+
+void
+dunedaq::utilities::WorkerThread::stop_working_thread(std::chrono::milliseconds timeout)
+{
+  if (!thread_running() && !thread_stopping()) {
     throw ThreadingIssue(ERS_HERE,
                          "Attempted to stop working thread "
                          "when it is not running!");
   }
-  m_thread_running = false;
+  if (!thread_stopping()) {
+    m_thread_running = false;
+    m_stop_requested_time = std::chrono::steady_clock::now();
+    m_stop_pending = true;
+  }
+
+  {
+    std::unique_lock<std::mutex> lk(m_run_mutex);
+    auto done = [&] { return m_run_done; };
+    if (timeout.count() == 0) {
+      m_run_cv.wait(lk, done);
+    } else if (!m_run_cv.wait_for(lk, timeout, done)) {
+      lk.unlock();
+      get_metrics().stop_timeouts.increment();
+      throw ThreadingIssue(ERS_HERE, describe_stuck_thread());
+    }
+  }
+
+  m_stop_pending = false;
+  m_last_stop_latency = std::chrono::steady_clock::now() - m_stop_requested_time;
+  get_metrics().stop_time.record(m_last_stop_latency);
+  TLOG_DEBUG(10) << "Working thread " << m_thread_name << " stopped in "
+                 << std::chrono::duration_cast<std::chrono::microseconds>(m_last_stop_latency).count() << " us";
+
+  if (m_options.park_between_runs) {
+    get_metrics().stops.increment();
+    get_metrics().running.decrement();
+    return;
+  }
 
   if (m_working_thread->joinable()) {
     try {
       m_working_thread->join();
+      get_metrics().stops.increment();
+      get_metrics().running.decrement();
     } catch (std::system_error const& e) {
       throw ThreadingIssue(ERS_HERE, std::string("Error while joining thread, ") + e.what());
     }
@@ -60,3 +201,41 @@ dunedaq::utilities::WorkerThread::stop_working_thread()
     throw ThreadingIssue(ERS_HERE, "Thread not in joinable state during working thread stop!");
   }
 }
+
+std::string
+dunedaq::utilities::WorkerThread::describe_stuck_thread() const
+{
+  auto elapsed = std::chrono::steady_clock::now() - m_stop_requested_time;
+  auto task_dir = "/proc/self/task/" + std::to_string(m_thread_tid.load()) + "/";
+
+  std::ostringstream s;
+  s << "Working thread " << m_thread_name << " (tid " << m_thread_tid.load() << ") has not stopped "
+    << std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count()
+    << " ms after being asked to, and may be waited for again; wchan=" << read_proc_file(task_dir + "wchan");
+  if (m_options.report_kernel_stack) {
+    s << ", kernel stack:\n" << read_proc_file(task_dir + "stack");
+  }
+  return s.str();
+}
+
+void
+dunedaq::utilities::WorkerThread::thread_main()
+{
+  m_thread_tid = static_cast<pid_t>(syscall(SYS_gettid));
+  std::unique_lock<std::mutex> lk(m_run_mutex);
+  while (true) {
+    m_run_cv.wait(lk, [&] { return m_run_requested || m_quit_requested; });
+    if (m_quit_requested) {
+      return;
+    }
+    m_run_requested = false;
+    lk.unlock();
+    m_do_work(m_thread_running);
+    lk.lock();
+    m_run_done = true;
+    m_run_cv.notify_all();
+    if (!m_options.park_between_runs) {
+      return;
+    }
+  }
+}
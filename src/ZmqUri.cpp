@@ -0,0 +1,27 @@
+/**
+ *
+ * @file ZmqUri.cpp ZMQ connection string parsing
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/ZmqUri.hpp"
+
+dunedaq::utilities::ZmqUriView
+dunedaq::utilities::parse_connection_string_view(std::string_view connection_string)
+{
+  ZmqUriView output;
+  if (!try_parse_connection_string(connection_string, output)) {
+    throw InvalidUri(ERS_HERE, std::string(connection_string));
+  }
+  return output;
+}
+
+dunedaq::utilities::ZmqUri
+dunedaq::utilities::parse_connection_string(std::string_view connection_string)
+{
+  auto view = parse_connection_string_view(connection_string);
+  return ZmqUri{ std::string(view.scheme), std::string(view.host), std::string(view.port), std::string(view.source) };
+}
@@ -0,0 +1,298 @@
+/**
+ * @file queue_benchmark.cpp Throughput and latency of SPSCQueue and MPMCQueue, against a mutex-guarded std::deque
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/MPMCQueue.hpp"
+#include "utilities/SPSCQueue.hpp"
+
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <iostream>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace bpo = boost::program_options;
+using namespace dunedaq::utilities;
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+using element_t = uint64_t; // NOLINT(build/unsigned)
+
+/**
+ * @brief What users write without a concurrent queue, with the same interface as the queues
+ */
+class MutexQueue
+{
+public:
+  explicit MutexQueue(size_t capacity)
+    : m_capacity(capacity)
+  {}
+
+  bool try_push(element_t value)
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    if (m_deque.size() >= m_capacity) {
+      return false;
+    }
+    m_deque.push_back(value);
+    return true;
+  }
+
+  bool try_pop(element_t& value)
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    if (m_deque.empty()) {
+      return false;
+    }
+    value = m_deque.front();
+    m_deque.pop_front();
+    return true;
+  }
+
+  template<typename InputIt>
+  InputIt try_push_batch(InputIt first, InputIt last)
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    for (; first != last && m_deque.size() < m_capacity; ++first) {
+      m_deque.push_back(*first);
+    }
+    return first;
+  }
+
+  template<typename OutputIt>
+  size_t try_pop_batch(OutputIt out, size_t max_count)
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    auto count = std::min(max_count, m_deque.size());
+    std::copy_n(m_deque.begin(), count, out);
+    m_deque.erase(m_deque.begin(), m_deque.begin() + count);
+    return count;
+  }
+
+  bool push_wait(element_t value, std::atomic<bool> const& running)
+  {
+    return detail::wait_for_queue([&]() { return try_push(value); }, running, std::chrono::milliseconds::max());
+  }
+
+  bool pop_wait(element_t& value, std::atomic<bool> const& running)
+  {
+    return detail::wait_for_queue([&]() { return try_pop(value); }, running, std::chrono::milliseconds::max());
+  }
+
+private:
+  size_t m_capacity;
+  std::mutex m_mutex;
+  std::deque<element_t> m_deque;
+};
+
+struct Options
+{
+  size_t n_elements{ 2000000 };
+  size_t capacity{ 1024 };
+  size_t batch{ 32 };
+  size_t producers{ 2 };
+  size_t consumers{ 2 };
+  size_t round_trips{ 100000 };
+};
+
+/**
+ * @brief Move n_elements through queue from producers to consumers
+ * @return Millions of elements per second
+ */
+template<typename Queue>
+double
+measure_throughput(Options const& options, size_t n_producers, size_t n_consumers, size_t batch)
+{
+  Queue queue(options.capacity);
+  auto per_producer = options.n_elements / n_producers;
+  auto total = per_producer * n_producers;
+  std::atomic<size_t> n_popped{ 0 };
+  std::atomic<bool> go{ false };
+
+  std::vector<std::thread> threads;
+  for (size_t p = 0; p < n_producers; ++p) {
+    threads.emplace_back([&]() {
+      std::vector<element_t> values(batch);
+      while (!go.load()) {
+        std::this_thread::yield();
+      }
+      for (size_t i = 0; i < per_producer;) {
+        if (batch <= 1) {
+          detail::WaitBackoff backoff;
+          while (!queue.try_push(i)) {
+            backoff.wait();
+          }
+          ++i;
+          continue;
+        }
+        auto count = std::min(batch, per_producer - i);
+        std::fill_n(values.begin(), count, i);
+        auto next = values.begin();
+        detail::WaitBackoff backoff;
+        while (next != values.begin() + count) {
+          auto pushed = queue.try_push_batch(next, values.begin() + count);
+          if (pushed == next) {
+            backoff.wait();
+          }
+          next = pushed;
+        }
+        i += count;
+      }
+    });
+  }
+  for (size_t c = 0; c < n_consumers; ++c) {
+    threads.emplace_back([&]() {
+      std::vector<element_t> values;
+      values.reserve(batch);
+      element_t value;
+      detail::WaitBackoff backoff;
+      while (!go.load()) {
+        std::this_thread::yield();
+      }
+      while (n_popped.load(std::memory_order_relaxed) < total) {
+        size_t count = 0;
+        if (batch <= 1) {
+          count = queue.try_pop(value) ? 1 : 0;
+        } else {
+          values.clear();
+          count = queue.try_pop_batch(std::back_inserter(values), batch);
+        }
+        if (count == 0) {
+          backoff.wait();
+        } else {
+          n_popped.fetch_add(count, std::memory_order_relaxed);
+          backoff = detail::WaitBackoff();
+        }
+      }
+    });
+  }
+
+  auto start = clock_type::now();
+  go = true;
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  return total / std::chrono::duration<double, std::micro>(clock_type::now() - start).count();
+}
+
+/**
+ * @brief Bounce a timestamp between two threads through a pair of
+ * queues, using the blocking waits
+ * @return One-way latencies, in ns
+ */
+template<typename Queue>
+std::vector<double>
+measure_latency(Options const& options)
+{
+  Queue ping(options.capacity);
+  Queue pong(options.capacity);
+  std::atomic<bool> running{ true };
+
+  std::thread echo([&]() {
+    element_t value;
+    while (ping.pop_wait(value, running)) {
+      pong.push_wait(value, running);
+    }
+  });
+
+  std::vector<double> latencies;
+  latencies.reserve(options.round_trips);
+  element_t value;
+  for (size_t i = 0; i < options.round_trips; ++i) {
+    auto start = clock_type::now();
+    ping.push_wait(element_t(i), running);
+    pong.pop_wait(value, running);
+    latencies.push_back(std::chrono::duration<double, std::nano>(clock_type::now() - start).count() / 2);
+  }
+  running = false;
+  echo.join();
+  return latencies;
+}
+
+void
+print_latencies(std::string const& label, std::vector<double> latencies)
+{
+  std::sort(latencies.begin(), latencies.end());
+  auto percentile = [&](double p) { return latencies[std::min(latencies.size() - 1, size_t(p * latencies.size()))]; };
+  std::printf("%-36s p50=%8.0f ns  p90=%8.0f ns  p99=%8.0f ns  max=%9.0f ns\n",
+              label.c_str(),
+              percentile(0.5),
+              percentile(0.9),
+              percentile(0.99),
+              latencies.back());
+}
+
+} // namespace ""
+
+int
+main(int argc, char* argv[])
+{
+  Options options;
+  bpo::options_description desc("Measures SPSCQueue and MPMCQueue against a mutex-guarded std::deque");
+  desc.add_options()("help,h", "Print this help")(
+    "elements,n", bpo::value<size_t>(&options.n_elements)->default_value(options.n_elements), "Elements per run")(
+    "capacity", bpo::value<size_t>(&options.capacity)->default_value(options.capacity), "Queue capacity")(
+    "batch", bpo::value<size_t>(&options.batch)->default_value(options.batch), "Batch size for the batch runs")(
+    "producers", bpo::value<size_t>(&options.producers)->default_value(options.producers), "Producers (MPMC runs)")(
+    "consumers", bpo::value<size_t>(&options.consumers)->default_value(options.consumers), "Consumers (MPMC runs)")(
+    "round-trips",
+    bpo::value<size_t>(&options.round_trips)->default_value(options.round_trips),
+    "Round trips for the latency runs");
+
+  bpo::variables_map vm;
+  try {
+    bpo::store(bpo::parse_command_line(argc, argv, desc), vm);
+    bpo::notify(vm);
+  } catch (bpo::error const& e) {
+    std::cerr << e.what() << "\n" << desc << "\n";
+    return 1;
+  }
+  if (vm.count("help")) {
+    std::cout << desc << "\n";
+    return 0;
+  }
+  options.batch = std::max<size_t>(options.batch, 1);
+  options.producers = std::max<size_t>(options.producers, 1);
+  options.consumers = std::max<size_t>(options.consumers, 1);
+  options.round_trips = std::max<size_t>(options.round_trips, 1);
+
+  auto p = options.producers;
+  auto c = options.consumers;
+  auto mpmc_label = std::to_string(p) + ":" + std::to_string(c);
+  auto batch_label = "batch " + std::to_string(options.batch);
+  auto print_throughput = [](std::string const& label, double rate) {
+    std::printf("%-36s %8.2f M elements/s\n", label.c_str(), rate);
+  };
+
+  std::printf("%zu elements, capacity %zu\n\n", options.n_elements, options.capacity);
+  print_throughput("mutex deque 1:1", measure_throughput<MutexQueue>(options, 1, 1, 1));
+  print_throughput("mutex deque 1:1, " + batch_label, measure_throughput<MutexQueue>(options, 1, 1, options.batch));
+  print_throughput("SPSCQueue 1:1", measure_throughput<SPSCQueue<element_t>>(options, 1, 1, 1));
+  print_throughput("SPSCQueue 1:1, " + batch_label,
+                   measure_throughput<SPSCQueue<element_t>>(options, 1, 1, options.batch));
+  print_throughput("mutex deque " + mpmc_label, measure_throughput<MutexQueue>(options, p, c, 1));
+  print_throughput("MPMCQueue 1:1", measure_throughput<MPMCQueue<element_t>>(options, 1, 1, 1));
+  print_throughput("MPMCQueue " + mpmc_label, measure_throughput<MPMCQueue<element_t>>(options, p, c, 1));
+  print_throughput("MPMCQueue " + mpmc_label + ", " + batch_label,
+                   measure_throughput<MPMCQueue<element_t>>(options, p, c, options.batch));
+
+  std::printf("\n");
+  print_latencies("mutex deque, one way", measure_latency<MutexQueue>(options));
+  print_latencies("SPSCQueue, one way", measure_latency<SPSCQueue<element_t>>(options));
+  print_latencies("MPMCQueue, one way", measure_latency<MPMCQueue<element_t>>(options));
+  return 0;
+}
@@ -1,18 +1,270 @@
+/**
+ * @file resolve_hostname.cpp Resolve host names, connection strings and services, one or in bulk
+ *
+ * Each name is a host name, a connection string (anything containing
+ * "://", resolved as with resolve_uri_endpoints) or a service DNS name
+ * (starting with "_", eg _name._tcp.domain, resolved as with
+ * get_service_endpoints). Names are taken from the command line or, if
+ * there are none, read one per line from --file or stdin ('#' starts a
+ * comment). They are resolved concurrently, and the exit code is 0 only
+ * if every name resolved to at least one address (connection strings of
+ * schemes other than tcp need none).
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
 #include "utilities/Resolver.hpp"
 
-int main(int argc, char* argv[]) {
+#include <boost/program_options.hpp>
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace bpo = boost::program_options;
+using namespace dunedaq::utilities;
+
+namespace {
+
+struct Lookup
+{
+  std::string name;
+  std::string kind;
+  std::vector<std::string> addresses;
+  std::string error;
+  double latency_us{ 0 };
+};
+
+std::vector<std::string>
+read_names(std::istream& input)
+{
+  std::vector<std::string> names;
+  std::string line;
+  while (std::getline(input, line)) {
+    line = line.substr(0, line.find('#'));
+    auto begin = line.find_first_not_of(" \t\r");
+    if (begin == std::string::npos) {
+      continue;
+    }
+    auto end = line.find_last_not_of(" \t\r");
+    names.push_back(line.substr(begin, end - begin + 1));
+  }
+  return names;
+}
+
+void
+resolve(Lookup& lookup)
+{
+  std::vector<Endpoint> endpoints;
+  auto start = std::chrono::steady_clock::now();
+  try {
+    if (lookup.name.find("://") != std::string::npos) {
+      lookup.kind = "uri";
+      endpoints = resolve_uri_endpoints(lookup.name);
+    } else if (lookup.name[0] == '_') {
+      lookup.kind = "service";
+      endpoints = get_service_endpoints(lookup.name);
+    } else {
+      lookup.kind = "host";
+      endpoints = get_endpoints_from_hostname(lookup.name);
+    }
+  } catch (std::exception const& e) {
+    lookup.error = e.what();
+  }
+  lookup.latency_us =
+    std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+  for (auto& endpoint : endpoints) {
+    lookup.addresses.push_back(lookup.kind == "host" ? endpoint.get_address() : endpoint.to_string());
+  }
+  // Only tcp connection strings have a network address to resolve
+  bool needs_address = lookup.kind != "uri" || lookup.name.compare(0, 6, "tcp://") == 0;
+  if (lookup.addresses.empty() && lookup.error.empty() && needs_address) {
+    lookup.error = "no addresses";
+  }
+}
 
-    if (argc != 2) {
-        std::cout << "Invalid number of arguments:\nresolve hostname\n";
-        exit(1);
+void
+resolve_all(std::vector<Lookup>& lookups, size_t n_threads)
+{
+  std::atomic<size_t> next{ 0 };
+  auto work = [&]() {
+    for (auto i = next++; i < lookups.size(); i = next++) {
+      resolve(lookups[i]);
     }
+  };
+  std::vector<std::thread> threads;
+  for (size_t t = 1; t < std::min(n_threads, lookups.size()); ++t) {
+    threads.emplace_back(work);
+  }
+  work();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+/**
+ * @brief Print a histogram of the latencies in power-of-two buckets,
+ * followed by the percentiles
+ */
+void
+print_summary(std::vector<Lookup> const& lookups, double wall_ms)
+{
+  std::vector<double> latencies;
+  size_t failed = 0;
+  for (auto& lookup : lookups) {
+    latencies.push_back(lookup.latency_us);
+    failed += lookup.error.empty() ? 0 : 1;
+  }
+  std::sort(latencies.begin(), latencies.end());
 
-    auto results = dunedaq::utilities::get_ips_from_hostname(argv[1]);
-    for (auto const& r: results)
-        std::cout << r << "\n";
+  std::vector<size_t> buckets;
+  for (auto latency : latencies) {
+    size_t bucket = 0;
+    while ((2u << bucket) < latency) {
+      ++bucket;
+    }
+    buckets.resize(std::max(buckets.size(), bucket + 1));
+    ++buckets[bucket];
+  }
+  auto largest = *std::max_element(buckets.begin(), buckets.end());
+
+  std::printf("\n%zu names, %zu failed, %.1f ms\n", lookups.size(), failed, wall_ms);
+  for (size_t bucket = 0; bucket < buckets.size(); ++bucket) {
+    if (buckets[bucket] == 0) {
+      continue;
+    }
+    std::printf("  <= %9u us %7zu %s\n",
+                2u << bucket,
+                buckets[bucket],
+                std::string(std::max<size_t>(1, 50 * buckets[bucket] / largest), '#').c_str());
+  }
+  auto percentile = [&](double p) { return latencies[std::min(latencies.size() - 1, size_t(p * latencies.size()))]; };
+  std::printf("  p50=%.1f us  p90=%.1f us  p99=%.1f us  max=%.1f us\n",
+              percentile(0.5),
+              percentile(0.9),
+              percentile(0.99),
+              latencies.back());
+}
+
+void
+print_json(std::vector<Lookup> const& lookups, double wall_ms)
+{
+  auto output = nlohmann::json::object();
+  auto results = nlohmann::json::array();
+  size_t failed = 0;
+  for (auto& lookup : lookups) {
+    nlohmann::json result = {
+      { "name", lookup.name },
+      { "kind", lookup.kind },
+      { "addresses", lookup.addresses },
+      { "latency_us", lookup.latency_us },
+    };
+    if (!lookup.error.empty()) {
+      result["error"] = lookup.error;
+      ++failed;
+    }
+    results.push_back(std::move(result));
+  }
+  output["results"] = std::move(results);
+  output["summary"] = { { "names", lookups.size() }, { "failed", failed }, { "wall_ms", wall_ms } };
+  std::cout << output.dump(2) << "\n";
+}
+
+} // namespace ""
+
+int
+main(int argc, char* argv[])
+{
+  std::vector<std::string> names;
+  std::string file;
+  size_t n_threads = 16;
+  bool json = false;
+
+  bpo::options_description desc("Resolves host names, connection strings (scheme://host:port) and services "
+                                "(_name._tcp.domain).\nUsage: resolve_hostname [options] [name...]\nOptions");
+  desc.add_options()("help,h", "Print this help")(
+    "file,f", bpo::value<std::string>(&file), "Read names from this file instead of stdin (- for stdin)")(
+    "threads,t", bpo::value<size_t>(&n_threads)->default_value(n_threads), "Number of concurrent lookups")(
+    "json", bpo::bool_switch(&json), "Print the results and summary as JSON");
+  bpo::options_description hidden;
+  hidden.add_options()("name", bpo::value<std::vector<std::string>>(&names));
+  bpo::options_description all;
+  all.add(desc).add(hidden);
+  bpo::positional_options_description positional;
+  positional.add("name", -1);
+
+  bpo::variables_map vm;
+  try {
+    bpo::store(bpo::command_line_parser(argc, argv).options(all).positional(positional).run(), vm);
+    bpo::notify(vm);
+  } catch (bpo::error const& e) {
+    std::cerr << e.what() << "\n" << desc << "\n";
+    return 2;
+  }
+  if (vm.count("help")) {
+    std::cout << desc << "\n";
+    return 0;
+  }
+
+  if (names.empty()) {
+    if (file.empty() || file == "-") {
+      names = read_names(std::cin);
+    } else {
+      std::ifstream input(file);
+      if (!input) {
+        std::cerr << "Cannot open " << file << "\n";
+        return 2;
+      }
+      names = read_names(input);
+    }
+  }
+  if (names.empty()) {
+    std::cerr << "No names to resolve\n" << desc << "\n";
+    return 2;
+  }
+
+  std::vector<Lookup> lookups(names.size());
+  for (size_t i = 0; i < names.size(); ++i) {
+    lookups[i].name = names[i];
+  }
+  auto start = std::chrono::steady_clock::now();
+  resolve_all(lookups, std::max<size_t>(n_threads, 1));
+  auto wall_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+  bool all_resolved = std::all_of(lookups.begin(), lookups.end(), [](Lookup const& l) { return l.error.empty(); });
+
+  if (json) {
+    print_json(lookups, wall_ms);
+  } else if (lookups.size() == 1) {
+    // A single name prints just its addresses, as this tool always did
+    for (auto& address : lookups[0].addresses) {
+      std::cout << address << "\n";
+    }
+  } else {
+    for (auto& lookup : lookups) {
+      std::printf("%-40s %-8s %10.1f us  ", lookup.name.c_str(), lookup.kind.c_str(), lookup.latency_us);
+      if (lookup.error.empty()) {
+        for (auto& address : lookup.addresses) {
+          std::printf("%s ", address.c_str());
+        }
+        std::printf("\n");
+      } else {
+        std::printf("FAILED: %s\n", lookup.error.c_str());
+      }
+    }
+    print_summary(lookups, wall_ms);
+  }
 
-    if (results.size() > 1)
-        return 0;
-    else
-        return 1;
-}
\ No newline at end of file
+  return all_resolved ? 0 : 1;
+}
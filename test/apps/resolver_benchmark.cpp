@@ -0,0 +1,209 @@
+/**
+ * @file resolver_benchmark.cpp Resolver latency and throughput against a local stub DNS server
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/Resolver.hpp"
+
+#include "../src/StubDnsServer.hpp"
+
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace bpo = boost::program_options;
+using namespace dunedaq::utilities;
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+double
+elapsed_us(clock_type::time_point start)
+{
+  return std::chrono::duration<double, std::micro>(clock_type::now() - start).count();
+}
+
+void
+print_latencies(std::string const& label, std::vector<double> latencies)
+{
+  if (latencies.empty()) {
+    return;
+  }
+  std::sort(latencies.begin(), latencies.end());
+  auto percentile = [&](double p) { return latencies[std::min(latencies.size() - 1, size_t(p * latencies.size()))]; };
+  std::printf("%-28s n=%-7zu p50=%9.1f us  p90=%9.1f us  p99=%9.1f us  max=%9.1f us\n",
+              label.c_str(),
+              latencies.size(),
+              percentile(0.5),
+              percentile(0.9),
+              percentile(0.99),
+              latencies.back());
+}
+
+/**
+ * @brief Time lookup(i) for i in [0, n), clearing the resolver caches before each one if cold
+ */
+std::vector<double>
+time_lookups(size_t n, bool cold, std::function<void(size_t)> const& lookup)
+{
+  std::vector<double> latencies;
+  latencies.reserve(n);
+  for (size_t i = 0; i < n; ++i) {
+    if (cold) {
+      invalidate_resolver_cache();
+    }
+    auto start = clock_type::now();
+    lookup(i);
+    latencies.push_back(elapsed_us(start));
+  }
+  return latencies;
+}
+
+} // namespace ""
+
+int
+main(int argc, char* argv[])
+{
+  size_t n_lookups = 2000;
+  size_t n_names = 500;
+  size_t n_threads = 8;
+  int64_t delay_us = 100;
+  double loss = 0;
+
+  bpo::options_description desc("Measures Resolver lookups against a local stub DNS server");
+  desc.add_options()("help,h", "Print this help")(
+    "lookups,n", bpo::value<size_t>(&n_lookups)->default_value(n_lookups), "Lookups per measurement")(
+    "names", bpo::value<size_t>(&n_names)->default_value(n_names), "Number of distinct hosts and services")(
+    "threads,t", bpo::value<size_t>(&n_threads)->default_value(n_threads), "Threads for the throughput test")(
+    "delay", bpo::value<int64_t>(&delay_us)->default_value(delay_us), "Server answer delay (us)")(
+    "loss", bpo::value<double>(&loss)->default_value(loss), "Fraction of UDP queries dropped by the server");
+
+  bpo::variables_map vm;
+  try {
+    bpo::store(bpo::parse_command_line(argc, argv, desc), vm);
+    bpo::notify(vm);
+  } catch (bpo::error const& e) {
+    std::cerr << e.what() << "\n" << desc << "\n";
+    return 1;
+  }
+  if (vm.count("help")) {
+    std::cout << desc << "\n";
+    return 0;
+  }
+  n_names = std::max<size_t>(n_names, 1);
+  n_threads = std::max<size_t>(n_threads, 1);
+
+  StubDnsServer server;
+  std::vector<std::string> hosts;
+  std::vector<std::string> services;
+  for (size_t i = 0; i < n_names; ++i) {
+    hosts.push_back("node-" + std::to_string(i) + ".bench.test");
+    services.push_back("_svc" + std::to_string(i) + "._tcp.bench.test");
+    server.add_host(hosts.back(), { "10." + std::to_string(i / 250) + "." + std::to_string(i % 250) + ".1" });
+    ServiceRecord record;
+    record.target = hosts.back();
+    record.port = 5000;
+    record.ttl = 60;
+    server.add_service(services.back(), { record });
+  }
+  server.set_delay(std::chrono::microseconds(delay_us));
+  server.set_loss(loss);
+  set_resolver_nameservers({ server.get_endpoint() }, std::chrono::seconds(1), 2);
+  // Failures are expected with packet loss; don't flood the output with them
+  set_resolver_error_report_interval(std::chrono::hours(1));
+
+  std::printf("Stub DNS server on 127.0.0.1:%u, delay %ld us, loss %.2f, %zu names\n\n",
+              server.get_port(),
+              static_cast<long>(delay_us), // NOLINT(runtime/int)
+              loss,
+              n_names);
+
+  // Latency of single lookups
+  print_latencies("host, uncached", time_lookups(n_lookups, true, [&](size_t i) {
+                    get_ips_from_hostname(hosts[i % n_names]);
+                  }));
+  print_latencies("service, uncached", time_lookups(n_lookups, true, [&](size_t i) {
+                    get_service_addresses(services[i % n_names]);
+                  }));
+  server.set_additional_records(false);
+  print_latencies("service, no additional", time_lookups(n_lookups, true, [&](size_t i) {
+                    get_service_addresses(services[i % n_names]);
+                  }));
+  server.set_additional_records(true);
+  for (size_t i = 0; i < n_names; ++i) {
+    get_ips_from_hostname(hosts[i]);
+    get_service_addresses(services[i]);
+  }
+  print_latencies("host, cached", time_lookups(n_lookups, false, [&](size_t i) {
+                    get_ips_from_hostname(hosts[i % n_names]);
+                  }));
+  print_latencies("service, cached", time_lookups(n_lookups, false, [&](size_t i) {
+                    get_service_addresses(services[i % n_names]);
+                  }));
+
+  // Cache effectiveness on a skewed workload, where a few names are looked up most often
+  invalidate_resolver_cache();
+  auto hits = get_hostname_cache().get_hits();
+  auto misses = get_hostname_cache().get_misses();
+  auto queries = server.get_num_queries();
+  std::mt19937_64 rng(12345);
+  std::geometric_distribution<size_t> skew(10.0 / n_names);
+  auto skewed = time_lookups(n_lookups, false, [&](size_t) { get_ips_from_hostname(hosts[skew(rng) % n_names]); });
+  print_latencies("host, skewed workload", skewed);
+  std::printf("%-28s hits=%lu misses=%lu queries=%lu\n\n",
+              "  cache",
+              static_cast<unsigned long>(get_hostname_cache().get_hits() - hits),     // NOLINT
+              static_cast<unsigned long>(get_hostname_cache().get_misses() - misses), // NOLINT
+              static_cast<unsigned long>(server.get_num_queries() - queries));        // NOLINT
+
+  // Throughput of concurrent uncached lookups
+  set_resolver_cache_max_age(std::chrono::milliseconds(0));
+  std::atomic<size_t> next{ 0 };
+  auto start = clock_type::now();
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < n_threads; ++t) {
+    threads.emplace_back([&]() {
+      for (auto i = next++; i < n_lookups; i = next++) {
+        get_service_addresses(services[i % n_names]);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  auto seconds = elapsed_us(start) / 1e6;
+  std::printf("%-28s %zu threads: %.0f lookups/s\n", "service, concurrent", n_threads, n_lookups / seconds);
+
+  std::vector<std::string> uris;
+  for (size_t i = 0; i < n_lookups; ++i) {
+    uris.push_back("tcp://" + hosts[i % n_names] + ":5000");
+  }
+  BatchResolveOptions options;
+  options.max_concurrency = n_threads;
+  start = clock_type::now();
+  resolve_many(uris, options);
+  seconds = elapsed_us(start) / 1e6;
+  std::printf("%-28s %zu workers: %.0f lookups/s\n", "resolve_many", n_threads, n_lookups / seconds);
+  std::printf("%-28s udp=%lu tcp=%lu dropped=%lu\n",
+              "server queries",
+              static_cast<unsigned long>(server.get_num_udp_queries()), // NOLINT
+              static_cast<unsigned long>(server.get_num_tcp_queries()), // NOLINT
+              static_cast<unsigned long>(server.get_num_dropped()));    // NOLINT
+
+  set_resolver_cache_max_age(kDefaultResolverCacheMaxAge);
+  set_resolver_nameservers({});
+  return 0;
+}
@@ -0,0 +1,489 @@
+/**
+ *
+ * @file StubDnsServer.hpp Minimal DNS server for resolver tests and benchmarks
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef UTILITIES_TEST_SRC_STUBDNSSERVER_HPP_
+#define UTILITIES_TEST_SRC_STUBDNSSERVER_HPP_
+
+#include "utilities/Endpoint.hpp"
+#include "utilities/ServiceRecord.hpp"
+
+#include <arpa/inet.h>
+#include <arpa/nameser.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace dunedaq {
+namespace utilities {
+
+/**
+ * @brief StubDnsServer answers A and SRV queries for configured names
+ * over UDP and TCP on 127.0.0.1, so that the Resolver can be tested
+ * and benchmarked offline (see set_resolver_nameservers).
+ *
+ * Unknown names get NXDOMAIN. UDP answers larger than the maximum UDP
+ * size are truncated (TC set, no records), as real servers do, which
+ * makes the resolver retry over TCP. SRV answers include the targets'
+ * A records in the additional section unless disabled. Answers can be
+ * delayed, UDP queries dropped at random, and answers damaged to test
+ * the resolver's error handling.
+ */
+class StubDnsServer
+{
+public:
+  StubDnsServer()
+  {
+    // Use the same port for UDP and TCP, as resolvers expect
+    for (int attempt = 0; attempt < 10 && m_tcp_fd < 0; ++attempt) {
+      m_udp_fd = bind_socket(SOCK_DGRAM, 0);
+      m_port = get_bound_port(m_udp_fd);
+      m_tcp_fd = bind_socket(SOCK_STREAM, m_port);
+      if (m_tcp_fd < 0) {
+        close(m_udp_fd);
+        m_udp_fd = -1;
+      }
+    }
+    if (m_tcp_fd < 0 || listen(m_tcp_fd, 64) != 0) {
+      throw std::runtime_error("StubDnsServer could not bind its sockets");
+    }
+
+    m_running = true;
+    m_udp_thread = std::thread([this]() { run_udp(); });
+    m_tcp_thread = std::thread([this]() { run_tcp(); });
+  }
+
+  ~StubDnsServer()
+  {
+    m_running = false;
+    m_udp_thread.join();
+    m_tcp_thread.join();
+    {
+      std::lock_guard<std::mutex> lk(m_connections_mutex);
+      for (auto fd : m_connection_fds) {
+        shutdown(fd, SHUT_RDWR);
+      }
+    }
+    for (auto& thread : m_connection_threads) {
+      thread.join();
+    }
+    close(m_udp_fd);
+    close(m_tcp_fd);
+  }
+
+  StubDnsServer(const StubDnsServer&) = delete;            ///< StubDnsServer is not copy-constructible
+  StubDnsServer& operator=(const StubDnsServer&) = delete; ///< StubDnsServer is not copy-assignable
+  StubDnsServer(StubDnsServer&&) = delete;                 ///< StubDnsServer is not move-constructible
+  StubDnsServer& operator=(StubDnsServer&&) = delete;      ///< StubDnsServer is not move-assignable
+
+  uint16_t get_port() const { return m_port; } // NOLINT(build/unsigned)
+  Endpoint get_endpoint() const { return *Endpoint::from_numeric("udp", "127.0.0.1", m_port); }
+
+  /**
+   * @brief Serve A records for name (IPv4 addresses only)
+   */
+  void add_host(std::string const& name, std::vector<std::string> const& addresses, uint32_t ttl = 60) // NOLINT
+  {
+    Host host;
+    host.ttl = ttl;
+    for (auto& address : addresses) {
+      in_addr addr{};
+      if (inet_pton(AF_INET, address.c_str(), &addr) != 1) {
+        throw std::invalid_argument("StubDnsServer: " + address + " is not an IPv4 address");
+      }
+      host.addresses.push_back(addr);
+    }
+    std::lock_guard<std::mutex> lk(m_records_mutex);
+    m_hosts[normalize(name)] = std::move(host);
+  }
+
+  /**
+   * @brief Serve SRV records for name, using their target, priority,
+   * weight, port and ttl
+   */
+  void add_service(std::string const& name, std::vector<ServiceRecord> const& records)
+  {
+    std::lock_guard<std::mutex> lk(m_records_mutex);
+    m_services[normalize(name)] = records;
+  }
+
+  void remove_name(std::string const& name)
+  {
+    std::lock_guard<std::mutex> lk(m_records_mutex);
+    m_hosts.erase(normalize(name));
+    m_services.erase(normalize(name));
+  }
+
+  void set_delay(std::chrono::microseconds delay) { m_delay_us = delay.count(); }
+  /// Fraction of UDP queries which are dropped
+  void set_loss(double loss) { m_loss = loss; }
+  void set_additional_records(bool enabled) { m_additional = enabled; }
+  void set_max_udp_size(size_t size) { m_max_udp_size = size; }
+  /// Set TC on TCP answers too, so that they look truncated even at full size
+  void set_truncate_tcp(bool enabled) { m_truncate_tcp = enabled; }
+  /// Give the first count SRV records of each answer RDATA too short to parse
+  void set_malformed_records(size_t count) { m_malformed_records = count; }
+
+  uint64_t get_num_udp_queries() const { return m_udp_queries.load(); } // NOLINT(build/unsigned)
+  uint64_t get_num_tcp_queries() const { return m_tcp_queries.load(); } // NOLINT(build/unsigned)
+  uint64_t get_num_dropped() const { return m_dropped.load(); }         // NOLINT(build/unsigned)
+  uint64_t get_num_queries() const { return get_num_udp_queries() + get_num_tcp_queries(); } // NOLINT
+
+private:
+  struct Host
+  {
+    std::vector<in_addr> addresses;
+    uint32_t ttl{ 60 }; // NOLINT(build/unsigned)
+  };
+
+  struct PendingAnswer
+  {
+    std::chrono::steady_clock::time_point due;
+    sockaddr_in client;
+    std::vector<uint8_t> data; // NOLINT(build/unsigned)
+  };
+
+  static int bind_socket(int type, uint16_t port) // NOLINT(build/unsigned)
+  {
+    int fd = socket(AF_INET, type, 0);
+    if (fd < 0) {
+      return -1;
+    }
+    int one = 1;
+    if (type == SOCK_STREAM) {
+      setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    }
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) { // NOLINT
+      close(fd);
+      return -1;
+    }
+    return fd;
+  }
+
+  static uint16_t get_bound_port(int fd) // NOLINT(build/unsigned)
+  {
+    sockaddr_in addr{};
+    socklen_t len = sizeof(addr);
+    if (fd < 0 || getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len) != 0) { // NOLINT
+      return 0;
+    }
+    return ntohs(addr.sin_port);
+  }
+
+  static std::string normalize(std::string name)
+  {
+    if (!name.empty() && name.back() == '.') {
+      name.pop_back();
+    }
+    std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return std::tolower(c); });
+    return name;
+  }
+
+  static void put16(std::vector<uint8_t>& out, uint16_t value) // NOLINT(build/unsigned)
+  {
+    out.push_back(value >> 8);
+    out.push_back(value & 0xff);
+  }
+
+  static void put32(std::vector<uint8_t>& out, uint32_t value) // NOLINT(build/unsigned)
+  {
+    put16(out, value >> 16);
+    put16(out, value & 0xffff);
+  }
+
+  static void put_name(std::vector<uint8_t>& out, std::string const& name) // NOLINT(build/unsigned)
+  {
+    size_t start = 0;
+    while (start < name.size()) {
+      auto end = std::min(name.find('.', start), name.size());
+      out.push_back(static_cast<uint8_t>(end - start)); // NOLINT(build/unsigned)
+      out.insert(out.end(), name.begin() + start, name.begin() + end);
+      start = end + 1;
+    }
+    out.push_back(0);
+  }
+
+  static void put_a_record(std::vector<uint8_t>& out, std::string const* name, in_addr addr, uint32_t ttl) // NOLINT
+  {
+    if (name == nullptr) {
+      put16(out, 0xc00c); // Pointer to the question name
+    } else {
+      put_name(out, *name);
+    }
+    put16(out, ns_t_a);
+    put16(out, 1);
+    put32(out, ttl);
+    put16(out, sizeof(addr));
+    auto bytes = reinterpret_cast<const uint8_t*>(&addr); // NOLINT
+    out.insert(out.end(), bytes, bytes + sizeof(addr));
+  }
+
+  /**
+   * @brief Build the answer to query, or return an empty vector if query is not a valid question
+   */
+  std::vector<uint8_t> answer(const uint8_t* query, size_t size, bool udp) // NOLINT(build/unsigned)
+  {
+    std::vector<uint8_t> out; // NOLINT(build/unsigned)
+    if (size < 12 || query[4] != 0 || query[5] != 1) {
+      return out;
+    }
+
+    // Question name
+    std::string name;
+    size_t pos = 12;
+    while (pos < size && query[pos] != 0) {
+      size_t len = query[pos];
+      if (len > 63 || pos + 1 + len > size) {
+        return out;
+      }
+      name.append(name.empty() ? "" : ".").append(reinterpret_cast<const char*>(query + pos + 1), len); // NOLINT
+      pos += 1 + len;
+    }
+    if (pos + 5 > size) {
+      return out;
+    }
+    size_t question_end = pos + 5;
+    uint16_t qtype = (query[pos + 1] << 8) | query[pos + 2]; // NOLINT(build/unsigned)
+    name = normalize(name);
+
+    std::vector<uint8_t> answers;    // NOLINT(build/unsigned)
+    std::vector<uint8_t> additional; // NOLINT(build/unsigned)
+    uint16_t n_answers = 0;          // NOLINT(build/unsigned)
+    uint16_t n_additional = 0;       // NOLINT(build/unsigned)
+    bool exists = false;
+    {
+      std::lock_guard<std::mutex> lk(m_records_mutex);
+      auto host = m_hosts.find(name);
+      auto service = m_services.find(name);
+      exists = host != m_hosts.end() || service != m_services.end();
+
+      if (qtype == ns_t_a && host != m_hosts.end()) {
+        for (auto& addr : host->second.addresses) {
+          put_a_record(answers, nullptr, addr, host->second.ttl);
+          ++n_answers;
+        }
+      }
+      if (qtype == ns_t_srv && service != m_services.end()) {
+        std::vector<std::string> targets;
+        for (auto& record : service->second) {
+          put16(answers, 0xc00c);
+          put16(answers, ns_t_srv);
+          put16(answers, 1);
+          put32(answers, record.ttl);
+          if (n_answers < m_malformed_records.load()) {
+            // RDATA too short to hold the port and target
+            put16(answers, 4);
+            put16(answers, record.priority);
+            put16(answers, record.weight);
+            ++n_answers;
+            continue;
+          }
+          std::vector<uint8_t> target; // NOLINT(build/unsigned)
+          put_name(target, record.target);
+          put16(answers, static_cast<uint16_t>(6 + target.size())); // NOLINT(build/unsigned)
+          put16(answers, record.priority);
+          put16(answers, record.weight);
+          put16(answers, record.port);
+          answers.insert(answers.end(), target.begin(), target.end());
+          ++n_answers;
+          if (std::find(targets.begin(), targets.end(), record.target) == targets.end()) {
+            targets.push_back(record.target);
+          }
+        }
+        for (auto& target : targets) {
+          auto target_host = m_hosts.find(normalize(target));
+          if (!m_additional || target_host == m_hosts.end()) {
+            continue;
+          }
+          for (auto& addr : target_host->second.addresses) {
+            put_a_record(additional, &target, addr, target_host->second.ttl);
+            ++n_additional;
+          }
+        }
+      }
+    }
+
+    bool truncated = udp && 12 + (question_end - 12) + answers.size() + additional.size() > m_max_udp_size;
+    // Over TCP, only TC is set, and the records are kept
+    bool tc = truncated || (!udp && m_truncate_tcp.load());
+
+    put16(out, (query[0] << 8) | query[1]);
+    // QR, opcode, AA, TC and RD; then RA and the response code
+    out.push_back(0x80 | (query[2] & 0x78) | 0x04 | (tc ? 0x02 : 0) | (query[2] & 0x01));
+    out.push_back(0x80 | (exists ? 0 : 3));
+    put16(out, 1);
+    put16(out, truncated ? 0 : n_answers);
+    put16(out, 0);
+    put16(out, truncated ? 0 : n_additional);
+    out.insert(out.end(), query + 12, query + question_end);
+    if (!truncated) {
+      out.insert(out.end(), answers.begin(), answers.end());
+      out.insert(out.end(), additional.begin(), additional.end());
+    }
+    return out;
+  }
+
+  void run_udp()
+  {
+    std::mt19937_64 rng(std::random_device{}());
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::vector<PendingAnswer> pending;
+    uint8_t buffer[NS_PACKETSZ * 4]; // NOLINT(build/unsigned)
+
+    while (m_running.load()) {
+      // Send the answers which are due, and sleep until the next one at most
+      auto now = std::chrono::steady_clock::now();
+      int timeout_ms = 10;
+      for (auto it = pending.begin(); it != pending.end();) {
+        if (it->due <= now) {
+          sendto(m_udp_fd,
+                 it->data.data(),
+                 it->data.size(),
+                 0,
+                 reinterpret_cast<sockaddr*>(&it->client), // NOLINT
+                 sizeof(it->client));
+          it = pending.erase(it);
+        } else {
+          auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(it->due - now).count();
+          timeout_ms = std::min<int>(timeout_ms, std::max<int>(wait, 0));
+          ++it;
+        }
+      }
+
+      pollfd pfd{ m_udp_fd, POLLIN, 0 };
+      if (poll(&pfd, 1, timeout_ms) <= 0) {
+        continue;
+      }
+      sockaddr_in client{};
+      socklen_t client_len = sizeof(client);
+      auto n = recvfrom(m_udp_fd, buffer, sizeof(buffer), 0, reinterpret_cast<sockaddr*>(&client), &client_len); // NOLINT
+      if (n <= 0) {
+        continue;
+      }
+      ++m_udp_queries;
+      if (m_loss.load() > 0 && uniform(rng) < m_loss.load()) {
+        ++m_dropped;
+        continue;
+      }
+      auto data = answer(buffer, n, true);
+      if (!data.empty()) {
+        pending.push_back(PendingAnswer{
+          std::chrono::steady_clock::now() + std::chrono::microseconds(m_delay_us.load()), client, std::move(data) });
+      }
+    }
+  }
+
+  void run_tcp()
+  {
+    while (m_running.load()) {
+      pollfd pfd{ m_tcp_fd, POLLIN, 0 };
+      if (poll(&pfd, 1, 10) <= 0) {
+        continue;
+      }
+      int fd = accept(m_tcp_fd, nullptr, nullptr);
+      if (fd < 0) {
+        continue;
+      }
+      std::lock_guard<std::mutex> lk(m_connections_mutex);
+      m_connection_fds.push_back(fd);
+      m_connection_threads.emplace_back([this, fd]() { serve_connection(fd); });
+    }
+  }
+
+  static bool read_fully(int fd, uint8_t* data, size_t size) // NOLINT(build/unsigned)
+  {
+    while (size > 0) {
+      auto n = recv(fd, data, size, 0);
+      if (n <= 0) {
+        return false;
+      }
+      data += n;
+      size -= n;
+    }
+    return true;
+  }
+
+  void serve_connection(int fd)
+  {
+    std::vector<uint8_t> query; // NOLINT(build/unsigned)
+    uint8_t length[2];          // NOLINT(build/unsigned)
+    while (m_running.load() && read_fully(fd, length, 2)) {
+      query.resize((length[0] << 8) | length[1]);
+      if (!read_fully(fd, query.data(), query.size())) {
+        break;
+      }
+      ++m_tcp_queries;
+      auto data = answer(query.data(), query.size(), false);
+      if (data.empty()) {
+        break;
+      }
+      std::this_thread::sleep_for(std::chrono::microseconds(m_delay_us.load()));
+      std::vector<uint8_t> message; // NOLINT(build/unsigned)
+      put16(message, static_cast<uint16_t>(data.size())); // NOLINT(build/unsigned)
+      message.insert(message.end(), data.begin(), data.end());
+      if (send(fd, message.data(), message.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(message.size())) {
+        break;
+      }
+    }
+
+    std::lock_guard<std::mutex> lk(m_connections_mutex);
+    m_connection_fds.erase(std::remove(m_connection_fds.begin(), m_connection_fds.end(), fd), m_connection_fds.end());
+    close(fd);
+  }
+
+  int m_udp_fd{ -1 };
+  int m_tcp_fd{ -1 };
+  uint16_t m_port{ 0 }; // NOLINT(build/unsigned)
+
+  std::mutex m_records_mutex;
+  std::unordered_map<std::string, Host> m_hosts;
+  std::unordered_map<std::string, std::vector<ServiceRecord>> m_services;
+
+  std::atomic<int64_t> m_delay_us{ 0 };
+  std::atomic<double> m_loss{ 0 };
+  std::atomic<bool> m_additional{ true };
+  std::atomic<size_t> m_max_udp_size{ 512 };
+  std::atomic<bool> m_truncate_tcp{ false };
+  std::atomic<size_t> m_malformed_records{ 0 };
+
+  std::atomic<uint64_t> m_udp_queries{ 0 }; // NOLINT(build/unsigned)
+  std::atomic<uint64_t> m_tcp_queries{ 0 }; // NOLINT(build/unsigned)
+  std::atomic<uint64_t> m_dropped{ 0 };     // NOLINT(build/unsigned)
+
+  std::atomic<bool> m_running{ false };
+  std::thread m_udp_thread;
+  std::thread m_tcp_thread;
+
+  std::mutex m_connections_mutex;
+  std::vector<int> m_connection_fds;
+  std::list<std::thread> m_connection_threads;
+};
+
+} // namespace utilities
+} // namespace dunedaq
+
+#endif // UTILITIES_TEST_SRC_STUBDNSSERVER_HPP_
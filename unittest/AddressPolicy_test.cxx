@@ -0,0 +1,169 @@
+/**
+ *
+ * @file AddressPolicy_test.cxx AddressPolicy class Unit Tests
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/AddressPolicy.hpp"
+#include "utilities/Issues.hpp"
+#include "utilities/Resolver.hpp"
+#include "utilities/ResolverBackend.hpp"
+
+#define BOOST_TEST_MODULE AddressPolicy_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace dunedaq::utilities;
+
+namespace {
+
+std::vector<Endpoint>
+make_endpoints(std::vector<std::string> const& addresses)
+{
+  std::vector<Endpoint> output;
+  for (auto& address : addresses) {
+    output.push_back(*Endpoint::from_numeric("", address, 0));
+  }
+  return output;
+}
+
+std::vector<std::string>
+get_addresses(std::vector<Endpoint> const& endpoints)
+{
+  std::vector<std::string> output;
+  for (auto& endpoint : endpoints) {
+    output.push_back(endpoint.get_address());
+  }
+  return output;
+}
+
+} // namespace ""
+
+BOOST_AUTO_TEST_SUITE(AddressPolicy_test)
+
+BOOST_AUTO_TEST_CASE(SubnetRules)
+{
+  AddressPolicy policy;
+  policy.set_prefer_local_subnets(false);
+  policy.add_subnet_rule("10.73.0.0/16", 0);
+  policy.add_subnet_rule("10.0.0.0/8", 10);
+  policy.add_subnet_rule("192.168.0.0/16", 1000);
+
+  BOOST_REQUIRE_EQUAL(policy.get_rank(*Endpoint::from_numeric("", "10.73.1.2", 0)), 0);
+  BOOST_REQUIRE_EQUAL(policy.get_rank(*Endpoint::from_numeric("", "10.74.1.2", 0)), 10);
+  BOOST_REQUIRE_EQUAL(policy.get_rank(*Endpoint::from_numeric("", "172.16.0.1", 0)), AddressPolicy::kDefaultRank);
+
+  auto endpoints = make_endpoints({ "192.168.1.1", "172.16.0.1", "10.74.0.1", "172.16.0.2", "10.73.0.1" });
+  policy.apply(endpoints);
+  std::vector<std::string> expected{ "10.73.0.1", "10.74.0.1", "172.16.0.1", "172.16.0.2", "192.168.1.1" };
+  BOOST_REQUIRE(get_addresses(endpoints) == expected);
+
+  // Prefixes need not end on a byte boundary
+  policy.add_subnet_rule("172.16.0.2/31", 5);
+  BOOST_REQUIRE_EQUAL(policy.get_rank(*Endpoint::from_numeric("", "172.16.0.3", 0)), 5);
+  BOOST_REQUIRE_EQUAL(policy.get_rank(*Endpoint::from_numeric("", "172.16.0.4", 0)), AddressPolicy::kDefaultRank);
+}
+
+BOOST_AUTO_TEST_CASE(Ipv6)
+{
+  AddressPolicy policy;
+  policy.set_prefer_local_subnets(false);
+  auto endpoints = make_endpoints({ "fd00::1", "10.0.0.1" });
+  policy.apply(endpoints);
+  BOOST_REQUIRE(get_addresses(endpoints) == std::vector<std::string>{ "10.0.0.1" });
+
+  // IPv4 comes first at equal rank, unless a rule says otherwise
+  policy.set_ipv6_enabled(true);
+  endpoints = make_endpoints({ "fd00::1", "10.0.0.1" });
+  policy.apply(endpoints);
+  BOOST_REQUIRE(get_addresses(endpoints) == (std::vector<std::string>{ "10.0.0.1", "fd00::1" }));
+
+  policy.add_subnet_rule("fd00::/8", 0);
+  endpoints = make_endpoints({ "10.0.0.1", "fd00::1" });
+  policy.apply(endpoints);
+  BOOST_REQUIRE(get_addresses(endpoints) == (std::vector<std::string>{ "fd00::1", "10.0.0.1" }));
+
+  // Addresses from backends are kept even without IPv6
+  policy.set_ipv6_enabled(false);
+  endpoints = make_endpoints({ "10.0.0.1", "fd00::1" });
+  policy.apply(endpoints, false);
+  BOOST_REQUIRE_EQUAL(endpoints.size(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(LocalSubnets)
+{
+  AddressPolicy policy;
+  auto loopback = *Endpoint::from_numeric("", "127.0.0.2", 0);
+  BOOST_REQUIRE(policy.is_local(loopback));
+  BOOST_REQUIRE(!policy.is_local(*Endpoint::from_numeric("", "198.51.100.1", 0)));
+
+  auto endpoints = make_endpoints({ "198.51.100.1", "127.0.0.2" });
+  policy.apply(endpoints);
+  BOOST_REQUIRE_EQUAL(endpoints[0].get_address(), "127.0.0.2");
+
+  policy.set_prefer_local_subnets(false);
+  endpoints = make_endpoints({ "198.51.100.1", "127.0.0.2" });
+  policy.apply(endpoints);
+  BOOST_REQUIRE_EQUAL(endpoints[0].get_address(), "198.51.100.1");
+
+  // Interfaces which don't exist here add no rule
+  policy.add_interface_rule("no-such-interface", 0);
+  BOOST_REQUIRE_EQUAL(policy.get_rank(loopback), AddressPolicy::kDefaultRank);
+  policy.add_interface_rule("lo", 1);
+  BOOST_REQUIRE_EQUAL(policy.get_rank(loopback), 1);
+}
+
+BOOST_AUTO_TEST_CASE(FromJson)
+{
+  auto policy = AddressPolicy::from_json(nlohmann::json::parse(R"({
+    "ipv6": true,
+    "prefer_local_subnets": false,
+    "rules": [ { "cidr": "10.73.0.0/16", "rank": 1 }, { "interface": "lo" } ]
+  })"));
+  BOOST_REQUIRE(policy->get_ipv6_enabled());
+  BOOST_REQUIRE(!policy->get_prefer_local_subnets());
+  BOOST_REQUIRE_EQUAL(policy->get_rank(*Endpoint::from_numeric("", "10.73.0.1", 0)), 1);
+  BOOST_REQUIRE_EQUAL(policy->get_rank(*Endpoint::from_numeric("", "127.0.0.1", 0)), 0);
+
+  BOOST_REQUIRE_THROW(AddressPolicy::from_json(nlohmann::json::array()), InvalidResolverConfiguration);
+  BOOST_REQUIRE_THROW(AddressPolicy::from_json(nlohmann::json::parse(R"({"rules": [{"rank": 1}]})")),
+                      InvalidResolverConfiguration);
+  BOOST_REQUIRE_THROW(AddressPolicy::from_json(nlohmann::json::parse(R"({"rules": [{"cidr": 1}]})")),
+                      InvalidResolverConfiguration);
+
+  for (auto cidr : { "10.0.0.0/33", "10.0.0.0/", "10.0.0/8", "fd00::/129", "not-an-address/8", "10.0.0.0/8x" }) {
+    BOOST_REQUIRE_THROW(AddressPolicy().add_subnet_rule(cidr, 0), InvalidResolverConfiguration);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(Resolver)
+{
+  auto backend = std::make_shared<StaticResolverBackend>();
+  backend->add_host("daq-node-01", { "192.168.0.1", "10.73.0.1", "10.0.0.1" });
+  add_resolver_backend(backend);
+
+  auto policy = std::make_shared<AddressPolicy>();
+  policy->add_subnet_rule("10.73.0.0/16", 0);
+  policy->add_subnet_rule("192.168.0.0/16", 1000);
+  set_address_policy(policy);
+  BOOST_REQUIRE(get_address_policy() == policy);
+
+  std::vector<std::string> expected{ "10.73.0.1", "10.0.0.1", "192.168.0.1" };
+  BOOST_REQUIRE(get_ips_from_hostname("daq-node-01") == expected);
+  auto endpoints = resolve_uri_endpoints("tcp://daq-node-01:5555");
+  BOOST_REQUIRE_EQUAL(endpoints[0].to_string(), "tcp://10.73.0.1:5555");
+
+  set_address_policy(nullptr);
+  BOOST_REQUIRE(get_address_policy() != nullptr);
+  BOOST_REQUIRE_EQUAL(get_ips_from_hostname("daq-node-01")[0], "192.168.0.1");
+  clear_resolver_backends();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
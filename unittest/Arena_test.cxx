@@ -0,0 +1,140 @@
+/**
+ *
+ * @file Arena_test.cxx Arena, ArenaAllocator and PageMemory Unit Tests
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/Arena.hpp"
+#include "utilities/PageMemory.hpp"
+
+#define BOOST_TEST_MODULE Arena_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace dunedaq::utilities;
+
+namespace {
+
+bool
+is_aligned(void* pointer, size_t alignment)
+{
+  return reinterpret_cast<uintptr_t>(pointer) % alignment == 0; // NOLINT
+}
+
+struct Hit
+{
+  int channel;
+  double time;
+};
+
+} // namespace ""
+
+BOOST_AUTO_TEST_SUITE(Arena_test)
+
+BOOST_AUTO_TEST_CASE(Pages)
+{
+  PageMemory memory(100, false);
+  BOOST_REQUIRE_EQUAL(memory.size(), PageMemory::get_page_size());
+  BOOST_REQUIRE(is_aligned(memory.data(), PageMemory::get_page_size()));
+  BOOST_REQUIRE_EQUAL(static_cast<char*>(memory.data())[0], 0);
+  std::memset(memory.data(), 1, memory.size());
+
+  auto moved = std::move(memory);
+  BOOST_REQUIRE(memory.data() == nullptr); // NOLINT(bugprone-use-after-move)
+  BOOST_REQUIRE_EQUAL(static_cast<char*>(moved.data())[10], 1);
+
+  // Falls back to normal pages where no huge pages are reserved
+  PageMemory huge(100, true);
+  BOOST_REQUIRE_EQUAL(huge.size(), PageMemory::kHugePageSize);
+  std::memset(huge.data(), 1, huge.size());
+}
+
+BOOST_AUTO_TEST_CASE(AllocateAndReset)
+{
+  Arena arena(ArenaOptions{ 4096, false });
+  auto first = arena.allocate(10, 1);
+  auto second = arena.allocate(8, 8);
+  BOOST_REQUIRE(is_aligned(second, 8));
+  BOOST_REQUIRE_EQUAL(static_cast<char*>(second) - static_cast<char*>(first), 16);
+  BOOST_REQUIRE(is_aligned(arena.allocate(1, 256), 256));
+
+  auto hit = arena.create<Hit>(Hit{ 3, 1.5 });
+  BOOST_REQUIRE_EQUAL(hit->channel, 3);
+
+  for (int i = 0; i < 100; ++i) {
+    arena.allocate(100);
+  }
+  auto stats = arena.get_stats();
+  BOOST_REQUIRE_EQUAL(stats.allocations, 104);
+  BOOST_REQUIRE_GT(stats.chunks, 1);
+  BOOST_REQUIRE_GT(stats.bytes_allocated, 100 * 100);
+
+  // After a reset the same memory is handed out again, with no new chunks
+  arena.reset();
+  BOOST_REQUIRE_EQUAL(arena.allocate(10, 1), first);
+  for (int i = 0; i < 100; ++i) {
+    arena.allocate(100);
+  }
+  BOOST_REQUIRE_EQUAL(arena.get_stats().chunks, stats.chunks);
+  BOOST_REQUIRE_EQUAL(arena.get_stats().resets, 1);
+  BOOST_REQUIRE_EQUAL(arena.get_stats().high_water_mark, stats.high_water_mark);
+
+  arena.release();
+  BOOST_REQUIRE_EQUAL(arena.get_stats().chunks, 0);
+  BOOST_REQUIRE_EQUAL(arena.get_stats().bytes_reserved, 0);
+}
+
+BOOST_AUTO_TEST_CASE(LargeAllocation)
+{
+  Arena arena(ArenaOptions{ 4096, false });
+  arena.allocate(100);
+  auto large = arena.allocate(10000, 4096);
+  BOOST_REQUIRE(is_aligned(large, 4096));
+  std::memset(large, 1, 10000);
+  BOOST_REQUIRE_GE(arena.get_stats().bytes_reserved, 4096 + 10000);
+}
+
+BOOST_AUTO_TEST_CASE(Containers)
+{
+  Arena arena;
+  for (int batch = 0; batch < 3; ++batch) {
+    {
+      std::vector<Hit, ArenaAllocator<Hit>> hits{ ArenaAllocator<Hit>(arena) };
+      for (int i = 0; i < 1000; ++i) {
+        hits.push_back(Hit{ i, i * 0.5 });
+      }
+      BOOST_REQUIRE_EQUAL(hits[999].channel, 999);
+    }
+    arena.reset();
+  }
+  // The first batch reserved all the memory the later ones needed
+  BOOST_REQUIRE_EQUAL(arena.get_stats().chunks, 1);
+
+  Arena other;
+  BOOST_REQUIRE(ArenaAllocator<Hit>(arena) == ArenaAllocator<int>(arena));
+  BOOST_REQUIRE(ArenaAllocator<Hit>(arena) != ArenaAllocator<Hit>(other));
+}
+
+BOOST_AUTO_TEST_CASE(ThreadArenas)
+{
+  Arena* main_arena = &Arena::this_thread();
+  Arena* thread_arena = nullptr;
+  std::thread thread([&]() {
+    thread_arena = &Arena::this_thread();
+    thread_arena->allocate(100);
+  });
+  thread.join();
+  BOOST_REQUIRE(thread_arena != main_arena);
+  BOOST_REQUIRE_EQUAL(&Arena::this_thread(), main_arena);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,103 @@
+/**
+ *
+ * @file Endpoint_test.cxx Endpoint class Unit Tests
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/Endpoint.hpp"
+
+#define BOOST_TEST_MODULE Endpoint_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <arpa/inet.h>
+
+#include <string>
+#include <unordered_set>
+
+using namespace dunedaq::utilities;
+
+BOOST_AUTO_TEST_CASE(Invalid)
+{
+  Endpoint endpoint;
+  BOOST_REQUIRE(!endpoint.is_valid());
+  BOOST_REQUIRE_EQUAL(endpoint.to_string(), "");
+
+  BOOST_REQUIRE(!Endpoint::from_numeric("tcp", "localhost", 5555));
+  BOOST_REQUIRE(!Endpoint::from_numeric("tcp", "10.0.0", 5555));
+  BOOST_REQUIRE(!Endpoint::from_numeric("tcp", "[::1]", 5555));
+}
+
+BOOST_AUTO_TEST_CASE(IPv4)
+{
+  auto endpoint = Endpoint::from_numeric("tcp", "10.0.0.1", 5555);
+  BOOST_REQUIRE(endpoint);
+  BOOST_REQUIRE_EQUAL(endpoint->get_family(), AF_INET);
+  BOOST_REQUIRE_EQUAL(endpoint->get_sockaddr_len(), sizeof(sockaddr_in));
+  BOOST_REQUIRE_EQUAL(endpoint->get_port(), 5555);
+  BOOST_REQUIRE_EQUAL(endpoint->get_address(), "10.0.0.1");
+  BOOST_REQUIRE_EQUAL(endpoint->to_string(), "tcp://10.0.0.1:5555");
+
+  // The sockaddr is usable directly
+  auto in4 = reinterpret_cast<const sockaddr_in*>(endpoint->get_sockaddr()); // NOLINT
+  BOOST_REQUIRE_EQUAL(ntohs(in4->sin_port), 5555);
+
+  // Changing the port or scheme updates the cached string
+  endpoint->set_port(6000);
+  BOOST_REQUIRE_EQUAL(endpoint->to_string(), "tcp://10.0.0.1:6000");
+  endpoint->set_scheme("udp");
+  BOOST_REQUIRE_EQUAL(endpoint->to_string(), "udp://10.0.0.1:6000");
+  endpoint->set_port(0);
+  BOOST_REQUIRE_EQUAL(endpoint->to_string(), "udp://10.0.0.1");
+}
+
+BOOST_AUTO_TEST_CASE(IPv6)
+{
+  auto endpoint = Endpoint::from_numeric("tcp", "fe80::1", 5555);
+  BOOST_REQUIRE(endpoint);
+  BOOST_REQUIRE_EQUAL(endpoint->get_family(), AF_INET6);
+  BOOST_REQUIRE_EQUAL(endpoint->get_address(), "fe80::1");
+  BOOST_REQUIRE_EQUAL(endpoint->to_string(), "tcp://[fe80::1]:5555");
+}
+
+BOOST_AUTO_TEST_CASE(FromSockaddr)
+{
+  sockaddr_in in4{};
+  in4.sin_family = AF_INET;
+  in4.sin_port = htons(1234);
+  inet_pton(AF_INET, "192.168.1.2", &in4.sin_addr);
+
+  Endpoint endpoint("tcp", reinterpret_cast<sockaddr*>(&in4), sizeof(in4)); // NOLINT
+  BOOST_REQUIRE(endpoint.is_valid());
+  BOOST_REQUIRE_EQUAL(endpoint.to_string(), "tcp://192.168.1.2:1234");
+
+  // Only IP addresses are accepted
+  sockaddr unix_addr{};
+  unix_addr.sa_family = AF_UNIX;
+  BOOST_REQUIRE(!Endpoint("ipc", &unix_addr, sizeof(unix_addr)).is_valid());
+}
+
+BOOST_AUTO_TEST_CASE(Comparison)
+{
+  auto a = Endpoint::from_numeric("tcp", "10.0.0.1", 5555);
+  BOOST_REQUIRE(a == Endpoint::from_numeric("tcp", "10.0.0.1", 5555));
+  BOOST_REQUIRE(*a != *Endpoint::from_numeric("tcp", "10.0.0.2", 5555));
+  BOOST_REQUIRE(*a != *Endpoint::from_numeric("tcp", "10.0.0.1", 5556));
+  BOOST_REQUIRE(*a != *Endpoint::from_numeric("udp", "10.0.0.1", 5555));
+  BOOST_REQUIRE(*a != *Endpoint::from_numeric("tcp", "::ffff:10.0.0.1", 5555));
+}
+
+BOOST_AUTO_TEST_CASE(Hash)
+{
+  auto a = Endpoint::from_numeric("tcp", "10.0.0.1", 5555);
+  BOOST_REQUIRE_EQUAL(a->hash(), Endpoint::from_numeric("tcp", "10.0.0.1", 5555)->hash());
+
+  std::unordered_set<Endpoint> endpoints{ *a, *Endpoint::from_numeric("tcp", "10.0.0.2", 5555) };
+  BOOST_REQUIRE(!endpoints.insert(*a).second);
+  BOOST_REQUIRE(endpoints.insert(*Endpoint::from_numeric("tcp", "10.0.0.1", 5556)).second);
+  BOOST_REQUIRE(endpoints.insert(*Endpoint::from_numeric("tcp", "fe80::1", 5555)).second);
+  BOOST_REQUIRE_EQUAL(endpoints.size(), 4);
+}
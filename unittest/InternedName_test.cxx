@@ -0,0 +1,104 @@
+/**
+ *
+ * @file InternedName_test.cxx InternedName class Unit Tests
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/InternedName.hpp"
+
+#define BOOST_TEST_MODULE InternedName_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using namespace dunedaq::utilities;
+
+BOOST_AUTO_TEST_SUITE(InternedName_test)
+
+BOOST_AUTO_TEST_CASE(Interning)
+{
+  InternedName empty;
+  BOOST_REQUIRE(empty.empty());
+  BOOST_REQUIRE_EQUAL(empty.get_id(), 0);
+  BOOST_REQUIRE(empty == InternedName(""));
+
+  std::string text = "trigger_decision_queue";
+  InternedName a(text);
+  InternedName b(std::string_view("trigger_decision_queue"));
+  BOOST_REQUIRE(a == b);
+  BOOST_REQUIRE_EQUAL(a.get_id(), b.get_id());
+  BOOST_REQUIRE_EQUAL(a.str(), text);
+  BOOST_REQUIRE_EQUAL(a.view(), text);
+  BOOST_REQUIRE_EQUAL(a.view().data(), b.view().data());
+
+  InternedName c("fragment_queue");
+  BOOST_REQUIRE(a != c);
+  BOOST_REQUIRE_NE(a.get_id(), c.get_id());
+  BOOST_REQUIRE(a < c || c < a);
+
+  std::ostringstream stream;
+  stream << c;
+  BOOST_REQUIRE_EQUAL(stream.str(), "fragment_queue");
+}
+
+BOOST_AUTO_TEST_CASE(Find)
+{
+  auto size = InternedName::get_pool_size();
+  BOOST_REQUIRE(!InternedName::find("never_interned"));
+  BOOST_REQUIRE_EQUAL(InternedName::get_pool_size(), size);
+
+  InternedName name("now_interned");
+  BOOST_REQUIRE_EQUAL(InternedName::get_pool_size(), size + 1);
+  auto found = InternedName::find("now_interned");
+  BOOST_REQUIRE(found);
+  BOOST_REQUIRE(*found == name);
+}
+
+BOOST_AUTO_TEST_CASE(MapKeys)
+{
+  std::unordered_map<InternedName, int> counts;
+  std::set<InternedName> ordered;
+  for (auto name : { "a", "b", "a", "c", "b", "a" }) {
+    ++counts[InternedName(name)];
+    ordered.insert(InternedName(name));
+  }
+  BOOST_REQUIRE_EQUAL(counts.size(), 3);
+  BOOST_REQUIRE_EQUAL(counts[InternedName("a")], 3);
+  BOOST_REQUIRE_EQUAL(ordered.size(), 3);
+}
+
+BOOST_AUTO_TEST_CASE(Concurrent)
+{
+  constexpr size_t n_threads = 8;
+  constexpr size_t n_names = 1000;
+  std::vector<std::vector<uint32_t>> ids(n_threads); // NOLINT(build/unsigned)
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < n_threads; ++t) {
+    threads.emplace_back([&, t]() {
+      for (size_t i = 0; i < n_names; ++i) {
+        ids[t].push_back(InternedName("concurrent_" + std::to_string(i)).get_id());
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  // Every thread got the same id for each name, and different names got different ids
+  for (size_t t = 1; t < n_threads; ++t) {
+    BOOST_REQUIRE(ids[t] == ids[0]);
+  }
+  BOOST_REQUIRE_EQUAL(std::set<uint32_t>(ids[0].begin(), ids[0].end()).size(), n_names); // NOLINT(build/unsigned)
+  BOOST_REQUIRE_EQUAL(InternedName(std::string("concurrent_") + "42").str(), "concurrent_42");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,184 @@
+/**
+ *
+ * @file LatencyHistogram_test.cxx LatencyHistogram class Unit Tests
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/LatencyHistogram.hpp"
+
+#define BOOST_TEST_MODULE LatencyHistogram_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace dunedaq::utilities;
+
+BOOST_AUTO_TEST_SUITE(LatencyHistogram_test)
+
+BOOST_AUTO_TEST_CASE(Buckets)
+{
+  for (uint64_t value = 0; value < LatencyHistogram::kSubBuckets; ++value) { // NOLINT(build/unsigned)
+    BOOST_REQUIRE_EQUAL(LatencyHistogram::get_bucket_upper_bound(LatencyHistogram::get_bucket_index(value)), value);
+  }
+
+  // Every value lies in its bucket, within the relative error of the bucket's upper bound
+  size_t previous_index = 0;
+  for (uint64_t value = 1; value < (uint64_t(1) << LatencyHistogram::kMaxValueBits); value = value * 9 / 8 + 1) { // NOLINT
+    auto index = LatencyHistogram::get_bucket_index(value);
+    BOOST_REQUIRE_LT(index, LatencyHistogram::kBuckets);
+    BOOST_REQUIRE_GE(index, previous_index);
+    auto upper = LatencyHistogram::get_bucket_upper_bound(index);
+    BOOST_REQUIRE_GE(upper, value);
+    BOOST_REQUIRE_LE(upper - value, value * LatencyHistogram::kRelativeError);
+    if (index > 0) {
+      BOOST_REQUIRE_LT(LatencyHistogram::get_bucket_upper_bound(index - 1), value);
+    }
+    previous_index = index;
+  }
+
+  BOOST_REQUIRE_EQUAL(LatencyHistogram::get_bucket_index(UINT64_MAX), LatencyHistogram::kBuckets - 1);
+}
+
+BOOST_AUTO_TEST_CASE(Percentiles)
+{
+  LatencyHistogram histogram;
+  BOOST_REQUIRE_EQUAL(histogram.get_snapshot().get_count(), 0);
+  BOOST_REQUIRE_EQUAL(histogram.get_snapshot().get_percentile(0.99), 0);
+
+  for (int i = 1; i <= 10000; ++i) {
+    histogram.record(std::chrono::nanoseconds(i));
+  }
+  auto snapshot = histogram.get_snapshot();
+  BOOST_REQUIRE_EQUAL(snapshot.get_count(), 10000);
+  BOOST_REQUIRE_EQUAL(snapshot.get_min(), 1);
+  BOOST_REQUIRE_EQUAL(snapshot.get_max(), 10000);
+  BOOST_REQUIRE_CLOSE(snapshot.get_mean(), 5000.5, 0.001);
+  BOOST_REQUIRE_CLOSE(static_cast<double>(snapshot.get_percentile(0.5)), 5000., 100 * LatencyHistogram::kRelativeError);
+  BOOST_REQUIRE_CLOSE(static_cast<double>(snapshot.get_percentile(0.99)), 9900., 100 * LatencyHistogram::kRelativeError);
+  BOOST_REQUIRE_LE(snapshot.get_percentile(0.999), 10000);
+  BOOST_REQUIRE_EQUAL(snapshot.get_percentile(1.), 10000);
+
+  // Beyond the range, only the maximum is exact
+  histogram.record(uint64_t(1) << 50); // NOLINT(build/unsigned)
+  BOOST_REQUIRE_EQUAL(histogram.get_snapshot().get_max(), uint64_t(1) << 50); // NOLINT(build/unsigned)
+  BOOST_REQUIRE_EQUAL(histogram.get_snapshot().get_percentile(1.), uint64_t(1) << 50); // NOLINT(build/unsigned)
+
+  histogram.reset();
+  BOOST_REQUIRE_EQUAL(histogram.get_snapshot().get_count(), 0);
+  BOOST_REQUIRE_EQUAL(histogram.get_snapshot().get_max(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(Threads)
+{
+  constexpr int n_threads = 4;
+  constexpr int n_values = 100000;
+  LatencyHistogram histogram;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < n_threads; ++t) {
+    threads.emplace_back([&, t]() {
+      for (int i = 0; i < n_values; ++i) {
+        histogram.record(static_cast<uint64_t>(1000 * (t + 1))); // NOLINT(build/unsigned)
+      }
+    });
+  }
+  // Reading while the threads record
+  while (histogram.get_snapshot().get_count() < n_values) {
+    std::this_thread::yield();
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  // Shards of threads which have exited are still counted
+  auto snapshot = histogram.get_snapshot();
+  BOOST_REQUIRE_EQUAL(snapshot.get_count(), n_threads * n_values);
+  BOOST_REQUIRE_EQUAL(snapshot.get_min(), 1000);
+  BOOST_REQUIRE_EQUAL(snapshot.get_max(), 1000 * n_threads);
+  BOOST_REQUIRE_CLOSE(snapshot.get_mean(), 2500., 0.001);
+}
+
+BOOST_AUTO_TEST_CASE(ManyHistograms)
+{
+  // Histograms created where earlier ones were destroyed don't see
+  // their values through this thread's cache of shards
+  for (int i = 0; i < 100; ++i) {
+    auto histogram = std::make_unique<LatencyHistogram>();
+    histogram->record(uint64_t(i)); // NOLINT(build/unsigned)
+    BOOST_REQUIRE_EQUAL(histogram->get_snapshot().get_count(), 1);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(CachedShards)
+{
+  // More histograms than this thread's cache of shards holds, many of
+  // them sharing a set of the cache, used in turn
+  std::vector<std::unique_ptr<LatencyHistogram>> histograms;
+  for (int i = 0; i < 80; ++i) {
+    histograms.push_back(std::make_unique<LatencyHistogram>());
+  }
+  for (int round = 0; round < 3; ++round) {
+    for (size_t i = 0; i < histograms.size(); i += (round == 1 ? 16 : 1)) {
+      histograms[i]->record(uint64_t(i)); // NOLINT(build/unsigned)
+    }
+  }
+  for (size_t i = 0; i < histograms.size(); ++i) {
+    auto snapshot = histograms[i]->get_snapshot();
+    BOOST_REQUIRE_EQUAL(snapshot.get_count(), i % 16 == 0 ? 3 : 2);
+    BOOST_REQUIRE_EQUAL(snapshot.get_max(), i);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(Timers)
+{
+  LatencyHistogram histogram;
+  {
+    LatencyTimer timer(histogram);
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  }
+  {
+    LatencyTimer timer(histogram);
+    timer.cancel();
+  }
+  {
+    LatencyTimer timer(histogram);
+    auto elapsed = timer.stop();
+    BOOST_REQUIRE_GE(elapsed.count(), 0);
+  }
+  auto result = time_call(histogram, []() { return 42; });
+  BOOST_REQUIRE_EQUAL(result, 42);
+
+  auto snapshot = histogram.get_snapshot();
+  BOOST_REQUIRE_EQUAL(snapshot.get_count(), 3);
+  BOOST_REQUIRE_GE(snapshot.get_max(), 2000000);
+}
+
+BOOST_AUTO_TEST_CASE(Json)
+{
+  LatencyHistogram histogram;
+  histogram.record(uint64_t(10));  // NOLINT(build/unsigned)
+  histogram.record(uint64_t(10));  // NOLINT(build/unsigned)
+  histogram.record(uint64_t(100)); // NOLINT(build/unsigned)
+
+  auto json = histogram.get_snapshot().to_json();
+  BOOST_REQUIRE_EQUAL(json.at("count").get<uint64_t>(), 3); // NOLINT(build/unsigned)
+  BOOST_REQUIRE_EQUAL(json.at("min").get<uint64_t>(), 10);  // NOLINT(build/unsigned)
+  BOOST_REQUIRE_EQUAL(json.at("p50").get<uint64_t>(), 10);  // NOLINT(build/unsigned)
+  BOOST_REQUIRE_EQUAL(json.at("p999").get<uint64_t>(), 100); // NOLINT(build/unsigned)
+  BOOST_REQUIRE_EQUAL(json.at("max").get<uint64_t>(), 100); // NOLINT(build/unsigned)
+  BOOST_REQUIRE(!json.contains("buckets"));
+
+  auto buckets = histogram.get_snapshot().to_json(true).at("buckets");
+  BOOST_REQUIRE_EQUAL(buckets.size(), 2);
+  BOOST_REQUIRE_EQUAL(buckets[0][0].get<uint64_t>(), 10); // NOLINT(build/unsigned)
+  BOOST_REQUIRE_EQUAL(buckets[0][1].get<uint64_t>(), 2);  // NOLINT(build/unsigned)
+}
+
+BOOST_AUTO_TEST_SUITE_END()
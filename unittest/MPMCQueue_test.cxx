@@ -0,0 +1,103 @@
+/**
+ *
+ * @file MPMCQueue_test.cxx MPMCQueue class Unit Tests
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/MPMCQueue.hpp"
+
+#define BOOST_TEST_MODULE MPMCQueue_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <thread>
+#include <vector>
+
+using namespace dunedaq::utilities;
+
+BOOST_AUTO_TEST_SUITE(MPMCQueue_test)
+
+BOOST_AUTO_TEST_CASE(ProducersConsumers)
+{
+  // Producers push distinct values, some in batches; every value must be popped exactly once
+  constexpr int n_producers = 4;
+  constexpr int n_consumers = 4;
+  constexpr int n_per_producer = 50000;
+  MPMCQueue<int> queue(256);
+  std::atomic<bool> running{ true };
+  std::atomic<int> n_producing{ n_producers };
+  // Boost.Test checks are not thread-safe, so the threads only count failures
+  std::atomic<int> failures{ 0 };
+
+  std::vector<std::thread> producers;
+  for (int p = 0; p < n_producers; ++p) {
+    producers.emplace_back([&, p]() {
+      std::vector<int> batch;
+      for (int i = 0; i < n_per_producer; ++i) {
+        auto value = p * n_per_producer + i;
+        if (p % 2 == 0) {
+          if (!queue.push_wait(value, running)) {
+            ++failures;
+          }
+          continue;
+        }
+        batch.push_back(value);
+        if (batch.size() == 16 || i == n_per_producer - 1) {
+          auto next = batch.begin();
+          while (next != batch.end()) {
+            auto pushed = queue.try_push_batch(next, batch.end());
+            if (pushed == next) {
+              std::this_thread::yield();
+            }
+            next = pushed;
+          }
+          batch.clear();
+        }
+      }
+      --n_producing;
+    });
+  }
+
+  std::vector<std::vector<int>> popped(n_consumers);
+  std::vector<std::thread> consumers;
+  for (int c = 0; c < n_consumers; ++c) {
+    consumers.emplace_back([&, c]() {
+      int value;
+      while (n_producing.load() > 0 || !queue.empty()) {
+        if (c % 2 == 0) {
+          if (queue.try_pop_batch(std::back_inserter(popped[c]), 8) == 0) {
+            std::this_thread::yield();
+          }
+        } else if (queue.try_pop(value)) {
+          popped[c].push_back(value);
+        } else {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  for (auto& thread : producers) {
+    thread.join();
+  }
+  for (auto& thread : consumers) {
+    thread.join();
+  }
+
+  std::vector<int> counts(n_producers * n_per_producer, 0);
+  for (auto& values : popped) {
+    for (auto value : values) {
+      ++counts[value];
+    }
+  }
+  BOOST_REQUIRE_EQUAL(failures.load(), 0);
+  BOOST_REQUIRE(std::all_of(counts.begin(), counts.end(), [](int count) { return count == 1; }));
+  BOOST_REQUIRE(queue.empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,154 @@
+/**
+ *
+ * @file MetricsExporter_test.cxx MetricsExporter class Unit Tests
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/MetricsExporter.hpp"
+#include "utilities/Issues.hpp"
+#include "utilities/Metrics.hpp"
+
+#define BOOST_TEST_MODULE MetricsExporter_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace dunedaq::utilities;
+
+BOOST_AUTO_TEST_SUITE(MetricsExporter_test)
+
+BOOST_AUTO_TEST_CASE(Sink)
+{
+  std::mutex mutex;
+  std::vector<nlohmann::json> reports;
+  MetricsExporter exporter(std::chrono::milliseconds(10), [&](nlohmann::json const& report) {
+    std::lock_guard<std::mutex> lk(mutex);
+    reports.push_back(report);
+  });
+
+  auto counter = get_counter("test.exported");
+  exporter.start();
+  BOOST_REQUIRE(exporter.is_running());
+  counter.increment(100);
+  std::this_thread::sleep_for(std::chrono::milliseconds(55));
+  exporter.stop();
+  BOOST_REQUIRE(!exporter.is_running());
+
+  std::lock_guard<std::mutex> lk(mutex);
+  BOOST_REQUIRE_GE(reports.size(), 2);
+
+  // The last report is made on stop, and sees everything counted
+  auto& last = reports.back();
+  BOOST_REQUIRE_EQUAL(last.at("counters").at("test.exported").get<uint64_t>(), 100); // NOLINT(build/unsigned)
+  BOOST_REQUIRE(last.contains("time_ms"));
+  BOOST_REQUIRE(last.contains("interval_ms"));
+
+  // The rates, times the intervals, add up to the increase
+  double total = 0;
+  for (auto& report : reports) {
+    total += report.at("rates").at("test.exported").get<double>() * report.at("interval_ms").get<double>() / 1000.;
+  }
+  BOOST_REQUIRE_CLOSE(total, 100., 10.);
+}
+
+BOOST_AUTO_TEST_CASE(File)
+{
+  auto path = "/tmp/MetricsExporter_test_" + std::to_string(getpid()) + ".jsonl";
+  {
+    MetricsExporter exporter(std::chrono::milliseconds(1000), path);
+    exporter.start();
+    get_counter("test.exported_to_file").increment();
+    exporter.export_now();
+    exporter.stop();
+  }
+
+  std::ifstream file(path);
+  std::string line;
+  int lines = 0;
+  while (std::getline(file, line)) {
+    auto report = nlohmann::json::parse(line);
+    BOOST_REQUIRE_EQUAL(report.at("counters").at("test.exported_to_file").get<uint64_t>(), 1); // NOLINT
+    ++lines;
+  }
+  BOOST_REQUIRE_EQUAL(lines, 2);
+  std::remove(path.c_str());
+
+  BOOST_REQUIRE_THROW(MetricsExporter(std::chrono::milliseconds(1000), "/nonexistent/dir/metrics.jsonl"),
+                      MetricsExportFailed);
+}
+
+BOOST_AUTO_TEST_CASE(FailingSink)
+{
+  std::atomic<int> calls{ 0 };
+  auto sink = [&](nlohmann::json const&) {
+    ++calls;
+    throw std::runtime_error("sink failed");
+  };
+  {
+    MetricsExporter exporter(std::chrono::milliseconds(5), sink);
+    exporter.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    // The destructor stops the exporter, and the last report only warns
+  }
+  BOOST_REQUIRE_GE(calls.load(), 2);
+
+  MetricsExporter exporter(std::chrono::milliseconds(1000), sink);
+  BOOST_REQUIRE_THROW(exporter.export_now(), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(ConcurrentReports)
+{
+  std::mutex mutex;
+  std::vector<int64_t> times;
+  std::atomic<int> in_sink{ 0 };
+  std::atomic<int> overlaps{ 0 };
+  MetricsExporter exporter(std::chrono::milliseconds(1), [&](nlohmann::json const& report) {
+    if (++in_sink > 1) {
+      ++overlaps;
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+    {
+      std::lock_guard<std::mutex> lk(mutex);
+      times.push_back(report.at("time_ms").get<int64_t>());
+    }
+    --in_sink;
+  });
+
+  // Reports made on several threads, and on the exporter's, reach the sink one at a time and in order
+  exporter.start();
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&]() {
+      for (int i = 0; i < 20; ++i) {
+        exporter.export_now();
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  exporter.stop();
+
+  BOOST_REQUIRE_EQUAL(overlaps.load(), 0);
+  std::lock_guard<std::mutex> lk(mutex);
+  BOOST_REQUIRE_GE(times.size(), 4 * 20 + 1);
+  BOOST_REQUIRE(std::is_sorted(times.begin(), times.end()));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,133 @@
+/**
+ *
+ * @file Metrics_test.cxx Metrics Unit Tests
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/Metrics.hpp"
+#include "utilities/WorkerThread.hpp"
+
+#define BOOST_TEST_MODULE Metrics_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+using namespace dunedaq::utilities;
+
+BOOST_AUTO_TEST_SUITE(Metrics_test)
+
+BOOST_AUTO_TEST_CASE(Counters)
+{
+  auto counter = get_counter("test.counter");
+  BOOST_REQUIRE_EQUAL(counter.get_name(), "test.counter");
+  BOOST_REQUIRE_EQUAL(counter.get_value(), 0);
+
+  counter.increment();
+  counter.increment(41);
+  BOOST_REQUIRE_EQUAL(counter.get_value(), 42);
+
+  // The same name gives the same counter, while a gauge of that name is separate
+  BOOST_REQUIRE_EQUAL(get_counter("test.counter").get_value(), 42);
+  BOOST_REQUIRE_EQUAL(get_gauge("test.counter").get_value(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(CounterThreads)
+{
+  constexpr int n_threads = 4;
+  constexpr int n_increments = 100000;
+  auto counter = get_counter("test.counter_threads");
+  std::atomic<bool> keep_running{ true };
+
+  // A thread which stays alive while the others exit
+  std::thread live([&]() {
+    counter.increment();
+    while (keep_running.load()) {
+      std::this_thread::yield();
+    }
+  });
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < n_threads; ++t) {
+    threads.emplace_back([&]() {
+      for (int i = 0; i < n_increments; ++i) {
+        counter.increment();
+      }
+    });
+  }
+  // Reading while the threads increment
+  while (counter.get_value() < n_increments) {
+    std::this_thread::yield();
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  // Counts of threads which have exited are kept
+  BOOST_REQUIRE_EQUAL(counter.get_value(), n_threads * n_increments + 1);
+  keep_running = false;
+  live.join();
+  BOOST_REQUIRE_EQUAL(counter.get_value(), n_threads * n_increments + 1);
+}
+
+BOOST_AUTO_TEST_CASE(Gauges)
+{
+  auto gauge = get_gauge("test.gauge");
+  gauge.increment();
+  gauge.add(10);
+  gauge.decrement();
+  BOOST_REQUIRE_EQUAL(gauge.get_value(), 10);
+
+  // Raised on one thread, lowered on another
+  std::thread([&]() { gauge.add(-25); }).join();
+  BOOST_REQUIRE_EQUAL(gauge.get_value(), -15);
+
+  gauge.set(7);
+  BOOST_REQUIRE_EQUAL(gauge.get_value(), 7);
+  gauge.increment();
+  BOOST_REQUIRE_EQUAL(gauge.get_value(), 8);
+}
+
+BOOST_AUTO_TEST_CASE(Snapshot)
+{
+  get_counter("test.snapshot_counter").increment(3);
+  get_gauge("test.snapshot_gauge").add(-2);
+  auto& histogram = get_latency_histogram("test.snapshot_histogram");
+  BOOST_REQUIRE_EQUAL(&histogram, &get_latency_histogram("test.snapshot_histogram"));
+  histogram.record(uint64_t(100)); // NOLINT(build/unsigned)
+
+  auto snapshot = get_metrics_snapshot();
+  BOOST_REQUIRE_EQUAL(snapshot.at("counters").at("test.snapshot_counter").get<uint64_t>(), 3); // NOLINT(build/unsigned)
+  BOOST_REQUIRE_EQUAL(snapshot.at("gauges").at("test.snapshot_gauge").get<int64_t>(), -2);
+  BOOST_REQUIRE_EQUAL(snapshot.at("histograms").at("test.snapshot_histogram").at("count").get<uint64_t>(), // NOLINT
+                      1);
+  BOOST_REQUIRE(!snapshot.at("counters").contains("test.snapshot_gauge"));
+}
+
+BOOST_AUTO_TEST_CASE(WorkerThreadMetrics)
+{
+  auto starts = get_counter("worker_thread.starts").get_value();
+  auto stops = get_counter("worker_thread.stops").get_value();
+  auto running = get_gauge("worker_thread.running").get_value();
+
+  WorkerThread worker([](std::atomic<bool>& running_flag) {
+    while (running_flag.load()) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  });
+  worker.start_working_thread();
+  BOOST_REQUIRE_EQUAL(get_counter("worker_thread.starts").get_value(), starts + 1);
+  BOOST_REQUIRE_EQUAL(get_gauge("worker_thread.running").get_value(), running + 1);
+  worker.stop_working_thread();
+  BOOST_REQUIRE_EQUAL(get_counter("worker_thread.stops").get_value(), stops + 1);
+  BOOST_REQUIRE_EQUAL(get_gauge("worker_thread.running").get_value(), running);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
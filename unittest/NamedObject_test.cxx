@@ -17,6 +17,7 @@
 
 #include <string>
 #include <type_traits>
+#include <utility>
 
 BOOST_AUTO_TEST_SUITE(NamedObject_test)
 
@@ -54,4 +55,20 @@ BOOST_AUTO_TEST_CASE(NamedObject)
   BOOST_REQUIRE(std::is_move_assignable_v<DerivesFromNamedObject>);
 }
 
+BOOST_AUTO_TEST_CASE(InternedNames)
+{
+  dunedaq::utilities::NamedObject a("queue_a");
+  dunedaq::utilities::NamedObject also_a(dunedaq::utilities::InternedName("queue_a"));
+  dunedaq::utilities::NamedObject b("queue_b");
+
+  BOOST_REQUIRE_EQUAL(a.get_name(), "queue_a");
+  BOOST_REQUIRE(a.get_interned_name() == also_a.get_interned_name());
+  BOOST_REQUIRE(a.get_interned_name() != b.get_interned_name());
+  // Objects with the same name share its storage
+  BOOST_REQUIRE_EQUAL(&a.get_name(), &also_a.get_name());
+
+  dunedaq::utilities::NamedObject moved(std::move(a));
+  BOOST_REQUIRE_EQUAL(moved.get_name(), "queue_a");
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,144 @@
+/**
+ *
+ * @file NamedRegistry_test.cxx NamedRegistry class Unit Tests
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/Issues.hpp"
+#include "utilities/NamedRegistry.hpp"
+
+#define BOOST_TEST_MODULE NamedRegistry_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace dunedaq::utilities;
+
+namespace {
+
+class Queue : public NamedObject
+{
+public:
+  explicit Queue(std::string const& name)
+    : NamedObject(name)
+  {}
+};
+
+} // namespace ""
+
+BOOST_AUTO_TEST_SUITE(NamedRegistry_test)
+
+BOOST_AUTO_TEST_CASE(AddFindRemove)
+{
+  NamedRegistry<Queue> registry;
+  auto a = std::make_shared<Queue>("queue_a");
+  auto b = std::make_shared<Queue>("queue_b");
+
+  auto registration_a = registry.add(a);
+  {
+    auto registration_b = registry.add(b);
+    BOOST_REQUIRE(registration_b.is_registered());
+    BOOST_REQUIRE_EQUAL(registry.size(), 2);
+    BOOST_REQUIRE(registry.find("queue_a") == a);
+    BOOST_REQUIRE(registry.find(InternedName("queue_b")) == b);
+    BOOST_REQUIRE(registry.find("queue_c") == nullptr);
+    BOOST_REQUIRE_EQUAL(registry.get_all().size(), 2);
+  }
+
+  // The registration of b has gone out of scope
+  BOOST_REQUIRE(registry.find("queue_b") == nullptr);
+  BOOST_REQUIRE_EQUAL(registry.size(), 1);
+
+  registration_a.reset();
+  BOOST_REQUIRE(!registration_a.is_registered());
+  BOOST_REQUIRE(registry.find("queue_a") == nullptr);
+  BOOST_REQUIRE_EQUAL(registry.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(Lifetime)
+{
+  NamedRegistry<> registry;
+  auto object = std::make_shared<NamedObject>("module");
+  auto registration = registry.add(object);
+  BOOST_REQUIRE_THROW(auto duplicate = registry.add(std::make_shared<NamedObject>("module")),
+                      NameAlreadyRegistered);
+
+  // Destroyed objects are not returned, and their name can be reused
+  object.reset();
+  BOOST_REQUIRE(registry.find("module") == nullptr);
+  BOOST_REQUIRE(registry.get_all().empty());
+  auto replacement = std::make_shared<NamedObject>("module");
+  auto replacement_registration = registry.add(replacement);
+  BOOST_REQUIRE(registry.find("module") == replacement);
+
+  // The stale registration must not remove the replacement
+  registration.reset();
+  BOOST_REQUIRE(registry.find("module") == replacement);
+
+  // Registrations can be moved, eg into the object's owner
+  NamedRegistry<>::Registration moved;
+  moved = std::move(replacement_registration);
+  BOOST_REQUIRE(!replacement_registration.is_registered()); // NOLINT(bugprone-use-after-move)
+  BOOST_REQUIRE(registry.find("module") == replacement);
+  moved = NamedRegistry<>::Registration();
+  BOOST_REQUIRE(registry.find("module") == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(ConcurrentLookups)
+{
+  NamedRegistry<Queue> registry;
+  std::vector<std::shared_ptr<Queue>> queues;
+  std::vector<NamedRegistry<Queue>::Registration> registrations;
+  for (int i = 0; i < 100; ++i) {
+    queues.push_back(std::make_shared<Queue>("queue_" + std::to_string(i)));
+    registrations.push_back(registry.add(queues.back()));
+  }
+
+  // Readers look up the stable names while a writer keeps changing the registry
+  std::atomic<bool> running{ true };
+  std::atomic<size_t> failures{ 0 };
+  std::atomic<size_t> lookups{ 0 };
+  std::vector<std::thread> readers;
+  for (int t = 0; t < 4; ++t) {
+    readers.emplace_back([&]() {
+      std::vector<InternedName> names;
+      for (int i = 0; i < 100; ++i) {
+        names.emplace_back("queue_" + std::to_string(i));
+      }
+      size_t n = 0;
+      while (running.load()) {
+        for (size_t i = 0; i < names.size(); ++i, ++n) {
+          if (registry.find(names[i]) != queues[i]) {
+            ++failures;
+          }
+        }
+      }
+      lookups += n;
+    });
+  }
+
+  for (int i = 0; i < 200; ++i) {
+    auto transient = std::make_shared<Queue>("transient_" + std::to_string(i % 10));
+    auto registration = registry.add(transient);
+    BOOST_REQUIRE(registry.find(transient->get_interned_name()) == transient);
+  }
+  running = false;
+  for (auto& reader : readers) {
+    reader.join();
+  }
+
+  BOOST_REQUIRE_EQUAL(failures.load(), 0);
+  BOOST_REQUIRE_GT(lookups.load(), 0);
+  BOOST_REQUIRE_EQUAL(registry.size(), 100);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
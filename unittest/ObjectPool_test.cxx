@@ -0,0 +1,209 @@
+/**
+ *
+ * @file ObjectPool_test.cxx FixedSizePool, ObjectPool and PoolAllocator Unit Tests
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/Issues.hpp"
+#include "utilities/ObjectPool.hpp"
+#include "utilities/PageMemory.hpp"
+
+#define BOOST_TEST_MODULE ObjectPool_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace dunedaq::utilities;
+
+namespace {
+
+struct Payload
+{
+  static std::atomic<int> s_live;
+
+  explicit Payload(int value_, bool fail = false)
+    : value(value_)
+  {
+    if (fail) {
+      throw std::runtime_error("Payload construction failed");
+    }
+    ++s_live;
+  }
+  ~Payload() { --s_live; }
+
+  int value;
+  char data[100];
+};
+std::atomic<int> Payload::s_live{ 0 };
+
+bool
+is_aligned(void* pointer, size_t alignment)
+{
+  return reinterpret_cast<uintptr_t>(pointer) % alignment == 0; // NOLINT
+}
+
+} // namespace ""
+
+BOOST_AUTO_TEST_SUITE(ObjectPool_test)
+
+BOOST_AUTO_TEST_CASE(FixedSizeBlocks)
+{
+  FixedSizePool pool(24, 8, PoolOptions{ 16, 4, false });
+  BOOST_REQUIRE_EQUAL(pool.get_block_size(), 24);
+
+  std::set<void*> blocks;
+  for (int i = 0; i < 40; ++i) {
+    auto block = pool.allocate();
+    BOOST_REQUIRE(is_aligned(block, 8));
+    BOOST_REQUIRE(blocks.insert(block).second);
+  }
+  for (auto block : blocks) {
+    pool.deallocate(block);
+  }
+
+  auto stats = pool.get_stats();
+  BOOST_REQUIRE_EQUAL(stats.allocations, 40);
+  BOOST_REQUIRE_EQUAL(stats.deallocations, 40);
+  BOOST_REQUIRE_EQUAL(stats.blocks_in_use, 0);
+  BOOST_REQUIRE_GE(stats.blocks_reserved, 40);
+  BOOST_REQUIRE_EQUAL(stats.bytes_reserved % PageMemory::get_page_size(), 0);
+
+  // Freed blocks are reused without growing the pool
+  for (int i = 0; i < 40; ++i) {
+    BOOST_REQUIRE(blocks.count(pool.allocate()) == 1);
+  }
+  BOOST_REQUIRE_EQUAL(pool.get_stats().chunks, stats.chunks);
+}
+
+BOOST_AUTO_TEST_CASE(Alignment)
+{
+  FixedSizePool pool(24, 64);
+  for (int i = 0; i < 10; ++i) {
+    BOOST_REQUIRE(is_aligned(pool.allocate(), 64));
+  }
+
+  BOOST_REQUIRE_EXCEPTION(
+    FixedSizePool(24, 24), InvalidPoolConfiguration, [](InvalidPoolConfiguration const&) { return true; });
+  BOOST_REQUIRE_EXCEPTION(
+    FixedSizePool(0), InvalidPoolConfiguration, [](InvalidPoolConfiguration const&) { return true; });
+}
+
+BOOST_AUTO_TEST_CASE(HugePages)
+{
+  // Falls back to normal pages where no huge pages are reserved
+  FixedSizePool pool(64, 64, PoolOptions{ 16, 4, true });
+  auto block = pool.allocate();
+  pool.deallocate(block);
+  auto stats = pool.get_stats();
+  BOOST_REQUIRE_EQUAL(stats.bytes_reserved % PageMemory::kHugePageSize, 0);
+  BOOST_REQUIRE_EQUAL(stats.blocks_reserved, PageMemory::kHugePageSize / 64);
+}
+
+BOOST_AUTO_TEST_CASE(Objects)
+{
+  ObjectPool<Payload> pool;
+  {
+    auto first = pool.create(1);
+    auto second = pool.create(2);
+    BOOST_REQUIRE_EQUAL(first->value, 1);
+    BOOST_REQUIRE_EQUAL(second->value, 2);
+    BOOST_REQUIRE_EQUAL(Payload::s_live, 2);
+    BOOST_REQUIRE_EQUAL(pool.get_stats().blocks_in_use, 2);
+  }
+  BOOST_REQUIRE_EQUAL(Payload::s_live, 0);
+  BOOST_REQUIRE_EQUAL(pool.get_stats().blocks_in_use, 0);
+
+  // A failed construction gives the block back
+  BOOST_REQUIRE_THROW(pool.construct(3, true), std::runtime_error);
+  BOOST_REQUIRE_EQUAL(pool.get_stats().blocks_in_use, 0);
+}
+
+BOOST_AUTO_TEST_CASE(CrossThreadFree)
+{
+  // Objects created on one thread and destroyed on another, as when
+  // payloads are handed from a producer to a worker
+  constexpr int n_threads = 4;
+  constexpr int n_objects = 20000;
+  ObjectPool<Payload> pool(PoolOptions{ 64, 32, false });
+  std::vector<std::vector<ObjectPool<Payload>::Ptr>> created(n_threads);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < n_threads; ++t) {
+    threads.emplace_back([&, t]() {
+      for (int i = 0; i < n_objects; ++i) {
+        created[t].push_back(pool.create(i));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  threads.clear();
+
+  // Each thread destroys what its neighbour created
+  for (int t = 0; t < n_threads; ++t) {
+    threads.emplace_back([&, t]() { created[(t + 1) % n_threads].clear(); });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  auto stats = pool.get_stats();
+  BOOST_REQUIRE_EQUAL(Payload::s_live, 0);
+  BOOST_REQUIRE_EQUAL(stats.allocations, n_threads * n_objects);
+  BOOST_REQUIRE_EQUAL(stats.deallocations, n_threads * n_objects);
+  BOOST_REQUIRE_EQUAL(stats.blocks_in_use, 0);
+  // Threads moved blocks in batches rather than one at a time
+  BOOST_REQUIRE_LT(stats.central_transfers, stats.allocations / 4);
+}
+
+BOOST_AUTO_TEST_CASE(PoolDestroyedBeforeThread)
+{
+  auto pool = std::make_unique<FixedSizePool>(32);
+  pool->deallocate(pool->allocate());
+  pool.reset();
+
+  // This thread's cache of the old pool is dropped when it uses a new one
+  FixedSizePool other(32);
+  other.deallocate(other.allocate());
+  BOOST_REQUIRE_EQUAL(other.get_stats().allocations, 1);
+}
+
+BOOST_AUTO_TEST_CASE(Containers)
+{
+  auto& pool = FixedSizePool::get_size_class_pool(sizeof(std::map<int, std::string>::value_type) + 32);
+  auto allocations = pool.get_stats().allocations;
+  {
+    std::map<int, std::string, std::less<int>, PoolAllocator<std::pair<const int, std::string>>> map;
+    std::list<int, PoolAllocator<int>> list;
+    for (int i = 0; i < 1000; ++i) {
+      map.emplace(i, std::to_string(i));
+      list.push_back(i);
+    }
+    BOOST_REQUIRE_EQUAL(map.at(500), "500");
+    BOOST_REQUIRE_EQUAL(list.back(), 999);
+
+    // Too large for the size classes, so from operator new
+    std::vector<int, PoolAllocator<int>> vector(FixedSizePool::kMaxSizeClass, 1);
+    BOOST_REQUIRE_EQUAL(vector.size(), FixedSizePool::kMaxSizeClass);
+  }
+  BOOST_REQUIRE_GE(pool.get_stats().allocations, allocations + 1000);
+  BOOST_REQUIRE(PoolAllocator<int>() == PoolAllocator<double>());
+  BOOST_REQUIRE_EQUAL(&FixedSizePool::get_size_class_pool(1), &FixedSizePool::get_size_class_pool(16));
+  BOOST_REQUIRE_NE(&FixedSizePool::get_size_class_pool(16), &FixedSizePool::get_size_class_pool(17));
+  BOOST_REQUIRE_EQUAL(FixedSizePool::get_size_class_pool(600).get_block_size(), 1024);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,163 @@
+/**
+ *
+ * @file Queue_test.cxx Unit Tests shared by the SPSCQueue and MPMCQueue classes
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/MPMCQueue.hpp"
+#include "utilities/SPSCQueue.hpp"
+#include "utilities/WorkerThread.hpp"
+
+#define BOOST_TEST_MODULE Queue_test // NOLINT
+
+#include "boost/mpl/list.hpp"
+#include "boost/test/unit_test.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace dunedaq::utilities;
+
+namespace {
+
+/**
+ * @brief Counts live instances, to check that the queue destroys what it constructs
+ */
+struct Counted
+{
+  static inline int s_live = 0;
+
+  explicit Counted(int v = 0)
+    : value(v)
+  {
+    ++s_live;
+  }
+  Counted(Counted const& other)
+    : value(other.value)
+  {
+    ++s_live;
+  }
+  Counted(Counted&& other) noexcept
+    : value(other.value)
+  {
+    ++s_live;
+  }
+  Counted& operator=(Counted const&) = default;
+  Counted& operator=(Counted&&) noexcept = default;
+  ~Counted() { --s_live; }
+
+  int value;
+};
+
+/**
+ * @brief Names a queue class template, so that the cases can be run for each
+ */
+template<template<typename> class Queue>
+struct QueueKind
+{
+  template<typename T>
+  using queue_t = Queue<T>;
+};
+
+using queue_kinds = boost::mpl::list<QueueKind<SPSCQueue>, QueueKind<MPMCQueue>>;
+
+} // namespace ""
+
+BOOST_AUTO_TEST_SUITE(Queue_test)
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(PushPop, Kind, queue_kinds)
+{
+  typename Kind::template queue_t<std::string> queue(3);
+  BOOST_REQUIRE_EQUAL(queue.capacity(), 4);
+  BOOST_REQUIRE(queue.empty());
+
+  std::string value;
+  BOOST_REQUIRE(!queue.try_pop(value));
+  for (int i = 0; i < 4; ++i) {
+    BOOST_REQUIRE(queue.try_push(std::to_string(i)));
+  }
+  BOOST_REQUIRE(!queue.try_emplace("full"));
+  BOOST_REQUIRE_EQUAL(queue.size_approx(), 4);
+
+  // Wrap around the ring a few times
+  for (int i = 0; i < 20; ++i) {
+    BOOST_REQUIRE(queue.try_pop(value));
+    BOOST_REQUIRE_EQUAL(value, std::to_string(i));
+    BOOST_REQUIRE(queue.try_emplace(std::to_string(i + 4)));
+  }
+  BOOST_REQUIRE_EQUAL(queue.size_approx(), 4);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(Batches, Kind, queue_kinds)
+{
+  typename Kind::template queue_t<int> queue(8);
+  std::vector<int> input{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+  auto next = queue.try_push_batch(input.begin(), input.end());
+  BOOST_REQUIRE(next == input.begin() + 8);
+  BOOST_REQUIRE(queue.try_push_batch(next, input.end()) == next);
+
+  std::vector<int> output;
+  BOOST_REQUIRE_EQUAL(queue.try_pop_batch(std::back_inserter(output), 5), 5);
+  BOOST_REQUIRE(queue.try_push_batch(next, input.end()) == input.end());
+  BOOST_REQUIRE_EQUAL(queue.try_pop_batch(std::back_inserter(output), 100), 5);
+  BOOST_REQUIRE(output == input);
+  BOOST_REQUIRE_EQUAL(queue.try_pop_batch(std::back_inserter(output), 100), 0);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(ElementLifetime, Kind, queue_kinds)
+{
+  {
+    typename Kind::template queue_t<Counted> queue(4);
+    queue.try_emplace(1);
+    queue.try_emplace(2);
+    queue.try_emplace(3);
+    Counted value;
+    BOOST_REQUIRE(queue.try_pop(value));
+    BOOST_REQUIRE_EQUAL(value.value, 1);
+    BOOST_REQUIRE_EQUAL(Counted::s_live, 3);
+  }
+  BOOST_REQUIRE_EQUAL(Counted::s_live, 0);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(WorkerThreadStop, Kind, queue_kinds)
+{
+  typename Kind::template queue_t<int> queue(16);
+  std::atomic<int> received{ 0 };
+  WorkerThread consumer([&](std::atomic<bool>& running_flag) {
+    int value;
+    while (queue.pop_wait(value, running_flag)) {
+      received += value;
+    }
+  });
+
+  consumer.start_working_thread("queue-consumer");
+  for (int i = 1; i <= 10; ++i) {
+    std::atomic<bool> running{ true };
+    BOOST_REQUIRE(queue.push_wait(i, running));
+  }
+  // The consumer is waiting on an empty queue, and must notice the stop
+  auto start = std::chrono::steady_clock::now();
+  while (received.load() != 55 && std::chrono::steady_clock::now() - start < std::chrono::seconds(5)) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  consumer.stop_working_thread();
+  BOOST_REQUIRE_EQUAL(received.load(), 55);
+
+  // Waits give up on timeout too
+  std::atomic<bool> running{ true };
+  int value;
+  BOOST_REQUIRE(!queue.pop_wait(value, running, std::chrono::milliseconds(10)));
+  for (int i = 0; i < 16; ++i) {
+    queue.try_push(i);
+  }
+  BOOST_REQUIRE(!queue.push_wait(16, running, std::chrono::milliseconds(10)));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
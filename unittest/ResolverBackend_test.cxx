@@ -0,0 +1,137 @@
+/**
+ *
+ * @file ResolverBackend_test.cxx ResolverBackend class Unit Tests
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/Resolver.hpp"
+#include "utilities/ResolverBackend.hpp"
+
+#define BOOST_TEST_MODULE ResolverBackend_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <unistd.h>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace dunedaq::utilities;
+
+namespace {
+
+nlohmann::json
+make_config()
+{
+  return nlohmann::json::parse(R"({
+    "hosts": {
+      "daq-node-01": [ "10.0.0.1", "10.0.0.2" ],
+      "daq-node-02": [ "fe80::2" ]
+    },
+    "services": {
+      "_dataflow._tcp": [
+        { "target": "daq-node-01", "port": 5555, "priority": 0, "weight": 10 },
+        { "target": "daq-node-02", "port": 5556, "priority": 1 }
+      ]
+    }
+  })");
+}
+
+struct BackendFixture
+{
+  BackendFixture() { invalidate_resolver_cache(); }
+  ~BackendFixture() { clear_resolver_backends(); }
+};
+
+} // namespace ""
+
+BOOST_AUTO_TEST_CASE(Load)
+{
+  auto backend = StaticResolverBackend::from_json(make_config());
+  BOOST_REQUIRE(backend->find_host("daq-node-01"));
+  BOOST_REQUIRE(!backend->find_host("daq-node-03"));
+  BOOST_REQUIRE_EQUAL(backend->get_hits(), 1);
+  BOOST_REQUIRE_EQUAL(backend->get_misses(), 1);
+  backend->reset_statistics();
+  BOOST_REQUIRE_EQUAL(backend->get_hits(), 0);
+
+  auto records = backend->find_service("_dataflow._tcp");
+  BOOST_REQUIRE(records);
+  BOOST_REQUIRE_EQUAL(records->size(), 2);
+  BOOST_REQUIRE_EQUAL((*records)[0].weight, 10);
+  BOOST_REQUIRE_EQUAL((*records)[1].port, 5556);
+  BOOST_REQUIRE_EQUAL((*records)[1].weight, 0);
+
+  auto path = std::string("/tmp/ResolverBackend_test_") + std::to_string(getpid()) + ".json";
+  {
+    std::ofstream file(path);
+    file << make_config();
+  }
+  auto from_file = StaticResolverBackend::from_file(path);
+  std::remove(path.c_str());
+  BOOST_REQUIRE(from_file->find_host("daq-node-02"));
+}
+
+BOOST_AUTO_TEST_CASE(InvalidConfiguration)
+{
+  BOOST_REQUIRE_THROW(StaticResolverBackend::from_json(nlohmann::json::array()), InvalidResolverConfiguration);
+  BOOST_REQUIRE_THROW(StaticResolverBackend::from_json(nlohmann::json::parse(R"({"hosts": {"a": ["not-numeric"]}})")),
+                      InvalidResolverConfiguration);
+  BOOST_REQUIRE_THROW(StaticResolverBackend::from_json(nlohmann::json::parse(R"({"hosts": {"a": "10.0.0.1"}})")),
+                      InvalidResolverConfiguration);
+  BOOST_REQUIRE_THROW(
+    StaticResolverBackend::from_json(nlohmann::json::parse(R"({"services": {"_a._tcp": [{"target": "a"}]}})")),
+    InvalidResolverConfiguration);
+  BOOST_REQUIRE_THROW(StaticResolverBackend::from_json(
+                        nlohmann::json::parse(R"({"services": {"_a._tcp": [{"target": "a", "port": 70000}]}})")),
+                      InvalidResolverConfiguration);
+  BOOST_REQUIRE_THROW(StaticResolverBackend::from_file("/nonexistent/resolver.json"), InvalidResolverConfiguration);
+}
+
+BOOST_FIXTURE_TEST_CASE(Chain, BackendFixture)
+{
+  auto backend = StaticResolverBackend::from_json(make_config());
+  add_resolver_backend(backend);
+
+  auto ips = get_ips_from_hostname("daq-node-01");
+  BOOST_REQUIRE(ips == std::vector<std::string>({ "10.0.0.1", "10.0.0.2" }));
+  auto uris = resolve_uri_hostname("tcp://daq-node-02:1234");
+  BOOST_REQUIRE_EQUAL(uris.size(), 1);
+  BOOST_REQUIRE_EQUAL(uris[0], "tcp://[fe80::2]:1234");
+  BOOST_REQUIRE_EQUAL(backend->get_hits(), 2);
+
+  // Backend answers are not cached
+  BOOST_REQUIRE(!get_hostname_cache().get("daq-node-01"));
+
+  // Misses fall through to DNS
+  BOOST_REQUIRE_GE(get_ips_from_hostname("localhost").size(), 1);
+  BOOST_REQUIRE_EQUAL(backend->get_misses(), 1);
+
+  // Service targets are resolved through the chain too
+  auto records = get_service_records("dataflow");
+  BOOST_REQUIRE_EQUAL(records.size(), 2);
+  BOOST_REQUIRE_EQUAL(records[0].endpoints.size(), 2);
+  BOOST_REQUIRE_EQUAL(records[0].endpoints[1].to_string(), "tcp://10.0.0.2:5555");
+  BOOST_REQUIRE_EQUAL(records[1].endpoints.size(), 1);
+  BOOST_REQUIRE(get_service_addresses("dataflow") ==
+                std::vector<std::string>({ "10.0.0.1:5555", "10.0.0.2:5555", "[fe80::2]:5556" }));
+  BOOST_REQUIRE(!get_service_cache().get("_dataflow._tcp"));
+
+  // Earlier backends take precedence
+  auto override_backend = std::make_shared<StaticResolverBackend>();
+  override_backend->add_host("daq-node-01", { "192.168.0.1" });
+  remove_resolver_backend(backend);
+  add_resolver_backend(override_backend);
+  add_resolver_backend(backend);
+  BOOST_REQUIRE(get_ips_from_hostname("daq-node-01") == std::vector<std::string>({ "192.168.0.1" }));
+  BOOST_REQUIRE(get_ips_from_hostname("daq-node-02") == std::vector<std::string>({ "fe80::2" }));
+  BOOST_REQUIRE_EQUAL(get_resolver_backends()->size(), 2);
+
+  clear_resolver_backends();
+  BOOST_REQUIRE(get_resolver_backends()->empty());
+}
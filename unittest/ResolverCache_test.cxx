@@ -0,0 +1,123 @@
+/**
+ *
+ * @file ResolverCache_test.cxx ResolverCache class Unit Tests
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/ResolverCache.hpp"
+
+#define BOOST_TEST_MODULE ResolverCache_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace dunedaq::utilities;
+using namespace std::chrono_literals;
+
+BOOST_AUTO_TEST_CASE(CopyAndMoveSemantics)
+{
+  BOOST_REQUIRE(!std::is_copy_constructible_v<ResolverCache<int>>);
+  BOOST_REQUIRE(!std::is_copy_assignable_v<ResolverCache<int>>);
+  BOOST_REQUIRE(!std::is_move_constructible_v<ResolverCache<int>>);
+  BOOST_REQUIRE(!std::is_move_assignable_v<ResolverCache<int>>);
+}
+
+BOOST_AUTO_TEST_CASE(GetAndPut)
+{
+  ResolverCache<std::vector<std::string>> cache(60s);
+
+  BOOST_REQUIRE(!cache.get("host"));
+  BOOST_REQUIRE_EQUAL(cache.get_misses(), 1);
+
+  cache.put("host", { "10.0.0.1", "10.0.0.2" });
+  auto res = cache.get("host");
+  BOOST_REQUIRE(res);
+  BOOST_REQUIRE_EQUAL(res->size(), 2);
+  BOOST_REQUIRE_EQUAL(res->at(1), "10.0.0.2");
+  BOOST_REQUIRE_EQUAL(cache.get_hits(), 1);
+  BOOST_REQUIRE_EQUAL(cache.size(), 1);
+
+  cache.put("other", { "10.0.0.3" });
+  cache.invalidate("host");
+  BOOST_REQUIRE(!cache.get("host"));
+  BOOST_REQUIRE(cache.get("other"));
+
+  cache.invalidate();
+  BOOST_REQUIRE(!cache.get("other"));
+  BOOST_REQUIRE_EQUAL(cache.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(Expiry)
+{
+  ResolverCache<int> cache(60s);
+
+  // The entry TTL applies when it is shorter than the maximum age...
+  cache.put("short", 1, 20ms);
+  cache.put("long", 2, 1h);
+  BOOST_REQUIRE(cache.get("short"));
+  std::this_thread::sleep_for(30ms);
+  BOOST_REQUIRE(!cache.get("short"));
+  BOOST_REQUIRE(cache.get("long"));
+
+  // ...and the maximum age when it is shorter than the TTL, including for existing entries
+  cache.set_max_age(20ms);
+  cache.put("capped", 3, 1h);
+  std::this_thread::sleep_for(30ms);
+  BOOST_REQUIRE(!cache.get("long"));
+  BOOST_REQUIRE(!cache.get("capped"));
+
+  // A maximum age of zero disables the cache
+  cache.set_max_age(0ms);
+  cache.put("disabled", 4);
+  BOOST_REQUIRE(!cache.get("disabled"));
+  BOOST_REQUIRE_EQUAL(cache.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(Eviction)
+{
+  ResolverCache<int> cache(24h, 1000);
+  BOOST_REQUIRE_EQUAL(cache.get_max_entries(), 1000);
+
+  // Expired entries, eg for names looked up once, are removed as the cache grows
+  for (int i = 0; i < 500; ++i) {
+    cache.put("expired" + std::to_string(i), i, 1ms);
+  }
+  std::this_thread::sleep_for(5ms);
+  for (int i = 0; i < 500; ++i) {
+    cache.put("live" + std::to_string(i), i, 1h);
+  }
+  BOOST_REQUIRE_LE(cache.size(), 600);
+  BOOST_REQUIRE(cache.get("live0"));
+
+  // Live entries are capped, dropping those which expire soonest first
+  cache.put("longest", 0, 2h);
+  for (int i = 0; i < 5000; ++i) {
+    cache.put("more" + std::to_string(i), i, 1h);
+  }
+  BOOST_REQUIRE_LE(cache.size(), 1000);
+  BOOST_REQUIRE(cache.get("longest"));
+
+  cache.set_max_entries(10);
+  BOOST_REQUIRE_LE(cache.size(), 10);
+  BOOST_REQUIRE(cache.get("longest"));
+}
+
+BOOST_AUTO_TEST_CASE(SharedValues)
+{
+  ResolverCache<std::vector<std::string>> cache(60s);
+  cache.put("host", { "10.0.0.1" });
+
+  // Hits share the stored value, which stays valid after it is replaced
+  auto first = cache.get("host");
+  BOOST_REQUIRE_EQUAL(first.get(), cache.get("host").get());
+  cache.put("host", { "10.0.0.2" });
+  BOOST_REQUIRE_EQUAL(first->at(0), "10.0.0.1");
+  BOOST_REQUIRE_EQUAL(cache.get("host")->at(0), "10.0.0.2");
+}
@@ -0,0 +1,343 @@
+/**
+ *
+ * @file ResolverStub_test.cxx Resolver Unit Tests against a local stub DNS server
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/Metrics.hpp"
+#include "utilities/Resolver.hpp"
+
+#include "../test/src/StubDnsServer.hpp"
+
+#define BOOST_TEST_MODULE ResolverStub_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace dunedaq::utilities;
+
+namespace {
+
+ServiceRecord
+make_record(std::string const& target, uint16_t port, uint32_t ttl = 30) // NOLINT(build/unsigned)
+{
+  ServiceRecord record;
+  record.target = target;
+  record.port = port;
+  record.ttl = ttl;
+  return record;
+}
+
+/**
+ * @brief Points the resolver at a stub server for the duration of a test
+ */
+struct StubFixture
+{
+  StubFixture()
+  {
+    set_resolver_nameservers({ server.get_endpoint() }, std::chrono::seconds(1), 1);
+    set_resolver_error_report_interval(std::chrono::milliseconds(0));
+  }
+  ~StubFixture()
+  {
+    set_resolver_nameservers({});
+    set_resolver_error_report_interval(kDefaultResolverErrorReportInterval);
+  }
+
+  StubDnsServer server;
+};
+
+} // namespace ""
+
+BOOST_FIXTURE_TEST_CASE(HostLookup, StubFixture)
+{
+  server.add_host("node-1.stub.test", { "10.1.0.1", "10.1.0.2" });
+
+  auto ips = get_ips_from_hostname("node-1.stub.test");
+  BOOST_REQUIRE(ips == std::vector<std::string>({ "10.1.0.1", "10.1.0.2" }));
+  auto queries = server.get_num_queries();
+  BOOST_REQUIRE_GE(queries, 1);
+
+  // Cached for the record TTL
+  get_ips_from_hostname("node-1.stub.test");
+  BOOST_REQUIRE_EQUAL(server.get_num_queries(), queries);
+
+  // Numeric hosts need no query
+  BOOST_REQUIRE(get_ips_from_hostname("127.0.0.1") == std::vector<std::string>({ "127.0.0.1" }));
+  BOOST_REQUIRE_EQUAL(server.get_num_queries(), queries);
+
+  BOOST_REQUIRE(get_ips_from_hostname("missing.stub.test").empty());
+}
+
+BOOST_FIXTURE_TEST_CASE(ServiceLookup, StubFixture)
+{
+  server.add_host("node-1.stub.test", { "10.1.0.1" });
+  server.add_host("node-2.stub.test", { "10.1.0.2" });
+  server.add_service("_svc._tcp.stub.test",
+                     { make_record("node-1.stub.test", 5001), make_record("node-2.stub.test", 5002) });
+
+  // Target addresses come with the answer, so only one query is sent
+  auto records = get_service_records("svc", "stub.test");
+  BOOST_REQUIRE_EQUAL(records.size(), 2);
+  BOOST_REQUIRE_EQUAL(records[1].endpoints.at(0).to_string(), "tcp://10.1.0.2:5002");
+  BOOST_REQUIRE_EQUAL(server.get_num_queries(), 1);
+  // and they're cached for later host lookups
+  get_ips_from_hostname("node-2.stub.test");
+  BOOST_REQUIRE_EQUAL(server.get_num_queries(), 1);
+
+  // Without them, each target is looked up
+  invalidate_resolver_cache();
+  server.set_additional_records(false);
+  BOOST_REQUIRE(get_service_addresses("svc", "stub.test") ==
+                std::vector<std::string>({ "10.1.0.1:5001", "10.1.0.2:5002" }));
+  BOOST_REQUIRE_EQUAL(server.get_num_queries(), 4);
+}
+
+BOOST_FIXTURE_TEST_CASE(TruncatedAnswer, StubFixture)
+{
+  std::vector<ServiceRecord> records;
+  for (uint16_t i = 0; i < 100; ++i) { // NOLINT(build/unsigned)
+    records.push_back(make_record("node-" + std::to_string(i) + ".stub.test", 5000 + i));
+    server.add_host("node-" + std::to_string(i) + ".stub.test", { "10.2.0." + std::to_string(i) });
+  }
+  server.add_service("_big._tcp.stub.test", records);
+
+  // Too large for UDP, and for the first buffer: the answer over TCP
+  // does not fit either, so the resolver asks once more, over TCP with
+  // a buffer of the maximum message size
+  auto addresses = get_service_addresses("_big._tcp.stub.test");
+  BOOST_REQUIRE_EQUAL(addresses.size(), 100);
+  BOOST_REQUIRE_GE(server.get_num_tcp_queries(), 1);
+}
+
+BOOST_FIXTURE_TEST_CASE(TcpFallback, StubFixture)
+{
+  std::vector<ServiceRecord> records;
+  for (uint16_t i = 0; i < 100; ++i) { // NOLINT(build/unsigned)
+    records.push_back(make_record("tcp-" + std::to_string(i) + ".stub.test", 5000 + i));
+    server.add_host("tcp-" + std::to_string(i) + ".stub.test", { "10.7.0." + std::to_string(i) });
+  }
+  auto retries = get_counter("resolver.dns_tcp_retries").get_value();
+
+  // TC is set on the UDP answer, and the resolver library repeats the
+  // query over TCP itself; the answer fits the first buffer
+  server.add_service("_small._tcp.stub.test", std::vector<ServiceRecord>(records.begin(), records.begin() + 20));
+  auto addresses = get_service_addresses("_small._tcp.stub.test");
+  BOOST_REQUIRE_EQUAL(addresses.size(), 20);
+  BOOST_REQUIRE_EQUAL(addresses[19], "10.7.0.19:5019");
+  BOOST_REQUIRE_EQUAL(server.get_num_udp_queries(), 1);
+  BOOST_REQUIRE_EQUAL(server.get_num_tcp_queries(), 1);
+  BOOST_REQUIRE_EQUAL(get_counter("resolver.dns_tcp_retries").get_value(), retries);
+
+  // The TCP answer is larger than the first buffer, so the query is
+  // repeated once more over TCP with a buffer of the maximum size
+  server.add_service("_large._tcp.stub.test", records);
+  addresses = get_service_addresses("_large._tcp.stub.test");
+  BOOST_REQUIRE_EQUAL(addresses.size(), 100);
+  BOOST_REQUIRE_EQUAL(addresses[99], "10.7.0.99:5099");
+  BOOST_REQUIRE_EQUAL(server.get_num_udp_queries(), 2);
+  BOOST_REQUIRE_EQUAL(server.get_num_tcp_queries(), 3);
+  BOOST_REQUIRE_EQUAL(get_counter("resolver.dns_tcp_retries").get_value(), retries + 1);
+}
+
+BOOST_FIXTURE_TEST_CASE(TruncatedOverTcp, StubFixture)
+{
+  server.add_host("trunc-1.stub.test", { "10.8.0.1" });
+  server.add_host("trunc-2.stub.test", { "10.8.0.2" });
+  server.add_service("_trunc._tcp.stub.test",
+                     { make_record("trunc-1.stub.test", 5001), make_record("trunc-2.stub.test", 5002) });
+  server.set_max_udp_size(12);
+  server.set_truncate_tcp(true);
+
+  // Still truncated over TCP with a buffer of the maximum size: the
+  // resolver warns, uses what it got and does not query again
+  auto addresses = get_service_addresses("_trunc._tcp.stub.test");
+  BOOST_REQUIRE(addresses == std::vector<std::string>({ "10.8.0.1:5001", "10.8.0.2:5002" }));
+  BOOST_REQUIRE_EQUAL(server.get_num_udp_queries(), 1);
+  BOOST_REQUIRE_EQUAL(server.get_num_tcp_queries(), 2);
+}
+
+BOOST_FIXTURE_TEST_CASE(MalformedRecords, StubFixture)
+{
+  server.add_host("bad-1.stub.test", { "10.9.0.1" });
+  server.add_host("bad-2.stub.test", { "10.9.0.2" });
+  server.add_host("bad-3.stub.test", { "10.9.0.3" });
+  server.add_service(
+    "_bad._tcp.stub.test",
+    { make_record("bad-1.stub.test", 5001), make_record("bad-2.stub.test", 5002), make_record("bad-3.stub.test", 5003) });
+  server.set_malformed_records(1);
+
+  // The short record is reported and skipped, and the rest are used
+  auto records = get_service_records("_bad._tcp.stub.test");
+  BOOST_REQUIRE_EQUAL(records.size(), 2);
+  BOOST_REQUIRE_EQUAL(records[0].target, "bad-2.stub.test");
+  BOOST_REQUIRE_EQUAL(records[1].endpoints.at(0).to_string(), "tcp://10.9.0.3:5003");
+}
+
+BOOST_FIXTURE_TEST_CASE(NegativeAnswers, StubFixture)
+{
+  BOOST_REQUIRE(get_service_addresses("_missing._tcp.stub.test").empty());
+  auto queries = server.get_num_queries();
+  BOOST_REQUIRE(get_service_addresses("_missing._tcp.stub.test").empty());
+  BOOST_REQUIRE_EQUAL(server.get_num_queries(), queries);
+
+  // Lost queries time out, and are remembered as failures too
+  server.add_host("lossy.stub.test", { "10.3.0.1" });
+  server.set_loss(1.0);
+  auto start = std::chrono::steady_clock::now();
+  BOOST_REQUIRE(get_ips_from_hostname("lossy.stub.test").empty());
+  BOOST_REQUIRE(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(900));
+  BOOST_REQUIRE(get_ips_from_hostname("lossy.stub.test").empty());
+  BOOST_REQUIRE_GE(server.get_num_dropped(), 1);
+
+  server.set_loss(0);
+  invalidate_resolver_cache();
+  BOOST_REQUIRE_EQUAL(get_ips_from_hostname("lossy.stub.test").size(), 1);
+}
+
+BOOST_FIXTURE_TEST_CASE(RetryAfterMiss, StubFixture)
+{
+  // The misses are cached for the default negative TTL...
+  BOOST_REQUIRE(get_service_addresses("_late._tcp.stub.test").empty());
+  BOOST_REQUIRE(resolve_uri_hostname("tcp://late-host.stub.test:5000").empty());
+  auto queries = server.get_num_queries();
+
+  server.add_host("late.stub.test", { "10.10.0.1" });
+  server.add_service("_late._tcp.stub.test", { make_record("late.stub.test", 5001) });
+  server.add_host("late-host.stub.test", { "10.10.0.2" });
+
+  // ...but retries query again, and find the names added since
+  RetryPolicy policy;
+  policy.initial_delay = std::chrono::milliseconds(1);
+  policy.max_attempts = 2;
+  BOOST_REQUIRE(get_service_addresses_with_retry("_late._tcp.stub.test", "", policy) ==
+                std::vector<std::string>({ "10.10.0.1:5001" }));
+  BOOST_REQUIRE(resolve_uri_hostname_with_retry("tcp://late-host.stub.test:5000", policy) ==
+                std::vector<std::string>({ "tcp://10.10.0.2:5000" }));
+  BOOST_REQUIRE_GT(server.get_num_queries(), queries);
+}
+
+BOOST_FIXTURE_TEST_CASE(Delay, StubFixture)
+{
+  server.add_host("slow.stub.test", { "10.4.0.1" });
+  server.set_delay(std::chrono::milliseconds(50));
+  auto start = std::chrono::steady_clock::now();
+  BOOST_REQUIRE_EQUAL(get_ips_from_hostname("slow.stub.test").size(), 1);
+  BOOST_REQUIRE(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(50));
+}
+
+BOOST_FIXTURE_TEST_CASE(ConcurrentServiceLookup, StubFixture)
+{
+  // Make every call go to the server
+  set_resolver_cache_max_age(std::chrono::milliseconds(0));
+  server.add_host("node-1.stub.test", { "10.6.0.1" });
+  server.add_service("_svc._tcp.stub.test", { make_record("node-1.stub.test", 5001) });
+  server.set_delay(std::chrono::milliseconds(20));
+
+  const int n_threads = 8;
+  const int n_lookups = 16;
+  auto run = [&](int threads_used) {
+    std::atomic<int> mismatches{ 0 };
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threads_used; ++t) {
+      threads.emplace_back([&] {
+        for (int i = 0; i < n_lookups / threads_used; ++i) {
+          if (get_service_addresses("_svc._tcp.stub.test") != std::vector<std::string>({ "10.6.0.1:5001" })) {
+            ++mismatches;
+          }
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    BOOST_REQUIRE_EQUAL(mismatches.load(), 0);
+    return std::chrono::steady_clock::now() - start;
+  };
+
+  // Lookups on different threads wait for the server at the same time
+  auto serial = run(1);
+  auto parallel = run(n_threads);
+  BOOST_TEST_MESSAGE(n_lookups << " SRV lookups took "
+                               << std::chrono::duration_cast<std::chrono::milliseconds>(serial).count()
+                               << " ms on 1 thread and "
+                               << std::chrono::duration_cast<std::chrono::milliseconds>(parallel).count() << " ms on "
+                               << n_threads << " threads");
+  BOOST_REQUIRE(serial >= std::chrono::milliseconds(20 * n_lookups));
+  BOOST_REQUIRE(parallel * 3 < serial);
+
+  set_resolver_cache_max_age(kDefaultResolverCacheMaxAge);
+}
+
+BOOST_FIXTURE_TEST_CASE(BatchTimeouts, StubFixture)
+{
+  std::vector<std::string> names;
+  for (int i = 0; i < 8; ++i) {
+    names.push_back("tcp://batch-" + std::to_string(i) + ".stub.test:5000");
+    server.add_host("batch-" + std::to_string(i) + ".stub.test", { "10.5.0." + std::to_string(i) });
+  }
+  server.set_delay(std::chrono::milliseconds(300));
+
+  // The lookups are abandoned, but their workers are not detached...
+  BatchResolveOptions options;
+  options.max_concurrency = 4;
+  options.timeout = std::chrono::milliseconds(50);
+  auto start = std::chrono::steady_clock::now();
+  auto results = resolve_many(names, options);
+  BOOST_REQUIRE_EQUAL(results.size(), names.size());
+  for (auto& result : results) {
+    BOOST_REQUIRE(result.empty());
+  }
+  BOOST_REQUIRE(std::chrono::steady_clock::now() - start < std::chrono::milliseconds(300));
+
+  // ...so shutting the workers down waits for the lookups to finish
+  shutdown_resolver_workers();
+  BOOST_REQUIRE(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(300));
+
+  // and later batches start new workers
+  server.set_delay(std::chrono::milliseconds(0));
+  invalidate_resolver_cache();
+  results = resolve_many(names);
+  BOOST_REQUIRE_EQUAL(results.at(7).at(0), "tcp://10.5.0.7:5000");
+}
+
+BOOST_FIXTURE_TEST_CASE(BatchPoolExhausted, StubFixture)
+{
+  // More lookups than the pool has threads, all of which block...
+  std::vector<std::string> names;
+  for (int i = 0; i < 80; ++i) {
+    names.push_back("tcp://full-" + std::to_string(i) + ".stub.test:5000");
+  }
+  server.set_delay(std::chrono::milliseconds(300));
+
+  // ...so those which no thread can take time out too, rather than
+  // being run one by one on the caller
+  BatchResolveOptions options;
+  options.max_concurrency = names.size();
+  options.timeout = std::chrono::milliseconds(50);
+  auto start = std::chrono::steady_clock::now();
+  auto results = resolve_many(names, options);
+  BOOST_REQUIRE(std::chrono::steady_clock::now() - start < std::chrono::milliseconds(300));
+  BOOST_REQUIRE_EQUAL(results.size(), names.size());
+  for (auto& result : results) {
+    BOOST_REQUIRE(result.empty());
+  }
+
+  shutdown_resolver_workers();
+  server.set_delay(std::chrono::milliseconds(0));
+}
+
+BOOST_AUTO_TEST_CASE(InvalidNameservers)
+{
+  BOOST_REQUIRE_THROW(set_resolver_nameservers({ *Endpoint::from_numeric("udp", "::1", 53) }),
+                      InvalidResolverConfiguration);
+}
@@ -0,0 +1,200 @@
+/**
+ *
+ * @file ResolverWatcher_test.cxx ResolverWatcher class Unit Tests
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/Resolver.hpp"
+#include "utilities/ResolverBackend.hpp"
+#include "utilities/ResolverWatcher.hpp"
+
+#include "../test/src/StubDnsServer.hpp"
+
+#define BOOST_TEST_MODULE ResolverWatcher_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace dunedaq::utilities;
+
+namespace {
+
+/**
+ * @brief Records the endpoints passed to a watcher callback
+ */
+struct Subscriber
+{
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::vector<std::vector<Endpoint>> updates;
+
+  ResolverWatcher::callback_t callback()
+  {
+    return [this](std::vector<Endpoint> const& endpoints) {
+      std::lock_guard<std::mutex> lk(mutex);
+      updates.push_back(endpoints);
+      cv.notify_all();
+    };
+  }
+
+  bool wait_for_updates(size_t n)
+  {
+    std::unique_lock<std::mutex> lk(mutex);
+    return cv.wait_for(lk, std::chrono::seconds(5), [&]() { return updates.size() >= n; });
+  }
+
+  size_t get_num_updates()
+  {
+    std::lock_guard<std::mutex> lk(mutex);
+    return updates.size();
+  }
+};
+
+struct BackendFixture
+{
+  BackendFixture()
+    : backend(std::make_shared<StaticResolverBackend>())
+  {
+    invalidate_resolver_cache();
+    add_resolver_backend(backend);
+  }
+  ~BackendFixture() { clear_resolver_backends(); }
+
+  std::shared_ptr<StaticResolverBackend> backend;
+};
+
+/**
+ * @brief Points the resolver at a stub server for the duration of a test
+ */
+struct StubFixture
+{
+  StubFixture() { set_resolver_nameservers({ server.get_endpoint() }, std::chrono::seconds(1), 1); }
+  ~StubFixture() { set_resolver_nameservers({}); }
+
+  StubDnsServer server;
+};
+
+} // namespace ""
+
+BOOST_FIXTURE_TEST_CASE(WatchUri, BackendFixture)
+{
+  backend->add_host("watched-host", { "10.0.0.1" });
+
+  ResolverWatcher watcher(std::chrono::milliseconds(10), std::chrono::milliseconds(10));
+  Subscriber subscriber;
+  auto id = watcher.watch_uri("tcp://watched-host:5000", subscriber.callback());
+  BOOST_REQUIRE_EQUAL(watcher.get_num_watched(), 1);
+
+  BOOST_REQUIRE(subscriber.wait_for_updates(1));
+  BOOST_REQUIRE_EQUAL(subscriber.updates[0].size(), 1);
+  BOOST_REQUIRE_EQUAL(subscriber.updates[0][0].to_string(), "tcp://10.0.0.1:5000");
+  BOOST_REQUIRE_EQUAL(watcher.get_endpoints(id).size(), 1);
+
+  // Refreshes with the same answer don't call back
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  BOOST_REQUIRE_EQUAL(subscriber.get_num_updates(), 1);
+
+  backend->add_host("watched-host", { "10.0.0.2", "10.0.0.3" });
+  BOOST_REQUIRE(subscriber.wait_for_updates(2));
+  BOOST_REQUIRE_EQUAL(subscriber.updates[1].size(), 2);
+  BOOST_REQUIRE_EQUAL(subscriber.updates[1][1].to_string(), "tcp://10.0.0.3:5000");
+
+  // A reordered answer is not a change
+  backend->add_host("watched-host", { "10.0.0.3", "10.0.0.2" });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  BOOST_REQUIRE_EQUAL(subscriber.get_num_updates(), 2);
+
+  // A host without addresses is an empty update
+  backend->add_host("watched-host", {});
+  BOOST_REQUIRE(subscriber.wait_for_updates(3));
+  BOOST_REQUIRE(subscriber.updates[2].empty());
+  BOOST_REQUIRE(watcher.get_endpoints(id).empty());
+
+  watcher.unwatch(id);
+  backend->add_host("watched-host", { "10.0.0.4" });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  BOOST_REQUIRE_EQUAL(subscriber.get_num_updates(), 3);
+  BOOST_REQUIRE_EQUAL(watcher.get_num_watched(), 0);
+  BOOST_REQUIRE(watcher.get_endpoints(id).empty());
+}
+
+BOOST_FIXTURE_TEST_CASE(WatchService, BackendFixture)
+{
+  backend->add_host("node-a", { "10.0.1.1" });
+  backend->add_host("node-b", { "10.0.1.2" });
+  ServiceRecord record;
+  record.target = "node-a";
+  record.port = 6000;
+  backend->add_service("_watched._tcp", { record });
+
+  ResolverWatcher watcher(std::chrono::milliseconds(10), std::chrono::milliseconds(10));
+  Subscriber subscriber;
+  watcher.watch_service("watched", "", subscriber.callback());
+  BOOST_REQUIRE(subscriber.wait_for_updates(1));
+  BOOST_REQUIRE_EQUAL(subscriber.updates[0][0].to_string(), "tcp://10.0.1.1:6000");
+
+  // The service moves to another host
+  record.target = "node-b";
+  backend->add_service("_watched._tcp", { record });
+  BOOST_REQUIRE(subscriber.wait_for_updates(2));
+  BOOST_REQUIRE_EQUAL(subscriber.updates[1][0].to_string(), "tcp://10.0.1.2:6000");
+}
+
+BOOST_FIXTURE_TEST_CASE(RefreshFromDns, StubFixture)
+{
+  ServiceRecord record;
+  record.target = "node-1.stub.test";
+  record.port = 5001;
+  record.ttl = 60;
+  server.add_host("node-1.stub.test", { "10.0.2.1" });
+  server.add_host("node-2.stub.test", { "10.0.2.2" });
+  server.add_service("_moving._tcp.stub.test", { record });
+
+  ResolverWatcher watcher(std::chrono::milliseconds(10), std::chrono::milliseconds(10));
+  Subscriber subscriber;
+  auto id = watcher.watch_service("_moving._tcp.stub.test", "", subscriber.callback());
+  BOOST_REQUIRE(subscriber.wait_for_updates(1));
+  BOOST_REQUIRE_EQUAL(subscriber.updates[0][0].to_string(), "tcp://10.0.2.1:5001");
+
+  // Refreshes query the server although the answer is cached, and replace the cached answer
+  record.target = "node-2.stub.test";
+  server.add_service("_moving._tcp.stub.test", { record });
+  BOOST_REQUIRE(subscriber.wait_for_updates(2));
+  BOOST_REQUIRE_EQUAL(subscriber.updates[1][0].to_string(), "tcp://10.0.2.2:5001");
+  auto queries = server.get_num_queries();
+  BOOST_REQUIRE(get_service_addresses("_moving._tcp.stub.test") == std::vector<std::string>({ "10.0.2.2:5001" }));
+  BOOST_REQUIRE_EQUAL(server.get_num_queries(), queries);
+
+  // Lookups which get no answer keep both the endpoints and the cached answer
+  server.set_loss(1.0);
+  std::this_thread::sleep_for(std::chrono::milliseconds(1500));
+  BOOST_REQUIRE_GE(server.get_num_dropped(), 1);
+  BOOST_REQUIRE_EQUAL(subscriber.get_num_updates(), 2);
+  BOOST_REQUIRE_EQUAL(watcher.get_endpoints(id).size(), 1);
+  BOOST_REQUIRE(get_service_addresses("_moving._tcp.stub.test") == std::vector<std::string>({ "10.0.2.2:5001" }));
+
+  // A service which no longer exists is an empty update
+  server.set_loss(0);
+  server.remove_name("_moving._tcp.stub.test");
+  BOOST_REQUIRE(subscriber.wait_for_updates(3));
+  BOOST_REQUIRE(subscriber.updates[2].empty());
+  BOOST_REQUIRE(watcher.get_endpoints(id).empty());
+}
+
+BOOST_AUTO_TEST_CASE(InvalidConnectionString)
+{
+  ResolverWatcher watcher;
+  BOOST_REQUIRE_THROW(watcher.watch_uri("localhost:5000", nullptr), dunedaq::utilities::InvalidUri);
+  BOOST_REQUIRE_THROW(watcher.watch_uri("inproc://name", nullptr), dunedaq::utilities::InvalidUri);
+  BOOST_REQUIRE_EQUAL(watcher.get_num_watched(), 0);
+}
@@ -20,6 +20,7 @@
 #include <filesystem>
 #include <fstream>
 #include <regex>
+#include <vector>
 
 using namespace dunedaq::utilities;
 
@@ -94,5 +95,130 @@ BOOST_AUTO_TEST_CASE(Ldap)
 
   std::regex regex("\\d+\\.\\d+\\.\\d+\\.\\d+:\\d+");
   BOOST_REQUIRE(std::regex_match(res[0], regex));
+
+  auto records = get_service_records("ldap");
+  size_t n_addresses = 0;
+  for (auto& record : records) {
+    BOOST_REQUIRE_GT(record.port, 0);
+    n_addresses += record.endpoints.size();
+    for (auto& endpoint : record.endpoints) {
+      BOOST_REQUIRE_EQUAL(endpoint.get_port(), record.port);
+    }
+  }
+  BOOST_REQUIRE_EQUAL(n_addresses, res.size());
+  BOOST_REQUIRE_EQUAL(get_service_endpoints("ldap").size(), res.size());
   TLOG() << "Test Ldap END";
 }
+
+BOOST_AUTO_TEST_CASE(Cache)
+{
+  TLOG() << "Test Cache BEGIN";
+  invalidate_resolver_cache();
+  auto hits = get_hostname_cache().get_hits();
+
+  auto res = get_ips_from_hostname("localhost");
+  BOOST_REQUIRE_GE(res.size(), 1);
+  BOOST_REQUIRE_EQUAL(get_hostname_cache().get_hits(), hits);
+
+  auto res2 = get_ips_from_hostname("localhost");
+  BOOST_REQUIRE(res2 == res);
+  BOOST_REQUIRE_EQUAL(get_hostname_cache().get_hits(), hits + 1);
+
+  // URI resolution goes through the same cache
+  auto uris = resolve_uri_hostname("tcp://localhost:1234");
+  BOOST_REQUIRE_EQUAL(uris.size(), res.size());
+  BOOST_REQUIRE_EQUAL(get_hostname_cache().get_hits(), hits + 2);
+
+  // Endpoint lookups too, and give the same addresses
+  auto endpoints = resolve_uri_endpoints("tcp://localhost:1234");
+  BOOST_REQUIRE_EQUAL(endpoints.size(), res.size());
+  BOOST_REQUIRE_EQUAL(get_hostname_cache().get_hits(), hits + 3);
+  for (size_t i = 0; i < endpoints.size(); ++i) {
+    BOOST_REQUIRE_EQUAL(endpoints[i].to_string(), uris[i]);
+  }
+
+  invalidate_resolver_cache();
+  get_ips_from_hostname("localhost");
+  BOOST_REQUIRE_EQUAL(get_hostname_cache().get_hits(), hits + 3);
+
+  // Failed lookups are cached for the negative TTL
+  get_ips_from_hostname("localhost:1234");
+  auto negative = get_hostname_cache().get("localhost:1234");
+  BOOST_REQUIRE(negative);
+  BOOST_REQUIRE(negative->empty());
+  BOOST_REQUIRE(get_ips_from_hostname("localhost:1234").empty());
+
+  set_resolver_negative_ttl(std::chrono::milliseconds(0));
+  get_hostname_cache().invalidate("localhost:1234");
+  get_ips_from_hostname("localhost:1234");
+  BOOST_REQUIRE(!get_hostname_cache().get("localhost:1234"));
+  set_resolver_negative_ttl(kDefaultResolverNegativeTtl);
+
+  hits = get_hostname_cache().get_hits();
+  set_resolver_cache_max_age(std::chrono::milliseconds(0));
+  get_ips_from_hostname("localhost");
+  get_ips_from_hostname("localhost");
+  BOOST_REQUIRE_EQUAL(get_hostname_cache().get_hits(), hits);
+  set_resolver_cache_max_age(kDefaultResolverCacheMaxAge);
+  TLOG() << "Test Cache END";
+}
+
+BOOST_AUTO_TEST_CASE(NegativeCache)
+{
+  TLOG() << "Test NegativeCache BEGIN";
+  invalidate_resolver_cache();
+  set_resolver_error_report_interval(std::chrono::seconds(60));
+
+  // Retrying a missing service in a tight loop sends one query per negative TTL
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < 100; ++i) {
+    BOOST_REQUIRE(get_service_addresses("NonExistantService").empty());
+  }
+  BOOST_REQUIRE(std::chrono::steady_clock::now() - start < kDefaultResolverNegativeTtl);
+  auto negative = get_service_cache().get("_NonExistantService._tcp");
+  BOOST_REQUIRE(negative);
+  BOOST_REQUIRE(negative->empty());
+
+  RetryPolicy policy;
+  policy.initial_delay = std::chrono::milliseconds(1);
+  policy.max_attempts = 3;
+  BOOST_REQUIRE(get_service_addresses_with_retry("NonExistantService", "", policy).empty());
+  BOOST_REQUIRE_EQUAL(resolve_uri_hostname_with_retry("tcp://127.0.0.1:1234", policy).size(), 1);
+
+  set_resolver_error_report_interval(kDefaultResolverErrorReportInterval);
+  invalidate_resolver_cache();
+  TLOG() << "Test NegativeCache END";
+}
+
+BOOST_AUTO_TEST_CASE(BatchLookup)
+{
+  TLOG() << "Test BatchLookup BEGIN";
+  std::vector<std::string> uris{ "tcp://127.0.0.1:1234", "inproc://foo", "blah", "tcp://localhost:5678" };
+  for (int i = 0; i < 50; ++i) {
+    uris.push_back("tcp://127.0.0." + std::to_string(i + 1) + ":" + std::to_string(1000 + i));
+  }
+
+  BatchResolveOptions options;
+  options.max_concurrency = 4;
+  auto res = resolve_many(uris, options);
+  BOOST_REQUIRE_EQUAL(res.size(), uris.size());
+  BOOST_REQUIRE_EQUAL(res[0].size(), 1);
+  BOOST_REQUIRE_EQUAL(res[0][0], "tcp://127.0.0.1:1234");
+  BOOST_REQUIRE_EQUAL(res[1][0], "inproc://foo");
+  BOOST_REQUIRE(res[2].empty()); // Invalid URIs are reported, not thrown
+  BOOST_REQUIRE_GE(res[3].size(), 1);
+  BOOST_REQUIRE(res[3] == resolve_uri_hostname("tcp://localhost:5678"));
+  for (int i = 0; i < 50; ++i) {
+    BOOST_REQUIRE_EQUAL(res[4 + i].size(), 1);
+    BOOST_REQUIRE_EQUAL(res[4 + i][0], uris[4 + i]);
+  }
+
+  BOOST_REQUIRE(resolve_many({}).empty());
+
+  auto services = get_service_addresses_many({ "NonExistantService", "_ldap._tcp", "NonExistantService2" });
+  BOOST_REQUIRE_EQUAL(services.size(), 3);
+  BOOST_REQUIRE(services[0].empty());
+  BOOST_REQUIRE(services[1] == get_service_addresses("_ldap._tcp"));
+  BOOST_REQUIRE(services[2].empty());
+  TLOG() << "Test BatchLookup END";
+}
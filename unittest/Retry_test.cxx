@@ -0,0 +1,114 @@
+/**
+ *
+ * @file Retry_test.cxx retry_with_backoff Unit Tests
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/Retry.hpp"
+
+#define BOOST_TEST_MODULE Retry_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace dunedaq::utilities;
+
+namespace {
+
+RetryPolicy
+fast_policy()
+{
+  RetryPolicy policy;
+  policy.initial_delay = std::chrono::milliseconds(1);
+  policy.max_delay = std::chrono::milliseconds(4);
+  return policy;
+}
+
+} // namespace ""
+
+BOOST_AUTO_TEST_CASE(SucceedsEventually)
+{
+  int attempts = 0;
+  auto result = retry_with_backoff(
+    [&]() {
+      ++attempts;
+      return attempts < 5 ? std::vector<std::string>() : std::vector<std::string>{ "found" };
+    },
+    fast_policy());
+  BOOST_REQUIRE_EQUAL(attempts, 5);
+  BOOST_REQUIRE_EQUAL(result.size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(MaxAttempts)
+{
+  auto policy = fast_policy();
+  policy.max_attempts = 3;
+  int attempts = 0;
+  auto result = retry_with_backoff(
+    [&]() {
+      ++attempts;
+      return std::string();
+    },
+    policy);
+  BOOST_REQUIRE_EQUAL(attempts, 3);
+  BOOST_REQUIRE(result.empty());
+}
+
+BOOST_AUTO_TEST_CASE(Backoff)
+{
+  // Without jitter, the delays are 10, 20, 40 and 40 ms
+  RetryPolicy policy;
+  policy.initial_delay = std::chrono::milliseconds(10);
+  policy.max_delay = std::chrono::milliseconds(40);
+  policy.jitter = 0;
+  policy.max_attempts = 5;
+
+  std::vector<std::chrono::steady_clock::time_point> times;
+  retry_with_backoff(
+    [&]() {
+      times.push_back(std::chrono::steady_clock::now());
+      return std::string();
+    },
+    policy);
+  BOOST_REQUIRE_EQUAL(times.size(), 5);
+  std::vector<int> expected{ 10, 20, 40, 40 };
+  for (size_t i = 1; i < times.size(); ++i) {
+    BOOST_REQUIRE(times[i] - times[i - 1] >= std::chrono::milliseconds(expected[i - 1]));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(Timeout)
+{
+  auto policy = fast_policy();
+  policy.timeout = std::chrono::milliseconds(50);
+  auto start = std::chrono::steady_clock::now();
+  retry_with_backoff([]() { return std::string(); }, policy);
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  BOOST_REQUIRE(elapsed < std::chrono::milliseconds(500));
+}
+
+BOOST_AUTO_TEST_CASE(Stopped)
+{
+  RetryPolicy policy;
+  policy.initial_delay = std::chrono::seconds(10);
+  policy.timeout = std::chrono::milliseconds(0);
+
+  std::atomic<bool> running{ true };
+  std::thread stopper([&]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    running = false;
+  });
+  auto start = std::chrono::steady_clock::now();
+  retry_with_backoff([]() { return std::string(); }, policy, &running);
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  stopper.join();
+  BOOST_REQUIRE(elapsed < std::chrono::seconds(1));
+}
@@ -17,6 +17,8 @@
 #include <chrono>
 #include <filesystem>
 #include <fstream>
+#include <functional>
+#include <vector>
 
 using namespace dunedaq::utilities;
 
@@ -56,4 +58,91 @@ BOOST_AUTO_TEST_CASE(SetWork)
     std::this_thread::sleep_for(std::chrono::milliseconds(1));
   }
   BOOST_REQUIRE_EQUAL(result, 5);
-}
\ No newline at end of file
+}
+
+BOOST_AUTO_TEST_CASE(SetWorkBatch)
+{
+  ReusableThread worker(3);
+
+  std::vector<int> order;
+  std::vector<std::function<void()>> tasks;
+  for (int i = 0; i < 100; ++i) {
+    tasks.push_back([&order, i]() { order.push_back(i); });
+  }
+  BOOST_REQUIRE(worker.set_work_batch(tasks));
+  BOOST_REQUIRE(tasks.empty());
+
+  while (!worker.get_readiness()) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  BOOST_REQUIRE_EQUAL(order.size(), 100);
+  for (int i = 0; i < 100; ++i) {
+    BOOST_REQUIRE_EQUAL(order[i], i);
+  }
+
+  // The next batch hands back the storage of the previous one
+  tasks.push_back([&order]() { order.push_back(100); });
+  BOOST_REQUIRE(worker.set_work_batch(tasks));
+  BOOST_REQUIRE(tasks.empty());
+  BOOST_REQUIRE_GE(tasks.capacity(), 100);
+  while (!worker.get_readiness()) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  BOOST_REQUIRE_EQUAL(order.size(), 101);
+
+  // Single tasks can follow a batch
+  result = 0;
+  BOOST_REQUIRE(worker.set_work(test_fun, 7));
+  while (!worker.get_readiness()) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  BOOST_REQUIRE_EQUAL(result, 7);
+}
+
+BOOST_AUTO_TEST_CASE(AppendWork)
+{
+  ReusableThread worker(4);
+  BOOST_REQUIRE(!worker.append_work([]() {}));
+
+  std::atomic<bool> release{ false };
+  std::atomic<int> count{ 0 };
+  std::vector<std::function<void()>> tasks{ [&]() {
+    while (!release.load()) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ++count;
+  } };
+  BOOST_REQUIRE(worker.set_work_batch(tasks));
+
+  // Appended while the first task runs, so the batch can't have completed
+  for (int i = 0; i < 10; ++i) {
+    BOOST_REQUIRE(worker.append_work([&]() { ++count; }));
+  }
+  BOOST_REQUIRE(!worker.get_readiness());
+
+  // A busy thread takes no new batch
+  std::vector<std::function<void()>> rejected{ []() {} };
+  BOOST_REQUIRE(!worker.set_work_batch(rejected));
+  BOOST_REQUIRE_EQUAL(rejected.size(), 1);
+  release = true;
+
+  while (!worker.get_readiness()) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  BOOST_REQUIRE_EQUAL(count, 11);
+  BOOST_REQUIRE(!worker.append_work([]() {}));
+}
+
+BOOST_AUTO_TEST_CASE(SetWorkRange)
+{
+  ReusableThread worker(5);
+
+  std::vector<int> values(1000);
+  BOOST_REQUIRE(worker.set_work_range(values.begin(), values.end(), [](int& value) { value = 1; }));
+  while (!worker.get_readiness()) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  for (auto value : values) {
+    BOOST_REQUIRE_EQUAL(value, 1);
+  }
+}
@@ -0,0 +1,50 @@
+/**
+ *
+ * @file SPSCQueue_test.cxx SPSCQueue class Unit Tests
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/SPSCQueue.hpp"
+
+#define BOOST_TEST_MODULE SPSCQueue_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+using namespace dunedaq::utilities;
+
+BOOST_AUTO_TEST_SUITE(SPSCQueue_test)
+
+BOOST_AUTO_TEST_CASE(ProducerConsumer)
+{
+  constexpr int n_elements = 1000000;
+  SPSCQueue<std::unique_ptr<int>> queue(1024);
+  std::atomic<bool> running{ true };
+
+  // Boost.Test checks are not thread-safe, so the producer only counts failures
+  std::atomic<int> failures{ 0 };
+  std::thread producer([&]() {
+    for (int i = 0; i < n_elements; ++i) {
+      if (!queue.push_wait(std::make_unique<int>(i), running)) {
+        ++failures;
+      }
+    }
+  });
+
+  std::unique_ptr<int> value;
+  for (int i = 0; i < n_elements; ++i) {
+    BOOST_REQUIRE(queue.pop_wait(value, running));
+    BOOST_REQUIRE_EQUAL(*value, i);
+  }
+  producer.join();
+  BOOST_REQUIRE_EQUAL(failures.load(), 0);
+  BOOST_REQUIRE(queue.empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
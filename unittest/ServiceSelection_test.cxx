@@ -0,0 +1,117 @@
+/**
+ *
+ * @file ServiceSelection_test.cxx SRV record selection Unit Tests
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/ServiceSelection.hpp"
+
+#define BOOST_TEST_MODULE ServiceSelection_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace dunedaq::utilities;
+
+namespace {
+
+ServiceRecord
+make_record(std::string const& target, uint16_t priority, uint16_t weight, bool resolvable = true) // NOLINT
+{
+  ServiceRecord record;
+  record.target = target;
+  record.priority = priority;
+  record.weight = weight;
+  record.port = 5000;
+  record.ttl = 60;
+  if (resolvable) {
+    record.endpoints.push_back(*Endpoint::from_numeric("tcp", "10.0.0.1", record.port));
+  }
+  return record;
+}
+
+} // namespace ""
+
+BOOST_AUTO_TEST_CASE(Empty)
+{
+  std::vector<ServiceRecord> records;
+  BOOST_REQUIRE(select_service_record(records) == nullptr);
+  BOOST_REQUIRE(select_service_record(records, "client") == nullptr);
+  BOOST_REQUIRE(order_service_records(records).empty());
+
+  records.push_back(make_record("unresolvable", 0, 10, false));
+  BOOST_REQUIRE(select_service_record(records) == nullptr);
+  BOOST_REQUIRE(select_service_record(records, "client") == nullptr);
+  BOOST_REQUIRE(order_service_records(records).empty());
+}
+
+BOOST_AUTO_TEST_CASE(PriorityAndWeight)
+{
+  std::vector<ServiceRecord> records{ make_record("backup", 20, 100),
+                                      make_record("light", 10, 1),
+                                      make_record("heavy", 10, 3),
+                                      make_record("unresolvable", 0, 100, false) };
+  std::mt19937_64 rng(12345);
+  std::map<std::string, int> counts;
+  const int n_draws = 40000;
+  for (int i = 0; i < n_draws; ++i) {
+    auto record = select_service_record(records, rng);
+    BOOST_REQUIRE(record != nullptr);
+    ++counts[record->target];
+  }
+  // Only the best usable priority is chosen, in proportion to the weights
+  BOOST_REQUIRE_EQUAL(counts.size(), 2);
+  BOOST_CHECK_CLOSE(static_cast<double>(counts["heavy"]) / n_draws, 0.75, 5);
+  BOOST_CHECK_CLOSE(static_cast<double>(counts["light"]) / n_draws, 0.25, 10);
+
+  auto ordered = order_service_records(records, rng);
+  BOOST_REQUIRE_EQUAL(ordered.size(), 3);
+  BOOST_REQUIRE_EQUAL(ordered[0].priority, 10);
+  BOOST_REQUIRE_EQUAL(ordered[1].priority, 10);
+  BOOST_REQUIRE_EQUAL(ordered[2].target, "backup");
+}
+
+BOOST_AUTO_TEST_CASE(ConsistentHashing)
+{
+  std::vector<ServiceRecord> records;
+  for (int i = 0; i < 8; ++i) {
+    records.push_back(make_record("server" + std::to_string(i), 0, 1));
+  }
+
+  std::map<std::string, std::string> assignment;
+  std::map<std::string, int> counts;
+  const int n_clients = 8000;
+  for (int i = 0; i < n_clients; ++i) {
+    auto key = "client" + std::to_string(i);
+    auto record = select_service_record(records, key);
+    BOOST_REQUIRE(record != nullptr);
+    // Same key, same choice
+    BOOST_REQUIRE_EQUAL(select_service_record(records, key)->target, record->target);
+    assignment[key] = record->target;
+    ++counts[record->target];
+  }
+
+  // Load is spread across all servers
+  BOOST_REQUIRE_EQUAL(counts.size(), records.size());
+  for (auto& [target, count] : counts) {
+    BOOST_CHECK_CLOSE(static_cast<double>(count), n_clients / records.size(), 15);
+  }
+
+  // Removing a server only moves the clients that were assigned to it
+  auto removed = records.back().target;
+  records.pop_back();
+  for (auto& [key, target] : assignment) {
+    auto record = select_service_record(records, key);
+    if (target != removed) {
+      BOOST_REQUIRE_EQUAL(record->target, target);
+    } else {
+      BOOST_REQUIRE_NE(record->target, removed);
+    }
+  }
+}
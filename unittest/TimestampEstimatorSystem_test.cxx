@@ -16,6 +16,10 @@
 #include "boost/test/unit_test.hpp"
 #include <boost/test/tools/old/interface.hpp>
 #include <chrono>
+#include <memory>
+#include <thread>
+
+using namespace dunedaq::utilities;
 
 BOOST_AUTO_TEST_SUITE(BOOST_TEST_MODULE)
 
@@ -23,27 +27,130 @@ BOOST_AUTO_TEST_CASE(Basics)
 {
   const uint64_t clock_frequency_hz = 62'500'000; // NOLINT(build/unsigned)
   std::atomic<bool> continue_flag{ true };
-  dunedaq::utilities::TimestampEstimatorSystem tes(clock_frequency_hz);
+  TimestampEstimatorSystem tes(clock_frequency_hz);
 
-  BOOST_CHECK_EQUAL(tes.wait_for_valid_timestamp(continue_flag),
-                    dunedaq::utilities::TimestampEstimatorBase::kFinished);
+  BOOST_CHECK_EQUAL(tes.wait_for_valid_timestamp(continue_flag), TimestampEstimatorBase::kFinished);
 
   std::atomic<bool> do_not_continue_flag{ false };
-  BOOST_CHECK_EQUAL(tes.wait_for_valid_timestamp(do_not_continue_flag),
-                    dunedaq::utilities::TimestampEstimatorBase::kInterrupted);
+  BOOST_CHECK_EQUAL(tes.wait_for_valid_timestamp(do_not_continue_flag), TimestampEstimatorBase::kInterrupted);
 
-  dunedaq::daqdataformats::timestamp_t ts_now = tes.get_timestamp_estimate();
+  uint64_t ts_now = tes.get_timestamp_estimate(); // NOLINT(build/unsigned)
   BOOST_CHECK_EQUAL(tes.wait_for_timestamp(ts_now + clock_frequency_hz, continue_flag),
-                    dunedaq::utilities::TimestampEstimatorBase::kFinished);
+                    TimestampEstimatorBase::kFinished);
 
   ts_now = tes.get_timestamp_estimate();
   BOOST_CHECK_EQUAL(tes.wait_for_timestamp(ts_now + clock_frequency_hz, do_not_continue_flag),
-                    dunedaq::utilities::TimestampEstimatorBase::kInterrupted);
+                    TimestampEstimatorBase::kInterrupted);
 
   // Check that the timestamp doesn't go backwards
-  dunedaq::daqdataformats::timestamp_t ts1 = tes.get_timestamp_estimate();
-  dunedaq::daqdataformats::timestamp_t ts2 = tes.get_timestamp_estimate();
+  uint64_t ts1 = tes.get_timestamp_estimate(); // NOLINT(build/unsigned)
+  uint64_t ts2 = tes.get_timestamp_estimate(); // NOLINT(build/unsigned)
   BOOST_CHECK_GE(ts2, ts1);
 }
 
+BOOST_AUTO_TEST_CASE(SimulatedTime)
+{
+  using namespace std::chrono_literals;
+  const uint64_t clock_frequency_hz = 62'500'000; // NOLINT(build/unsigned)
+  auto clock = std::make_shared<SimulatedClock>(Clock::time_point(1'600'000'000'000'000us));
+  TimestampEstimatorSystem tes(clock_frequency_hz, clock);
+  std::atomic<bool> continue_flag{ true };
+
+  BOOST_CHECK_EQUAL(tes.get_timestamp_estimate(), 1'600'000'000ULL * clock_frequency_hz);
+
+  clock->advance(1s);
+  BOOST_CHECK_EQUAL(tes.get_timestamp_estimate(), 1'600'000'001ULL * clock_frequency_hz);
+
+  // An hour of simulated waiting should take no time at all
+  auto real_start = std::chrono::steady_clock::now();
+  auto target = tes.get_timestamp_estimate() + 3600 * clock_frequency_hz;
+  BOOST_CHECK_EQUAL(tes.wait_for_timestamp(target, continue_flag), TimestampEstimatorBase::kFinished);
+  BOOST_CHECK_GE(tes.get_timestamp_estimate(), target);
+  BOOST_CHECK(std::chrono::steady_clock::now() - real_start < 10s);
+}
+
+BOOST_AUTO_TEST_CASE(SimulatedTimeAdvancedExternally)
+{
+  using namespace std::chrono_literals;
+  const uint64_t clock_frequency_hz = 62'500'000; // NOLINT(build/unsigned)
+  auto clock = std::make_shared<SimulatedClock>(Clock::time_point(1'600'000'000'000'000us), false);
+  TimestampEstimatorSystem tes(clock_frequency_hz, clock);
+  std::atomic<bool> continue_flag{ true };
+
+  auto target = tes.get_timestamp_estimate() + 60 * clock_frequency_hz;
+  std::thread advancer([&] {
+    for (int i = 0; i < 60; ++i) {
+      clock->advance(1s);
+    }
+  });
+  BOOST_CHECK_EQUAL(tes.wait_for_timestamp(target, continue_flag), TimestampEstimatorBase::kFinished);
+  advancer.join();
+  BOOST_CHECK_GE(tes.get_timestamp_estimate(), target);
+
+  // Nobody advances the clock now, so only the flag can end the wait
+  std::thread stopper([&] {
+    std::this_thread::sleep_for(10ms);
+    continue_flag = false;
+  });
+  BOOST_CHECK_EQUAL(tes.wait_for_timestamp(target + clock_frequency_hz, continue_flag),
+                    TimestampEstimatorBase::kInterrupted);
+  stopper.join();
+}
+
+BOOST_AUTO_TEST_CASE(Deadline)
+{
+  using namespace std::chrono_literals;
+  const uint64_t clock_frequency_hz = 62'500'000; // NOLINT(build/unsigned)
+  auto clock = std::make_shared<SimulatedClock>(Clock::time_point(1'600'000'000'000'000us));
+  TimestampEstimatorSystem tes(clock_frequency_hz, clock);
+  std::atomic<bool> continue_flag{ true };
+  std::atomic<bool> do_not_continue_flag{ false };
+
+  auto start = clock->now();
+  auto ts_now = tes.get_timestamp_estimate();
+
+  // Deadline before the timestamp is reached
+  BOOST_CHECK_EQUAL(tes.wait_for_timestamp(ts_now + 3600 * clock_frequency_hz, continue_flag, start + 1s),
+                    TimestampEstimatorBase::kTimedOut);
+  BOOST_CHECK(clock->now() == start + 1s);
+
+  // Deadline already passed
+  BOOST_CHECK_EQUAL(tes.wait_for_timestamp(ts_now + 3600 * clock_frequency_hz, continue_flag, start),
+                    TimestampEstimatorBase::kTimedOut);
+
+  // The flag takes precedence
+  BOOST_CHECK_EQUAL(tes.wait_for_timestamp(ts_now, do_not_continue_flag, start),
+                    TimestampEstimatorBase::kInterrupted);
+
+  // Timestamp reached before the deadline, and released within a
+  // microsecond of it (the estimate itself is computed in floating point)
+  for (auto policy : { WaitPolicy::sleeping(), WaitPolicy::low_latency() }) {
+    auto target = tes.get_timestamp_estimate() + clock_frequency_hz / 1000 * 25; // 25 ms
+    auto expected_end = clock->now() + 25ms;
+    BOOST_CHECK_EQUAL(tes.wait_for_timestamp(target, continue_flag, clock->now() + 1s, policy),
+                      TimestampEstimatorBase::kFinished);
+    BOOST_CHECK_GE((clock->now() - expected_end).count(), 0);
+    BOOST_CHECK_LE((clock->now() - expected_end).count(), 1);
+  }
+
+  BOOST_CHECK_EQUAL(tes.wait_for_valid_timestamp(continue_flag, clock->now() + 1s),
+                    TimestampEstimatorBase::kFinished);
+}
+
+BOOST_AUTO_TEST_CASE(LowLatencyPrecision)
+{
+  using namespace std::chrono_literals;
+  const uint64_t clock_frequency_hz = 62'500'000; // NOLINT(build/unsigned)
+  TimestampEstimatorSystem tes(clock_frequency_hz);
+  std::atomic<bool> continue_flag{ true };
+
+  auto target = tes.get_timestamp_estimate() + clock_frequency_hz / 1000 * 5; // 5 ms
+  BOOST_CHECK_EQUAL(tes.wait_for_timestamp(target, continue_flag, tes.get_clock()->now() + 1s, WaitPolicy::low_latency()),
+                    TimestampEstimatorBase::kFinished);
+  auto late_ticks = tes.get_timestamp_estimate() - target;
+  BOOST_TEST_MESSAGE("Released " << late_ticks * 1'000'000 / clock_frequency_hz << " us after the target");
+  // Be generous: the test machine may be heavily loaded
+  BOOST_CHECK_LT(late_ticks, clock_frequency_hz / 100);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
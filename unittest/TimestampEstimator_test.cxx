@@ -1,14 +1,11 @@
 /**
- * @file TimestampEstimatorSystem_test.cxx  TimestampEstimatorSystem class Unit Tests
+ * @file TimestampEstimator_test.cxx  TimestampEstimator class Unit Tests
  *
  * This is part of the DUNE DAQ Application Framework, copyright 2020.
  * Licensing/copyright details are in the COPYING file that you should have
  * received with this code.
  */
 
-#include "iomanager/IOManager.hpp"
-#include "iomanager/Sender.hpp"
-#include "iomanager/Receiver.hpp"
 #include "utilities/TimestampEstimator.hpp"
 
 /**
@@ -19,86 +16,120 @@
 #include "boost/test/unit_test.hpp"
 
 #include <chrono>
-#include <map>
 #include <memory>
-#include <string>
+#include <thread>
 
 using namespace dunedaq;
+using namespace std::chrono_literals;
 
-BOOST_AUTO_TEST_SUITE(BOOST_TEST_MODULE)
+namespace {
 
 /**
- * @brief Initializes the QueueRegistry
+ * @brief Stand-in for dfmessages::TimeSync, with the fields used by
+ * TimestampEstimator::timesync_callback
  */
-struct DAQSinkDAQSourceTestFixture
+struct FakeTimeSync
 {
-  DAQSinkDAQSourceTestFixture() {}
-
-  void setup()
-  {
-    iomanager::ConnectionIds_t connections;
-    connections.emplace_back(
-      iomanager::ConnectionId{ "dummy", iomanager::ServiceType::kQueue, "TimeSync", "queue://kFollyMPMCQueue:100" });
-    
-    get_iomanager()->configure(connections);
-  }
-
-  void teardown() {
-      get_iomanager()->reset();
-  }
+  uint64_t daq_time{ 0 };        // NOLINT(build/unsigned)
+  uint64_t system_time{ 0 };     // NOLINT(build/unsigned)
+  uint64_t sequence_number{ 0 }; // NOLINT(build/unsigned)
+  uint32_t run_number{ 0 };      // NOLINT(build/unsigned)
+  uint32_t source_pid{ 0 };      // NOLINT(build/unsigned)
 };
 
-BOOST_TEST_GLOBAL_FIXTURE(DAQSinkDAQSourceTestFixture);
-
-BOOST_AUTO_TEST_CASE(Basics)
-{
-  using namespace std::chrono_literals;
-  auto queue_ref = iomanager::ConnectionRef{ "queue", "dummy" };
-  auto sink =  get_iom_sender<dfmessages::TimeSync>(queue_ref);
-  auto source = get_iom_receiver<dfmessages::TimeSync>(queue_ref);
+const uint64_t clock_frequency_hz = 62'500'000; // NOLINT(build/unsigned)
+const utilities::Clock::time_point start_time(1'600'000'000'000'000us);
 
-  const uint64_t clock_frequency_hz = 62'500'000; // NOLINT(build/unsigned)
+} // namespace ""
 
-  utilities::TimestampEstimator te(source, clock_frequency_hz);
+BOOST_AUTO_TEST_SUITE(BOOST_TEST_MODULE)
 
-  // allow previous run timesync queue drain check to complete
-  std::this_thread::sleep_for(std::chrono::milliseconds(5));
+BOOST_AUTO_TEST_CASE(Basics)
+{
+  auto clock = std::make_shared<utilities::SimulatedClock>(start_time, false);
+  utilities::TimestampEstimator te(clock_frequency_hz, clock);
 
   // There's no valid timestamp yet, because no TimeSync messages have
   // been received. We should immediately return with kInterrupted
   std::atomic<bool> do_not_continue_flag{ false };
-  BOOST_CHECK_EQUAL(te.wait_for_valid_timestamp(do_not_continue_flag),
-                    utilities::TimestampEstimatorBase::kInterrupted);
+  BOOST_CHECK_EQUAL(te.wait_for_valid_timestamp(do_not_continue_flag), utilities::TimestampEstimatorBase::kInterrupted);
 
   std::atomic<bool> continue_flag{ true };
-  daqdataformats::timestamp_t initial_ts = 1;
-  dfmessages::TimeSync initial_time_sync(initial_ts);
-  sink->send(std::move(initial_time_sync), 10ms);
-  BOOST_CHECK_EQUAL(te.wait_for_valid_timestamp(continue_flag), utilities::TimestampEstimatorBase::kFinished);
+  BOOST_CHECK_EQUAL(te.wait_for_valid_timestamp(continue_flag, clock->now()),
+                    utilities::TimestampEstimatorBase::kTimedOut);
 
-  daqdataformats::timestamp_t ts_now = te.get_timestamp_estimate();
-
-  // Check that the timestamp has advanced a bit from the initial TimeSync, but not by "too much".
-  auto too_much = clock_frequency_hz / 10; // 100 ms
-  BOOST_CHECK_GE(ts_now, initial_ts);
-  BOOST_CHECK_LT(ts_now, initial_ts + too_much);
+  uint64_t initial_ts = 1; // NOLINT(build/unsigned)
+  FakeTimeSync initial_time_sync{ initial_ts, clock->now_us() };
+  clock->advance(1ms);
+  te.timesync_callback(initial_time_sync);
+  BOOST_CHECK_EQUAL(te.wait_for_valid_timestamp(continue_flag), utilities::TimestampEstimatorBase::kFinished);
+  BOOST_CHECK_EQUAL(te.get_received_timesync_count(), 1);
+
+  // The estimate is the TimeSync timestamp plus the simulated time since it was sent
+  uint64_t ts_now = te.get_timestamp_estimate(); // NOLINT(build/unsigned)
+  BOOST_CHECK_EQUAL(ts_now, initial_ts + clock_frequency_hz / 1000);
+
+  // Feed TimeSyncs from another thread, so that the estimate advances while we wait
+  std::atomic<bool> feeding{ true };
+  std::thread feeder([&] {
+    uint64_t daq_time = initial_ts; // NOLINT(build/unsigned)
+    while (feeding) {
+      FakeTimeSync ts{ daq_time, clock->now_us() };
+      clock->advance(10ms);
+      daq_time += clock_frequency_hz / 100;
+      te.timesync_callback(ts);
+    }
+  });
 
   BOOST_CHECK_EQUAL(te.wait_for_timestamp(ts_now + clock_frequency_hz, continue_flag),
                     utilities::TimestampEstimatorBase::kFinished);
+  BOOST_CHECK_GE(te.get_timestamp_estimate(), ts_now + clock_frequency_hz);
 
   ts_now = te.get_timestamp_estimate();
   BOOST_CHECK_EQUAL(te.wait_for_timestamp(ts_now + clock_frequency_hz, do_not_continue_flag),
                     utilities::TimestampEstimatorBase::kInterrupted);
 
-  // Check that the timestamp doesn't go backwards
-  daqdataformats::timestamp_t ts1 = te.get_timestamp_estimate();
+  // Check that the timestamp doesn't go backwards, and that it advances
+  uint64_t ts1 = te.get_timestamp_estimate(); // NOLINT(build/unsigned)
   BOOST_CHECK_GE(ts1, initial_ts);
-  daqdataformats::timestamp_t ts2 = te.get_timestamp_estimate();
-  BOOST_CHECK_GE(ts2, ts1);
-  // Check that the timestamp advances
-  std::this_thread::sleep_for(10ms);
-  daqdataformats::timestamp_t ts3 = te.get_timestamp_estimate();
-  BOOST_CHECK_GT(ts3, ts2);
+  BOOST_CHECK_EQUAL(te.wait_for_timestamp(ts1 + 1, continue_flag), utilities::TimestampEstimatorBase::kFinished);
+  uint64_t ts2 = te.get_timestamp_estimate(); // NOLINT(build/unsigned)
+  BOOST_CHECK_GT(ts2, ts1);
+
+  feeding = false;
+  feeder.join();
+}
+
+BOOST_AUTO_TEST_CASE(OtherRunDiscarded)
+{
+  auto clock = std::make_shared<utilities::SimulatedClock>(start_time);
+  utilities::TimestampEstimator te(5, clock_frequency_hz, clock);
+
+  FakeTimeSync other_run{ 1000, clock->now_us() };
+  other_run.run_number = 4;
+  clock->advance(1ms);
+  te.timesync_callback(other_run);
+
+  BOOST_CHECK_EQUAL(te.get_received_timesync_count(), 1);
+  BOOST_CHECK_EQUAL(te.get_timestamp_estimate(), std::numeric_limits<uint64_t>::max());
+}
+
+BOOST_AUTO_TEST_CASE(HourOfTimeSyncs)
+{
+  // One hour of TimeSyncs at 10 Hz, received 100 us after they were sent
+  auto clock = std::make_shared<utilities::SimulatedClock>(start_time);
+  utilities::TimestampEstimator te(clock_frequency_hz, clock);
+
+  const uint64_t initial_ts = 1'000'000'000; // NOLINT(build/unsigned)
+  const int n_timesyncs = 36'000;
+  for (int i = 0; i < n_timesyncs; ++i) {
+    FakeTimeSync ts{ initial_ts + i * clock_frequency_hz / 10, clock->now_us() };
+    clock->advance(100us);
+    te.timesync_callback(ts);
+    BOOST_REQUIRE_EQUAL(te.get_timestamp_estimate(), ts.daq_time + clock_frequency_hz / 10000);
+    clock->advance(99'900us);
+  }
+  BOOST_CHECK_EQUAL(te.get_received_timesync_count(), n_timesyncs);
 }
 
 BOOST_AUTO_TEST_SUITE_END()
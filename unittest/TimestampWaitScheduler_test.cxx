@@ -0,0 +1,311 @@
+/**
+ * @file TimestampWaitScheduler_test.cxx  TimestampWaitScheduler class Unit Tests
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/Issues.hpp"
+#include "utilities/TimestampEstimator.hpp"
+#include "utilities/TimestampEstimatorSystem.hpp"
+#include "utilities/TimestampWaitScheduler.hpp"
+
+/**
+ * @brief Name of this test module
+ */
+#define BOOST_TEST_MODULE TimestampWaitScheduler_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace dunedaq::utilities;
+using namespace std::chrono_literals;
+
+namespace {
+
+const uint64_t clock_frequency_hz = 62'500'000; // NOLINT(build/unsigned)
+const Clock::time_point start_time(1'600'000'000'000'000us);
+
+/**
+ * @brief Estimator whose updates are notified on demand, from any thread
+ */
+class NotifyingEstimator : public TimestampEstimatorBase
+{
+public:
+  uint64_t get_timestamp_estimate() const override { return 0; } // NOLINT(build/unsigned)
+  void notify() { notify_update_callbacks(); }
+};
+
+#ifdef UTILITIES_HAS_TIMESTAMP_AWAITABLES
+/**
+ * @brief Minimal eagerly-started, fire-and-forget coroutine type
+ */
+struct Detached
+{
+  struct promise_type
+  {
+    Detached get_return_object() { return {}; }
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    std::suspend_never final_suspend() noexcept { return {}; }
+    void return_void() {}
+    void unhandled_exception() { std::terminate(); }
+  };
+};
+
+Detached
+wait_until(TimestampWaitScheduler& scheduler,
+           uint64_t ts, // NOLINT(build/unsigned)
+           std::atomic<bool>& continue_flag,
+           std::vector<TimestampEstimatorBase::WaitStatus>& results)
+{
+  auto status = co_await scheduler.valid(continue_flag);
+  if (status == TimestampEstimatorBase::kFinished) {
+    status = co_await scheduler.until(ts, continue_flag);
+  }
+  results.push_back(status);
+}
+#endif
+
+} // namespace ""
+
+BOOST_AUTO_TEST_SUITE(BOOST_TEST_MODULE)
+
+BOOST_AUTO_TEST_CASE(UpdateDriven)
+{
+  auto clock = std::make_shared<SimulatedClock>(start_time);
+  TimestampEstimator te(clock_frequency_hz, clock);
+  TimestampWaitScheduler scheduler(te, Clock::duration::zero());
+
+  std::atomic<bool> continue_flag{ true };
+  std::vector<uint64_t> finished; // NOLINT(build/unsigned)
+  bool valid = false;
+  scheduler.async_wait_for_valid_timestamp(continue_flag, [&](TimestampEstimatorBase::WaitStatus status) {
+    BOOST_CHECK_EQUAL(status, TimestampEstimatorBase::kFinished);
+    valid = true;
+  });
+  const int n_waits = 1000;
+  for (int i = n_waits; i > 0; --i) {
+    uint64_t ts = i * 1000; // NOLINT(build/unsigned)
+    scheduler.async_wait_for_timestamp(ts, continue_flag, [&, ts](TimestampEstimatorBase::WaitStatus status) {
+      BOOST_CHECK_EQUAL(status, TimestampEstimatorBase::kFinished);
+      finished.push_back(ts);
+    });
+  }
+  BOOST_CHECK_EQUAL(scheduler.get_num_pending(), n_waits + 1);
+  BOOST_CHECK(!valid);
+
+  // Each datapoint releases the waits it reaches, in timestamp order
+  te.add_timestamp_datapoint(1, clock->now_us());
+  clock->advance(1us);
+  te.add_timestamp_datapoint(500'000 - clock_frequency_hz / 1'000'000, clock->now_us() - 1);
+  BOOST_CHECK(valid);
+  BOOST_CHECK_EQUAL(finished.size(), 500);
+  for (size_t i = 0; i < finished.size(); ++i) {
+    BOOST_CHECK_EQUAL(finished[i], (i + 1) * 1000);
+  }
+
+  clock->advance(1us);
+  te.add_timestamp_datapoint(2'000'000, clock->now_us() - 1);
+  BOOST_CHECK_EQUAL(finished.size(), n_waits);
+  BOOST_CHECK_EQUAL(scheduler.get_num_pending(), 0);
+
+  // Already-reached waits complete immediately
+  bool immediate = false;
+  scheduler.async_wait_for_timestamp(
+    1, continue_flag, [&](TimestampEstimatorBase::WaitStatus) { immediate = true; });
+  BOOST_CHECK(immediate);
+}
+
+BOOST_AUTO_TEST_CASE(Interruption)
+{
+  auto clock = std::make_shared<SimulatedClock>(start_time);
+  TimestampEstimator te(clock_frequency_hz, clock);
+  std::vector<TimestampEstimatorBase::WaitStatus> results;
+  std::atomic<bool> continue_flag{ true };
+  std::atomic<bool> do_not_continue_flag{ false };
+
+  {
+    TimestampWaitScheduler scheduler(te, Clock::duration::zero());
+    auto record = [&](TimestampEstimatorBase::WaitStatus status) { results.push_back(status); };
+
+    scheduler.async_wait_for_timestamp(1000, do_not_continue_flag, record);
+    BOOST_REQUIRE_EQUAL(results.size(), 1);
+    BOOST_CHECK_EQUAL(results[0], TimestampEstimatorBase::kInterrupted);
+
+    std::atomic<bool> flag{ true };
+    scheduler.async_wait_for_timestamp(1000, flag, record);
+    scheduler.async_wait_for_timestamp(2000, continue_flag, record);
+    flag = false;
+    scheduler.poll();
+    BOOST_REQUIRE_EQUAL(results.size(), 2);
+    BOOST_CHECK_EQUAL(results[1], TimestampEstimatorBase::kInterrupted);
+    BOOST_CHECK_EQUAL(scheduler.get_num_pending(), 1);
+  }
+
+  // Destroying the scheduler interrupts the remaining wait
+  BOOST_REQUIRE_EQUAL(results.size(), 3);
+  BOOST_CHECK_EQUAL(results[2], TimestampEstimatorBase::kInterrupted);
+}
+
+BOOST_AUTO_TEST_CASE(CallbacksChangeCallbacks)
+{
+  auto clock = std::make_shared<SimulatedClock>(start_time);
+  TimestampEstimator te(clock_frequency_hz, clock);
+
+  // Update callbacks may add and remove update callbacks, including their own
+  int n_self_removing = 0;
+  int n_added = 0;
+  size_t self_removing_id = 0;
+  self_removing_id = te.add_update_callback([&] {
+    ++n_self_removing;
+    te.remove_update_callback(self_removing_id);
+    te.add_update_callback([&] { ++n_added; });
+  });
+
+  // A wait's callback, run from the update path, may destroy and create schedulers
+  auto scheduler = std::make_unique<TimestampWaitScheduler>(te, Clock::duration::zero());
+  auto other = std::make_unique<TimestampWaitScheduler>(te, Clock::duration::zero());
+  std::atomic<bool> continue_flag{ true };
+  bool finished = false;
+  scheduler->async_wait_for_valid_timestamp(continue_flag, [&](TimestampEstimatorBase::WaitStatus status) {
+    finished = status == TimestampEstimatorBase::kFinished;
+    other.reset();
+    other = std::make_unique<TimestampWaitScheduler>(te, Clock::duration::zero());
+  });
+
+  te.add_timestamp_datapoint(1, clock->now_us());
+  clock->advance(1us);
+  te.add_timestamp_datapoint(1, clock->now_us() - 1);
+  BOOST_CHECK(finished);
+  BOOST_CHECK_EQUAL(n_self_removing, 1);
+  BOOST_CHECK_EQUAL(n_added, 1);
+}
+
+BOOST_AUTO_TEST_CASE(ConcurrentRemovals)
+{
+  NotifyingEstimator te;
+
+  // Two threads notify at once, and each removes, from inside a
+  // callback, the callback which the other is running. Neither may
+  // wait for the other
+  std::atomic<int> n_arrived{ 0 };
+  size_t meeting_id = 0;
+  meeting_id = te.add_update_callback([&] {
+    ++n_arrived;
+    auto start = std::chrono::steady_clock::now();
+    while (n_arrived.load() < 2 && std::chrono::steady_clock::now() - start < 5s) {
+      std::this_thread::yield();
+    }
+    te.remove_update_callback(meeting_id);
+  });
+  std::atomic<int> n_later{ 0 };
+  te.add_update_callback([&] { ++n_later; });
+
+  std::thread first([&] { te.notify(); });
+  std::thread second([&] { te.notify(); });
+  first.join();
+  second.join();
+  BOOST_CHECK_EQUAL(n_arrived.load(), 2);
+  BOOST_CHECK_EQUAL(n_later.load(), 2);
+
+  te.notify();
+  BOOST_CHECK_EQUAL(n_arrived.load(), 2);
+  BOOST_CHECK_EQUAL(n_later.load(), 3);
+}
+
+BOOST_AUTO_TEST_CASE(TimerNeedsBlockingSleeps)
+{
+  // The timer thread would spin on a clock which advances when slept on...
+  auto clock = std::make_shared<SimulatedClock>(start_time);
+  TimestampEstimator te(clock_frequency_hz, clock);
+  BOOST_CHECK_THROW(TimestampWaitScheduler(te, 1ms), InvalidSchedulerConfiguration);
+  BOOST_CHECK(clock->now() == start_time);
+  TimestampWaitScheduler polled(te, Clock::duration::zero());
+
+  // ...but not on one which blocks
+  auto blocking_clock = std::make_shared<SimulatedClock>(start_time, false);
+  TimestampEstimator blocking_te(clock_frequency_hz, blocking_clock);
+  TimestampWaitScheduler timed(blocking_te, 1ms);
+  std::atomic<bool> continue_flag{ true };
+  std::atomic<bool> interrupted{ false };
+  timed.async_wait_for_timestamp(1000, continue_flag, [&](TimestampEstimatorBase::WaitStatus status) {
+    interrupted = status == TimestampEstimatorBase::kInterrupted;
+  });
+  continue_flag = false;
+  auto real_start = std::chrono::steady_clock::now();
+  while (!interrupted.load() && std::chrono::steady_clock::now() - real_start < 10s) {
+    std::this_thread::sleep_for(1ms);
+  }
+  BOOST_CHECK(interrupted.load());
+  BOOST_CHECK(blocking_clock->now() == start_time);
+}
+
+BOOST_AUTO_TEST_CASE(TimerDriven)
+{
+  TimestampEstimatorSystem tes(clock_frequency_hz);
+  TimestampWaitScheduler scheduler(tes, 100us);
+
+  std::atomic<bool> continue_flag{ true };
+  std::atomic<int> n_finished{ 0 };
+  auto target = tes.get_timestamp_estimate() + clock_frequency_hz / 100; // 10 ms
+  for (int i = 0; i < 100; ++i) {
+    scheduler.async_wait_for_timestamp(target, continue_flag, [&](TimestampEstimatorBase::WaitStatus status) {
+      if (status == TimestampEstimatorBase::kFinished) {
+        ++n_finished;
+      }
+    });
+  }
+
+  auto real_start = std::chrono::steady_clock::now();
+  while (n_finished.load() != 100 && std::chrono::steady_clock::now() - real_start < 10s) {
+    std::this_thread::sleep_for(1ms);
+  }
+  BOOST_CHECK_EQUAL(n_finished.load(), 100);
+  BOOST_CHECK_GE(tes.get_timestamp_estimate(), target);
+}
+
+#ifdef UTILITIES_HAS_TIMESTAMP_AWAITABLES
+BOOST_AUTO_TEST_CASE(Coroutines)
+{
+  auto clock = std::make_shared<SimulatedClock>(start_time);
+  TimestampEstimator te(clock_frequency_hz, clock);
+  TimestampWaitScheduler scheduler(te, Clock::duration::zero());
+
+  std::atomic<bool> continue_flag{ true };
+  std::atomic<bool> flag_to_clear{ true };
+  std::vector<TimestampEstimatorBase::WaitStatus> results;
+  const int n_coroutines = 1000;
+  for (int i = 0; i < n_coroutines; ++i) {
+    wait_until(scheduler, 1000 + i, i % 2 ? continue_flag : flag_to_clear, results);
+  }
+  BOOST_CHECK(results.empty());
+  BOOST_CHECK_EQUAL(scheduler.get_num_pending(), n_coroutines);
+
+  // First wakeup makes the estimate valid; the coroutines then wait for their timestamps
+  te.add_timestamp_datapoint(1, clock->now_us());
+  clock->advance(1us);
+  te.add_timestamp_datapoint(1, clock->now_us() - 1);
+  BOOST_CHECK(results.empty());
+  BOOST_CHECK_EQUAL(scheduler.get_num_pending(), n_coroutines);
+
+  flag_to_clear = false;
+  scheduler.poll();
+  BOOST_CHECK_EQUAL(results.size(), n_coroutines / 2);
+
+  clock->advance(1us);
+  te.add_timestamp_datapoint(1'000'000, clock->now_us() - 1);
+  BOOST_REQUIRE_EQUAL(results.size(), n_coroutines);
+  for (int i = 0; i < n_coroutines; ++i) {
+    BOOST_CHECK_EQUAL(results[i],
+                      i < n_coroutines / 2 ? TimestampEstimatorBase::kInterrupted : TimestampEstimatorBase::kFinished);
+  }
+}
+#endif
+
+BOOST_AUTO_TEST_SUITE_END()
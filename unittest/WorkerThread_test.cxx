@@ -8,6 +8,7 @@
  */
 
 #include "utilities/WorkerThread.hpp"
+#include "utilities/Metrics.hpp"
 
 #define BOOST_TEST_MODULE WorkerThread_test // NOLINT
 
@@ -17,6 +18,7 @@
 #include <chrono>
 #include <memory>
 #include <string>
+#include <thread>
 
 namespace {
 
@@ -100,6 +102,145 @@ BOOST_AUTO_TEST_CASE(thread_name)
   BOOST_REQUIRE_EQUAL(actual_thread_name, "WorkerThread_te");
 }
 
+BOOST_AUTO_TEST_CASE(parked_thread)
+{
+  std::thread::id work_thread_id;
+  int runs = 0;
+  dunedaq::utilities::WorkerThreadOptions options;
+  options.park_between_runs = true;
+  dunedaq::utilities::WorkerThread umth(
+    [&](std::atomic<bool>& running_flag) {
+      work_thread_id = std::this_thread::get_id();
+      ++runs;
+      while (running_flag.load()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+    },
+    options);
+
+  umth.start_working_thread("parked");
+  umth.stop_working_thread();
+  BOOST_REQUIRE_EQUAL(runs, 1);
+  auto first_id = work_thread_id;
+
+  // The same OS thread runs do_work again, with the new name
+  umth.start_working_thread("parked again");
+  BOOST_REQUIRE_THROW(umth.start_working_thread(), dunedaq::utilities::ThreadingIssue);
+  umth.stop_working_thread();
+  BOOST_REQUIRE_EQUAL(runs, 2);
+  BOOST_REQUIRE(work_thread_id == first_id);
+  BOOST_REQUIRE_THROW(umth.stop_working_thread(), dunedaq::utilities::ThreadingIssue);
+}
+
+BOOST_AUTO_TEST_CASE(start_stop_cycles)
+{
+  constexpr int n_cycles = 200;
+  auto do_nothing = [](std::atomic<bool>&) {};
+  auto threads_created = dunedaq::utilities::get_counter("worker_thread.threads_created");
+  for (bool park : { false, true }) {
+    dunedaq::utilities::WorkerThreadOptions options;
+    options.park_between_runs = park;
+    dunedaq::utilities::WorkerThread umth(do_nothing, options);
+    auto created_before = threads_created.get_value();
+    auto starttime = std::chrono::steady_clock::now();
+    for (int i = 0; i < n_cycles; ++i) {
+      umth.start_working_thread();
+      umth.stop_working_thread();
+    }
+    auto cycle_time_in_us =
+      std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - starttime).count() /
+      n_cycles;
+    BOOST_TEST_MESSAGE("Start/stop cycle " << (park ? "with" : "without") << " a parked thread took "
+                                           << cycle_time_in_us << " us");
+
+    // A parked thread is created once, and reused by every later cycle
+    BOOST_REQUIRE_EQUAL(threads_created.get_value() - created_before, park ? 1 : n_cycles);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(stop_timeout)
+{
+  auto& stop_time = dunedaq::utilities::get_latency_histogram("worker_thread.stop_time");
+  auto stops_before = stop_time.get_snapshot().get_count();
+  for (bool park : { false, true }) {
+    std::atomic<bool> release{ false };
+    dunedaq::utilities::WorkerThreadOptions options;
+    options.park_between_runs = park;
+    options.stop_timeout = std::chrono::milliseconds(20);
+    options.report_kernel_stack = true;
+    dunedaq::utilities::WorkerThread umth(
+      [&](std::atomic<bool>&) {
+        // Ignores the running flag
+        while (!release.load()) {
+          std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+      },
+      options);
+
+    umth.start_working_thread("stuck");
+    std::string message;
+    try {
+      umth.stop_working_thread();
+    } catch (dunedaq::utilities::ThreadingIssue const& e) {
+      message = e.what();
+    }
+    BOOST_TEST_MESSAGE(message);
+    BOOST_REQUIRE(message.find("stuck") != std::string::npos);
+    BOOST_REQUIRE(message.find("wchan=") != std::string::npos);
+    BOOST_REQUIRE(message.find("kernel stack") != std::string::npos);
+    BOOST_REQUIRE(!umth.thread_running());
+    BOOST_REQUIRE(umth.thread_stopping());
+    BOOST_REQUIRE_THROW(umth.start_working_thread(), dunedaq::utilities::ThreadingIssue);
+
+    // Waiting longer
+    release = true;
+    umth.stop_working_thread(std::chrono::milliseconds(0));
+    BOOST_REQUIRE(!umth.thread_stopping());
+    BOOST_REQUIRE_GE(umth.get_last_stop_latency().count(), 20000000);
+  }
+
+  // Only the completed stops are recorded
+  auto stop_times = stop_time.get_snapshot();
+  BOOST_REQUIRE_EQUAL(stop_times.get_count() - stops_before, 2);
+  BOOST_REQUIRE_GE(stop_times.get_max(), 20000000);
+}
+
+BOOST_AUTO_TEST_CASE(destroy_after_stop_timeout)
+{
+  for (bool park : { false, true }) {
+    std::atomic<bool> release{ false };
+    std::atomic<bool> returned{ false };
+    dunedaq::utilities::WorkerThreadOptions options;
+    options.park_between_runs = park;
+    options.stop_timeout = std::chrono::milliseconds(20);
+    std::thread releaser;
+    auto starttime = std::chrono::steady_clock::now();
+    {
+      dunedaq::utilities::WorkerThread umth(
+        [&](std::atomic<bool>&) {
+          // Ignores the running flag
+          while (!release.load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+          }
+          returned = true;
+        },
+        options);
+      umth.start_working_thread("stuck");
+      BOOST_REQUIRE_THROW(umth.stop_working_thread(), dunedaq::utilities::ThreadingIssue);
+      BOOST_REQUIRE(umth.thread_stopping());
+
+      releaser = std::thread([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        release = true;
+      });
+      // The destructor waits for do_work() to return, rather than terminating
+    }
+    BOOST_REQUIRE(returned.load());
+    BOOST_REQUIRE(std::chrono::steady_clock::now() - starttime >= std::chrono::milliseconds(100));
+    releaser.join();
+  }
+}
+
 // You'll want this to test case to execute last, for reasons that are obvious
 // if you look at its checks
 
@@ -0,0 +1,139 @@
+/**
+ *
+ * @file ZmqUri_test.cxx ZMQ connection string parsing Unit Tests
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/ZmqUri.hpp"
+
+#define BOOST_TEST_MODULE ZmqUri_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <string>
+
+using namespace dunedaq::utilities;
+
+namespace {
+
+constexpr ZmqUriView
+parse_at_compile_time(std::string_view connection_string)
+{
+  ZmqUriView output;
+  try_parse_connection_string(connection_string, output);
+  return output;
+}
+
+constexpr auto compile_time_uri = parse_at_compile_time("tcp://[fe80::1]:5555");
+static_assert(compile_time_uri.scheme == "tcp");
+static_assert(compile_time_uri.host == "fe80::1");
+static_assert(compile_time_uri.port == "5555");
+static_assert(compile_time_uri.formatted_size() == 20);
+
+constexpr bool
+round_trips(std::string_view connection_string)
+{
+  char buffer[64] = {};
+  auto size = parse_at_compile_time(connection_string).format(buffer, sizeof(buffer));
+  return std::string_view(buffer, size) == connection_string;
+}
+static_assert(round_trips("tcp://eth0;192.168.1.1:5555"));
+static_assert(round_trips("ipc:///tmp/feeds/0"));
+
+} // namespace ""
+
+BOOST_AUTO_TEST_CASE(Tcp)
+{
+  auto uri = parse_connection_string_view("tcp://localhost:1234");
+  BOOST_REQUIRE_EQUAL(uri.scheme, "tcp");
+  BOOST_REQUIRE_EQUAL(uri.host, "localhost");
+  BOOST_REQUIRE_EQUAL(uri.port, "1234");
+  BOOST_REQUIRE(uri.source.empty());
+  BOOST_REQUIRE_EQUAL(uri.to_string(), "tcp://localhost:1234");
+
+  uri = parse_connection_string_view("tcp://*:1234");
+  BOOST_REQUIRE_EQUAL(uri.host, "*");
+
+  uri = parse_connection_string_view("tcp://eth0:1234");
+  BOOST_REQUIRE_EQUAL(uri.host, "eth0");
+
+  uri = parse_connection_string_view("tcp://eth0;10.0.0.1:1234");
+  BOOST_REQUIRE_EQUAL(uri.source, "eth0");
+  BOOST_REQUIRE_EQUAL(uri.host, "10.0.0.1");
+  BOOST_REQUIRE_EQUAL(uri.port, "1234");
+  BOOST_REQUIRE_EQUAL(uri.to_string(), "tcp://eth0;10.0.0.1:1234");
+
+  uri = parse_connection_string_view("tcp://localhost");
+  BOOST_REQUIRE_EQUAL(uri.host, "localhost");
+  BOOST_REQUIRE(uri.port.empty());
+  BOOST_REQUIRE_EQUAL(uri.to_string(), "tcp://localhost");
+}
+
+BOOST_AUTO_TEST_CASE(Ipv6)
+{
+  auto uri = parse_connection_string_view("tcp://[::1]:1234");
+  BOOST_REQUIRE_EQUAL(uri.host, "::1");
+  BOOST_REQUIRE_EQUAL(uri.port, "1234");
+  BOOST_REQUIRE_EQUAL(uri.to_string(), "tcp://[::1]:1234");
+
+  // Without brackets, the host and port of an address cannot be told apart
+  BOOST_REQUIRE_THROW(parse_connection_string_view("tcp://::1:1234"), InvalidUri);
+  BOOST_REQUIRE_THROW(parse_connection_string_view("tcp://fe80::1"), InvalidUri);
+  BOOST_REQUIRE_THROW(parse_connection_string_view("tcp://eth0;fe80::1:1234"), InvalidUri);
+
+  uri = parse_connection_string_view("tcp://[fe80::1%eth0]");
+  BOOST_REQUIRE_EQUAL(uri.host, "fe80::1%eth0");
+  BOOST_REQUIRE(uri.port.empty());
+
+  BOOST_REQUIRE_THROW(parse_connection_string_view("tcp://[::1:1234"), InvalidUri);
+  BOOST_REQUIRE_THROW(parse_connection_string_view("tcp://[::1]1234"), InvalidUri);
+}
+
+BOOST_AUTO_TEST_CASE(Local)
+{
+  auto uri = parse_connection_string_view("ipc:///tmp/socket:0");
+  BOOST_REQUIRE_EQUAL(uri.scheme, "ipc");
+  BOOST_REQUIRE_EQUAL(uri.host, "/tmp/socket:0");
+  BOOST_REQUIRE(uri.port.empty());
+  BOOST_REQUIRE_EQUAL(uri.to_string(), "ipc:///tmp/socket:0");
+
+  uri = parse_connection_string_view("inproc://foo");
+  BOOST_REQUIRE_EQUAL(uri.host, "foo");
+  BOOST_REQUIRE_EQUAL(uri.to_string(), "inproc://foo");
+}
+
+BOOST_AUTO_TEST_CASE(Invalid)
+{
+  ZmqUriView uri;
+  BOOST_REQUIRE(!try_parse_connection_string("blah", uri));
+  BOOST_REQUIRE(!try_parse_connection_string("://blah", uri));
+  BOOST_REQUIRE_THROW(parse_connection_string_view("blah"), InvalidUri);
+  BOOST_REQUIRE_THROW(parse_connection_string("blah"), InvalidUri);
+}
+
+BOOST_AUTO_TEST_CASE(Format)
+{
+  auto uri = parse_connection_string_view("tcp://[::1]:1234");
+  char small[8];
+  BOOST_REQUIRE_EQUAL(uri.format(small, sizeof(small)), 16);
+
+  char buffer[32];
+  auto size = uri.format(buffer, sizeof(buffer));
+  BOOST_REQUIRE_EQUAL(std::string(buffer, size), "tcp://[::1]:1234");
+}
+
+BOOST_AUTO_TEST_CASE(Owning)
+{
+  auto uri = parse_connection_string("tcp://eth0;[::1]:1234");
+  BOOST_REQUIRE_EQUAL(uri.scheme, "tcp");
+  BOOST_REQUIRE_EQUAL(uri.host, "::1");
+  BOOST_REQUIRE_EQUAL(uri.port, "1234");
+  BOOST_REQUIRE_EQUAL(uri.source, "eth0");
+  BOOST_REQUIRE_EQUAL(uri.to_string(), "tcp://eth0;[::1]:1234");
+
+  ZmqUri constructed{ "tcp", "10.0.0.1", "5555" };
+  BOOST_REQUIRE_EQUAL(constructed.to_string(), "tcp://10.0.0.1:5555");
+}